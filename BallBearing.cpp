@@ -5,6 +5,24 @@
 
 #include <Core/Utils.h>
 
+#include "BearingBackend.h"
+#include "BearingBatch.h"
+#include "BearingBuild.h"
+#include "BearingGeometry.h"
+#include "BearingJob.h"
+#include "BearingLayout.h"
+#include "BearingPlacement.h"
+#include "BearingPreview.h"
+#include "BearingProperties.h"
+#include "BearingTrace.h"
+#include "BearingValidation.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+
 #define _USE_MATH_DEFINES
 #include <math.h>
 
@@ -15,31 +33,129 @@ using namespace adsk::cam;
 Ptr<Application> gptrApp;
 Ptr<UserInterface> gptrUi;
 std::string gstrUnits = "";
+// Insert another occurrence of an existing bearing of the same size instead of building it again.
+bool gxReuseBearings = true;
+// Keep sketches from solving until all of their curves are added.
+bool gxDeferCompute = true;
+// When set, every build stage is timed into this trace.
+BuildTrace *gpBuildTrace = nullptr;
+BuildTrace gBuildTrace;
+
+// Calls of the Fusion backend, recorded together with the build trace.
+RecordingBackend gBuildCalls;
+
+// Kind of bearing the dialog builds.
+BearingFamily geFamily = DeepGrooveBearing;
+// How the balls are created: one revolved ball copied by a circular pattern,
+// all balls as a single body made from temporary BRep spheres, or occurrences
+// of one shared ball component.
+BallCreationMode geBallCreation = PatternBallCreation;
+// Add a cage around the balls.
+bool gxCage = false;
+// Minimum gap between neighbouring balls, 0 keeps the standard ball count.
+double gdBallClearance = 0.0;
+
+// Tessellated previews of the last sizes and the custom graphics showing the current one.
+PreviewCache gPreviewCache;
+PreviewThrottle gPreviewThrottle;
+Ptr<CustomGraphicsGroup> gptrPreviewGraphics;
+
+// Batch and layout jobs are planned on a worker thread and built on the main
+// thread in short slices, one per custom event, so Fusion stays responsive.
+const char *kBuildStepEventId = "asBallBearingBuildStep";
+// Building time per event before Fusion gets the main thread back.
+const double kBuildSliceSeconds = 0.2;
+BearingJobQueue gJobQueue;
+Ptr<CustomEvent> gptrBuildStepEvent;
+
+// Main thread side of the running job.
+struct RunningJob
+{
+	bool xLayout;
+	std::string strPath;
+	Ptr<Design> ptrDesign;
+	// Taken from the dialog at the start, later dialogs do not change the job.
+	BearingBuildOptions options;
+	Ptr<ProgressDialog> ptrProgress;
+	std::ofstream timings;
+	int iTimelineStart;
+	std::chrono::steady_clock::time_point tStart;
+	// Rows of the file.
+	size_t iRows;
+	int iBuilt;
+	int iInvalid;
+	int iPlaced;
+	int iSkipped;
+} gJob;
 
 // Global command input declarations.
 Ptr<ValueCommandInput> gptrInnerDiameter;
 Ptr<ValueCommandInput> gptrOuterDiameter;
 Ptr<ValueCommandInput> gptrThickness;
+Ptr<DropDownCommandInput> gptrFamily;
 Ptr<TextBoxCommandInput> gptrErrorMessage;
+Ptr<BoolValueCommandInput> gptrBatchMode;
+Ptr<BoolValueCommandInput> gptrLayoutMode;
+Ptr<BoolValueCommandInput> gptrReuseBearings;
+Ptr<BoolValueCommandInput> gptrDeferCompute;
+Ptr<BoolValueCommandInput> gptrProfileBuild;
+Ptr<DropDownCommandInput> gptrBallCreation;
+Ptr<BoolValueCommandInput> gptrCage;
+Ptr<SelectionCommandInput> gptrEditBearing;
+Ptr<ValueCommandInput> gptrBallClearance;
 
 bool getCommandInputValue(Ptr<CommandInput> commandInput, std::string unitType, double *value);
+bool prepareBearingGeometry(double innerDiameter, double outerDiameter, double thickness, BearingGeometry *geometry, BearingValidation *validation);
 Ptr<Component> drawBallBearing(Ptr<Design> design, double innerDiameter, double outerDiameter, double thickness);
-
-
+Ptr<Component> drawBallBearing(Ptr<Design> design, const BearingGeometry &geometry, const BearingBuildOptions &options);
+Ptr<Component> editBallBearing(Ptr<Design> design, Ptr<Component> component, double innerDiameter, double outerDiameter, double thickness, std::string *error);
+Ptr<Occurrence> findBearingOccurrence(Ptr<Occurrence> occurrence);
+Ptr<Component> findBearingComponent(Ptr<Occurrence> occurrence);
+bool readBallBearingParameters(Ptr<Design> design, Ptr<Component> component, BearingParameters *parameters);
+bool startBearingJob(Ptr<Design> design, bool layout, std::string *report);
+void runBuildSlice();
+void describeBallBearing(Ptr<Component> component, double innerDiameter, double outerDiameter, double thickness);
+std::string getTempFilePath(const std::string &name);
+std::string writeBuildTrace(const std::string &path);
+bool drawBearingPreview(Ptr<Design> design, const TriangleMesh &mesh, Ptr<Matrix3D> transform);
+void clearBearingPreview();
+
+
+// True if a Fusion call returned an object. Many calls are lookups that may
+// fail, so nothing is shown here; a command that fails reports the last error once.
 bool checkReturn(Ptr<Base> returnObj)
 {
 	if (returnObj)
 		return true;
-	else
-		if (gptrApp && gptrUi)
-		{
-			std::string errDesc;
-			gptrApp->getLastError(&errDesc);
-			gptrUi->messageBox(errDesc);
-			return false;
-		}
-		else
-			return false;
+	return false;
+}
+
+// Last error of the Fusion API, appended to the message of a failed command.
+std::string lastFusionError()
+{
+	std::string strError;
+	if (gptrApp)
+		gptrApp->getLastError(&strError);
+	return strError.empty() ? "" : "\n" + strError;
+}
+
+// Dialog values of the document they were last read from or written to, so
+// the attribute of a design is read only when the dialog first opens in it.
+DialogDefaults gDialogDefaults = { 10.0, 20.0, 5.0, DeepGrooveBearing };
+std::string gstrDialogDefaultsDocument;
+
+DialogDefaults &dialogDefaults(Ptr<Design> design)
+{
+	Ptr<Document> ptrDocument = design->parentDocument();
+	std::string strDocument = ptrDocument ? ptrDocument->creationId() : "";
+	if (strDocument.empty() || strDocument != gstrDialogDefaultsDocument) {
+		gDialogDefaults = { 10.0, 20.0, 5.0, geFamily };
+		Ptr<Attribute> ptrRecord = design->attributes()->itemByName("BallBearing", "dialog");
+		if (ptrRecord)
+			parseDialogDefaults(ptrRecord->value(), &gDialogDefaults);
+		gstrDialogDefaultsDocument = strDocument;
+	}
+	return gDialogDefaults;
 }
 
 // Event handler for the execute event.
@@ -48,46 +164,160 @@ class GearCommandExecuteEventHandler : public adsk::core::CommandEventHandler
 public:
 	void notify(const Ptr<CommandEventArgs>& eventArgs) override
 	{
-		// Save the current values as attributes.
+		clearBearingPreview();
+
+		if (gJobQueue.active())
+		{
+			eventArgs->executeFailed(true);
+			eventArgs->executeFailedMessage("A bearing job is still running. Wait for it or cancel it in its progress dialog.");
+			return;
+		}
+
+		if (gptrFamily && gptrFamily->selectedItem())
+			geFamily = (BearingFamily)gptrFamily->selectedItem()->index();
+
+		// Save the current values as the dialog defaults of the design.
 		Ptr<Design> des = gptrApp->activeProduct();
-		Ptr<Attributes> attribs = des->attributes();
-		attribs->add("BallBearing", "innerDiameter", std::to_string(gptrInnerDiameter->value()));
-		attribs->add("BallBearing", "outerDiameter", std::to_string(gptrOuterDiameter->value()));
-		attribs->add("BallBearing", "thickness", std::to_string(gptrThickness->value()));
+		DialogDefaults &defaults = dialogDefaults(des);
+		defaults = { gptrInnerDiameter->value(), gptrOuterDiameter->value(), gptrThickness->value(), geFamily };
+		des->attributes()->add("BallBearing", "dialog", formatDialogDefaults(defaults));
+		gxReuseBearings = !gptrReuseBearings || gptrReuseBearings->value();
+		gxDeferCompute = !gptrDeferCompute || gptrDeferCompute->value();
+		if (gptrBallCreation && gptrBallCreation->selectedItem())
+			geBallCreation = (BallCreationMode)gptrBallCreation->selectedItem()->index();
+		gxCage = gptrCage && gptrCage->value();
+		gdBallClearance = gptrBallClearance ? gptrBallClearance->value() : 0.0;
+		gBuildTrace.clear();
+		gBuildCalls.clear();
+		gpBuildTrace = (gptrProfileBuild && gptrProfileBuild->value()) ? &gBuildTrace : nullptr;
+
+		bool xLayout = gptrLayoutMode && gptrLayoutMode->value();
+		if (xLayout || (gptrBatchMode && gptrBatchMode->value()))
+		{
+			// The job reports when its last bearing is built, and keeps the trace until then.
+			std::string strReport;
+			if (!startBearingJob(des, xLayout, &strReport))
+			{
+				eventArgs->executeFailed(true);
+				eventArgs->executeFailedMessage((strReport.empty() ? "The bearing job could not be started." : strReport) + lastFusionError());
+			}
+			if (!gJobQueue.active())
+				gpBuildTrace = nullptr;
+			return;
+		}
 
 		//int numTeeth = std::stoi(_numTeeth->value());
 		double dInnerDiameter = gptrInnerDiameter->value();
 		double dOuterDiameter = gptrOuterDiameter->value();
 		double dThickness = gptrThickness->value();
 
-		// Create the gear.
+		// Change the selected bearing in place or create a new one.
 		Ptr<Component> ptrCmpBearing;
-		ptrCmpBearing = drawBallBearing(des, dInnerDiameter, dOuterDiameter, dThickness);
+		std::string strError = "Unexpected failure while constructing the ball bearing.";
+		Ptr<Component> ptrEditBearing;
+		if (gptrEditBearing && gptrEditBearing->selectionCount() == 1)
+			ptrEditBearing = findBearingComponent(gptrEditBearing->selection(0)->entity());
+		if (ptrEditBearing)
+			ptrCmpBearing = editBallBearing(des, ptrEditBearing, dInnerDiameter, dOuterDiameter, dThickness, &strError);
+		else
+			ptrCmpBearing = drawBallBearing(des, dInnerDiameter, dOuterDiameter, dThickness);
 
 		if (ptrCmpBearing)
 		{
-			std::string desc = "";
-			desc += "Inner Diameter: " + std::to_string(dInnerDiameter) + "; ";
-			desc += "Outer Diameter: " + std::to_string(dOuterDiameter) + "; ";
-			desc += "Thickness: " + std::to_string(dThickness) + "; ";
-
-			ptrCmpBearing->description(desc);
+			describeBallBearing(ptrCmpBearing, dInnerDiameter, dOuterDiameter, dThickness);
+			if (gpBuildTrace)
+				gptrUi->messageBox(writeBuildTrace(getTempFilePath("BallBearingTrace.json")));
 		}
 		else
 		{
 			eventArgs->executeFailed(true);
-			eventArgs->executeFailedMessage("Unexpected failure while constructing the ball bearing.");
+			eventArgs->executeFailedMessage(strError + lastFusionError());
 		}
+		gpBuildTrace = nullptr;
 	}
 } gCmdExecute;
 
 
+// Event handler for the executePreview event. Shows a tessellated stand-in of
+// the bearing instead of building its features, those are only built on OK.
+class GearCommandExecutePreviewHandler : public adsk::core::CommandEventHandler
+{
+public:
+	void notify(const Ptr<CommandEventArgs>& eventArgs) override
+	{
+		clearBearingPreview();
+		eventArgs->isValidResult(false);
+		if ((gptrBatchMode && gptrBatchMode->value()) || (gptrLayoutMode && gptrLayoutMode->value()))
+			return;
+
+		double dInnerDiameter;
+		double dOuterDiameter;
+		double dThickness;
+		if (!getCommandInputValue(gptrInnerDiameter, gstrUnits, &dInnerDiameter) ||
+			!getCommandInputValue(gptrOuterDiameter, gstrUnits, &dOuterDiameter) ||
+			!getCommandInputValue(gptrThickness, gstrUnits, &dThickness))
+			return;
+
+		BearingGeometry geometry;
+		BearingValidation validation;
+		if (!prepareBearingGeometry(dInnerDiameter, dOuterDiameter, dThickness, &geometry, &validation))
+			return;
+
+		// A bearing picked for editing is previewed where it is.
+		Ptr<Matrix3D> ptrTransform;
+		if (gptrEditBearing && gptrEditBearing->selectionCount() == 1) {
+			Ptr<Occurrence> ptrBearing = findBearingOccurrence(gptrEditBearing->selection(0)->entity());
+			if (ptrBearing)
+				ptrTransform = ptrBearing->transform2();
+		}
+
+		int iLod = gPreviewThrottle.lod(PreviewThrottle::Clock::now());
+		drawBearingPreview(gptrApp->activeProduct(), *gPreviewCache.mesh(geometry, iLod), ptrTransform);
+	}
+} gCmdExecutePreview;
+
+
+// Event handler for the destroy event, removes the preview when the dialog is cancelled.
+class GearCommandDestroyHandler : public adsk::core::CommandEventHandler
+{
+public:
+	void notify(const Ptr<CommandEventArgs>& eventArgs) override
+	{
+		clearBearingPreview();
+	}
+} gCmdDestroy;
+
+
+// Event handler for the custom event that builds the next slice of the running job.
+class BuildStepEventHandler : public adsk::core::CustomEventHandler
+{
+public:
+	void notify(const Ptr<CustomEventArgs>& eventArgs) override
+	{
+		runBuildSlice();
+	}
+} gBuildStep;
+
+
 class GearCommandInputChangedHandler : public adsk::core::InputChangedEventHandler
 {
 public:
 	void notify(const Ptr<InputChangedEventArgs>& eventArgs) override
 	{
 		Ptr<CommandInput> changedInput = eventArgs->input();
+
+		// Start from the sizes of a bearing picked for editing.
+		if (changedInput && changedInput->id() == "editBearing" && gptrEditBearing->selectionCount() == 1) {
+			Ptr<Component> ptrBearing = findBearingComponent(gptrEditBearing->selection(0)->entity());
+			BearingParameters parameters;
+			if (ptrBearing && readBallBearingParameters(gptrApp->activeProduct(), ptrBearing, &parameters)) {
+				gptrInnerDiameter->value(parameters.dInnerDiameter);
+				gptrOuterDiameter->value(parameters.dOuterDiameter);
+				gptrThickness->value(parameters.dThickness);
+				if (gptrFamily && gptrFamily->listItems()->item(parameters.eFamily))
+					gptrFamily->listItems()->item(parameters.eFamily)->isSelected(true);
+			}
+		}
 	}
 } gCmdInputChanged;
 
@@ -133,6 +363,36 @@ public:
 			eventArgs->areInputsValid(false);
 			return;
 		}
+
+		if (gptrBallClearance && getCommandInputValue(gptrBallClearance, gstrUnits, &value))
+			gdBallClearance = value;
+		if (gptrFamily && gptrFamily->selectedItem())
+			geFamily = (BearingFamily)gptrFamily->selectedItem()->index();
+
+		if (gptrEditBearing && gptrEditBearing->selectionCount() == 1) {
+			Ptr<Component> ptrBearing = findBearingComponent(gptrEditBearing->selection(0)->entity());
+			BearingParameters parameters;
+			if (!ptrBearing || !readBallBearingParameters(gptrApp->activeProduct(), ptrBearing, &parameters)) {
+				gptrErrorMessage->text("The selection is not a ball bearing built by this command.");
+				eventArgs->areInputsValid(false);
+				return;
+			}
+			if (parameters.eFamily != DeepGrooveBearing || geFamily != DeepGrooveBearing) {
+				gptrErrorMessage->text("Only deep groove bearings can be changed in place.");
+				eventArgs->areInputsValid(false);
+				return;
+			}
+		}
+
+		// Catch bearings that cannot be built before any feature is created.
+		BearingGeometry geometry;
+		BearingValidation validation;
+		bool xValid = prepareBearingGeometry(dInnerDiameter, dOuterDiameter, dThickness, &geometry, &validation);
+		gptrErrorMessage->text(validation.message());
+		if (!xValid) {
+			eventArgs->areInputsValid(false);
+			return;
+		}
 	}
 } gCmdValidateInputs;
 
@@ -144,7 +404,7 @@ public:
 	{
 		// Verify that a Fusion design is active.
 		Ptr<Design> ptrDesign = gptrApp->activeProduct();
-		if (!checkReturn(ptrDesign)) {
+		if (!ptrDesign) {
 			gptrUi->messageBox("A Fusion design must be active when invoking this command.");
 			return;
 		}
@@ -158,22 +418,10 @@ public:
 			gstrUnits = "mm";
 		}
 
-		// Define the default values and get the previous values from the attributes.
-
-		std::string strInnerDiameter = std::to_string(10.0);
-		Ptr<Attribute> ptrAttrInnerDiameter = ptrDesign->attributes()->itemByName("BallBearing", "innerDiameter");
-		if (checkReturn(ptrAttrInnerDiameter))
-			strInnerDiameter = ptrAttrInnerDiameter->value();
+		// The values last used in this design, or the defaults.
+		const DialogDefaults &defaults = dialogDefaults(ptrDesign);
 
-		std::string strOuterDiameter = std::to_string(20.0);
-		Ptr<Attribute> ptrAttrOuterDiameter = ptrDesign->attributes()->itemByName("BallBearing", "outerDiameter");
-		if (checkReturn(ptrAttrOuterDiameter))
-			strOuterDiameter = ptrAttrOuterDiameter->value();
-
-		std::string strThickness = std::to_string(5.0);
-		Ptr<Attribute> ptrAttrThickness = ptrDesign->attributes()->itemByName("BallBearing", "thickness");
-		if (checkReturn(ptrAttrThickness))
-			strThickness = ptrAttrThickness->value();
+		gPreviewThrottle.reset();
 
 		Ptr<Command> ptrCmd = eventArgs->command();
 		ptrCmd->isExecutedWhenPreEmpted(false);
@@ -182,23 +430,88 @@ public:
 			return;
 
 		// Define the command dialog.
-		gptrInnerDiameter = inputs->addValueInput("innerDiameter", "Inner Diameter", gstrUnits, ValueInput::createByReal(std::stod(strInnerDiameter)));
+		gptrInnerDiameter = inputs->addValueInput("innerDiameter", "Inner Diameter", gstrUnits, ValueInput::createByReal(defaults.dInnerDiameter));
 		if (!checkReturn(gptrInnerDiameter))
 			return;
 
-		gptrOuterDiameter = inputs->addValueInput("outerDiameter", "Outer Diameter", gstrUnits, ValueInput::createByReal(std::stod(strOuterDiameter)));
+		gptrOuterDiameter = inputs->addValueInput("outerDiameter", "Outer Diameter", gstrUnits, ValueInput::createByReal(defaults.dOuterDiameter));
 		if (!checkReturn(gptrOuterDiameter))
 			return;
 
-		gptrThickness = inputs->addValueInput("thickness", "Thickness", gstrUnits, ValueInput::createByReal(std::stod(strThickness)));
+		gptrThickness = inputs->addValueInput("thickness", "Thickness", gstrUnits, ValueInput::createByReal(defaults.dThickness));
 		if (!checkReturn(gptrThickness))
 			return;
 
+		gptrFamily = inputs->addDropDownCommandInput("family", "Type", TextListDropDownStyle);
+		if (!checkReturn(gptrFamily))
+			return;
+		// In the order of BearingFamily.
+		gptrFamily->listItems()->add("Deep groove", defaults.eFamily == DeepGrooveBearing, "");
+		gptrFamily->listItems()->add("Double row", defaults.eFamily == DoubleRowBearing, "");
+		gptrFamily->listItems()->add("Angular contact", defaults.eFamily == AngularContactBearing, "");
+		gptrFamily->listItems()->add("Thrust", defaults.eFamily == ThrustBearing, "");
+		gptrFamily->listItems()->add("Cylindrical roller", defaults.eFamily == CylindricalRollerBearing, "");
+		gptrFamily->listItems()->add("Tapered roller", defaults.eFamily == TaperedRollerBearing, "");
+
 		gptrErrorMessage = inputs->addTextBoxCommandInput("errMessage", "", "", 2, true);
 		if (!checkReturn(gptrErrorMessage))
 			return;
 		gptrErrorMessage->isFullWidth(true);
 
+		gptrEditBearing = inputs->addSelectionInput("editBearing", "Edit bearing", "Select a bearing to change it in place");
+		if (!checkReturn(gptrEditBearing))
+			return;
+		gptrEditBearing->addSelectionFilter("Occurrences");
+		gptrEditBearing->setSelectionLimits(0, 1);
+		gptrEditBearing->tooltip("Changes the sizes of a bearing built earlier instead of creating a new one.");
+
+		gptrBatchMode = inputs->addBoolValueInput("batchMode", "Batch from file", true, "", false);
+		if (!checkReturn(gptrBatchMode))
+			return;
+		gptrBatchMode->tooltip("Builds every bearing listed in a CSV or JSON file instead of the values above.");
+
+		gptrLayoutMode = inputs->addBoolValueInput("layoutMode", "Layout from file", true, "", false);
+		if (!checkReturn(gptrLayoutMode))
+			return;
+		gptrLayoutMode->tooltip("Places every bearing of a CSV layout at its position and shaft axis, building each size only once.");
+
+		Ptr<GroupCommandInput> ptrBuildOptions = inputs->addGroupCommandInput("buildOptions", "Build Options");
+		if (!checkReturn(ptrBuildOptions))
+			return;
+		ptrBuildOptions->isExpanded(false);
+		Ptr<CommandInputs> ptrBuildInputs = ptrBuildOptions->children();
+
+		gptrReuseBearings = ptrBuildInputs->addBoolValueInput("reuseBearings", "Reuse identical bearings", true, "", gxReuseBearings);
+		if (!checkReturn(gptrReuseBearings))
+			return;
+		gptrReuseBearings->tooltip("Adds a new occurrence of an already built bearing of the same size instead of building it again.");
+
+		gptrDeferCompute = ptrBuildInputs->addBoolValueInput("deferCompute", "Defer sketch compute", true, "", gxDeferCompute);
+		if (!checkReturn(gptrDeferCompute))
+			return;
+
+		gptrBallCreation = ptrBuildInputs->addDropDownCommandInput("ballCreation", "Balls", TextListDropDownStyle);
+		if (!checkReturn(gptrBallCreation))
+			return;
+		gptrBallCreation->listItems()->add("Circular pattern", geBallCreation == PatternBallCreation, "");
+		gptrBallCreation->listItems()->add("Single body", geBallCreation == SingleBodyBallCreation, "");
+		gptrBallCreation->listItems()->add("Shared component", geBallCreation == OccurrenceBallCreation, "");
+
+		gptrCage = ptrBuildInputs->addBoolValueInput("cage", "Cage", true, "", gxCage);
+		if (!checkReturn(gptrCage))
+			return;
+		gptrCage->tooltip("Adds a cage with a pocket around every ball, jointed to the inner ring.");
+
+		gptrBallClearance = ptrBuildInputs->addValueInput("ballClearance", "Ball clearance", gstrUnits, ValueInput::createByReal(gdBallClearance));
+		if (!checkReturn(gptrBallClearance))
+			return;
+		gptrBallClearance->tooltip("Minimum gap between neighbouring balls, 0 uses the standard ball count.");
+
+		gptrProfileBuild = ptrBuildInputs->addBoolValueInput("profileBuild", "Record build trace", true, "", false);
+		if (!checkReturn(gptrProfileBuild))
+			return;
+		gptrProfileBuild->tooltip("Times every build stage and writes a Chrome trace (chrome://tracing) to the temp folder.");
+
 		// Connect to the command related events.
 		Ptr<InputChangedEvent> ptrEventInputChanged = ptrCmd->inputChanged();
 		if (!ptrEventInputChanged)
@@ -220,6 +533,20 @@ public:
 		isOk = ptrEventExecute->add(&gCmdExecute);
 		if (!isOk)
 			return;
+
+		Ptr<CommandEvent> ptrEventExecutePreview = ptrCmd->executePreview();
+		if (!ptrEventExecutePreview)
+			return;
+		isOk = ptrEventExecutePreview->add(&gCmdExecutePreview);
+		if (!isOk)
+			return;
+
+		Ptr<CommandEvent> ptrEventDestroy = ptrCmd->destroy();
+		if (!ptrEventDestroy)
+			return;
+		isOk = ptrEventDestroy->add(&gCmdDestroy);
+		if (!isOk)
+			return;
 	}
 } gCmdCreated;
 
@@ -273,54 +600,241 @@ Ptr<Component> generateComponent(Ptr<Design> design) {
 	return ptrNewComp;
 }
 
-Ptr<Sketch> drawBallCutoutSketch(Ptr<Sketches> sketches, Ptr<ConstructionPlane> plane, double radius, double offset) {
+// Parametric bearings can be resized from the Parameters dialog, which leaves their
+// stored sizes and cache key behind. Such a bearing only matches its key while its
+// user parameters still give the stored sizes.
+bool hasStoredSizes(Ptr<Design> design, Ptr<Component> component) {
+	Ptr<Attributes> ptrAttributes = component->attributes();
+	Ptr<Attribute> ptrPrefix = ptrAttributes->itemByName("BallBearing", "parameterPrefix");
+	if (!ptrPrefix)
+		return true;
+	Ptr<Attribute> ptrUnits = ptrAttributes->itemByName("BallBearing", "units");
+	Ptr<UnitsManager> ptrUnitsMgr = design->unitsManager();
+	if (!ptrUnits || !checkReturn(ptrUnitsMgr))
+		return false;
+
+	const char *names[] = { "innerDiameter", "outerDiameter", "thickness" };
+	for (const char *pName : names) {
+		Ptr<UserParameter> ptrParameter = design->userParameters()->itemByName(ptrPrefix->value() + pName);
+		Ptr<Attribute> ptrSize = ptrAttributes->itemByName("BallBearing", pName);
+		if (!ptrParameter || !ptrSize)
+			return false;
+		double dValue = ptrUnitsMgr->convert(ptrParameter->value(), ptrUnitsMgr->internalUnits(), ptrUnits->value());
+		double dStored = std::atof(ptrSize->value().c_str());
+		if (fabs(dValue - dStored) > 1.0e-9 * fabs(dStored))
+			return false;
+	}
+	return true;
+}
+
+// Looks for a bearing component that was built with the same cache key and adds
+// a new occurrence of it to the root component.
+Ptr<Component> insertCachedBallBearing(Ptr<Design> design, const std::string &key) {
+	std::vector<Ptr<Attribute>> attributes = design->findAttributes("BallBearing", "cacheKey");
+	for (Ptr<Attribute> attribute : attributes) {
+		if (!attribute || attribute->value() != key)
+			continue;
+
+		Ptr<Component> ptrComp = attribute->parent();
+		if (!ptrComp || !hasStoredSizes(design, ptrComp))
+			continue;
+
+		Ptr<Occurrences> ptrOccs = design->rootComponent()->occurrences();
+		if (!checkReturn(ptrOccs))
+			return nullptr;
+
+		Ptr<Occurrence> ptrOcc = ptrOccs->addExistingComponent(ptrComp, adsk::core::Matrix3D::create());
+		if (!checkReturn(ptrOcc))
+			return nullptr;
+
+		return ptrComp;
+	}
+	return nullptr;
+}
+
+// Adds a driving distance dimension between two sketch points that follows the expression.
+bool addDimension(Ptr<Sketch> sketch, Ptr<SketchPoint> pointOne, Ptr<SketchPoint> pointTwo, DimensionOrientations orientation, const std::string &expression) {
+	Ptr<Point3D> ptrOne = pointOne->geometry();
+	Ptr<Point3D> ptrTwo = pointTwo->geometry();
+	Ptr<Point3D> ptrText = adsk::core::Point3D::create((ptrOne->x() + ptrTwo->x()) * 0.5, (ptrOne->y() + ptrTwo->y()) * 0.5, 0.0);
+	Ptr<SketchLinearDimension> ptrDimension = sketch->sketchDimensions()->addDistanceDimension(pointOne, pointTwo, orientation, ptrText);
+	if (!checkReturn(ptrDimension))
+		return false;
+	return ptrDimension->parameter()->expression(expression);
+}
+
+Ptr<Sketch> drawBallCutoutSketch(Ptr<Sketches> sketches, Ptr<ConstructionPlane> plane, double radius, double offset, double height, const std::string &parameterPrefix) {
 	Ptr<Sketch> ptrSketchBallsCutout = sketches->add(plane);
 	if (!checkReturn(ptrSketchBallsCutout))
 		return nullptr;
-	ptrSketchBallsCutout->sketchCurves()->sketchCircles()->addByCenterRadius(
-		adsk::core::Point3D::create(offset, 0, 0.0),
+	// Defer the profile solve until all curves are in.
+	ptrSketchBallsCutout->isComputeDeferred(gxDeferCompute);
+	Ptr<SketchCircle> ptrCircle = ptrSketchBallsCutout->sketchCurves()->sketchCircles()->addByCenterRadius(
+		adsk::core::Point3D::create(offset, height, 0.0),
 		radius
 	);
+	if (!checkReturn(ptrCircle))
+		return nullptr;
+
+	// Centre on the pitch circle, diameter of a ball.
+	if (!parameterPrefix.empty()) {
+		Ptr<SketchPoint> ptrOrigin = ptrSketchBallsCutout->originPoint();
+		Ptr<SketchPoint> ptrCenter = ptrCircle->centerSketchPoint();
+		if (!checkReturn(ptrSketchBallsCutout->geometricConstraints()->addHorizontalPoints(ptrOrigin, ptrCenter)) ||
+			!addDimension(ptrSketchBallsCutout, ptrOrigin, ptrCenter, HorizontalDimensionOrientation, parameterPrefix + "pitchRadius"))
+			return nullptr;
+		Ptr<SketchDiameterDimension> ptrDiameter = ptrSketchBallsCutout->sketchDimensions()->addDiameterDimension(ptrCircle,
+			adsk::core::Point3D::create(offset + radius, radius, 0.0));
+		if (!checkReturn(ptrDiameter) || !ptrDiameter->parameter()->expression(parameterPrefix + "ballRadius * 2"))
+			return nullptr;
+	}
+	ptrSketchBallsCutout->isComputeDeferred(false);
 	return ptrSketchBallsCutout;
 }
 
-Ptr<Sketch> drawInnerRingSketch(Ptr<Sketches> sketches, Ptr<ConstructionPlane> plane, double radius, double ringWidth, double thickness) {
-	Ptr<Sketch> ptrSketchInnerRing = sketches->add(plane);
-	if (!checkReturn(ptrSketchInnerRing))
-		return nullptr;
-	ptrSketchInnerRing->sketchCurves()->sketchLines()->addByTwoPoints(
-		adsk::core::Point3D::create(radius, -thickness * 0.5, 0),
-		adsk::core::Point3D::create(radius, thickness * 0.5, 0));
-	ptrSketchInnerRing->sketchCurves()->sketchLines()->addByTwoPoints(
-		adsk::core::Point3D::create(radius, thickness * 0.5, 0),
-		adsk::core::Point3D::create(radius + ringWidth, thickness * 0.5, 0));
-	ptrSketchInnerRing->sketchCurves()->sketchLines()->addByTwoPoints(
-		adsk::core::Point3D::create(radius + ringWidth, thickness * 0.5, 0),
-		adsk::core::Point3D::create(radius + ringWidth, -thickness * 0.5, 0));
-	ptrSketchInnerRing->sketchCurves()->sketchLines()->addByTwoPoints(
-		adsk::core::Point3D::create(radius + ringWidth, -thickness * 0.5, 0),
-		adsk::core::Point3D::create(radius, -thickness * 0.5, 0));
-
-	return ptrSketchInnerRing;
-}
-Ptr<Sketch> drawOuterRingSketch(Ptr<Sketches> sketches, Ptr<ConstructionPlane> plane, double radius, double ringWidth, double thickness) {
-	Ptr<Sketch> ptrSketchOuterRing = sketches->add(plane);
-	if (!checkReturn(ptrSketchOuterRing))
-		return nullptr;
-	ptrSketchOuterRing->sketchCurves()->sketchLines()->addByTwoPoints(
-		adsk::core::Point3D::create(radius, -thickness * 0.5, 0),
-		adsk::core::Point3D::create(radius, thickness * 0.5, 0));
-	ptrSketchOuterRing->sketchCurves()->sketchLines()->addByTwoPoints(
-		adsk::core::Point3D::create(radius, thickness * 0.5, 0),
-		adsk::core::Point3D::create(radius - ringWidth, thickness * 0.5, 0));
-	ptrSketchOuterRing->sketchCurves()->sketchLines()->addByTwoPoints(
-		adsk::core::Point3D::create(radius - ringWidth, thickness * 0.5, 0),
-		adsk::core::Point3D::create(radius - ringWidth, -thickness * 0.5, 0));
-	ptrSketchOuterRing->sketchCurves()->sketchLines()->addByTwoPoints(
-		adsk::core::Point3D::create(radius - ringWidth, -thickness * 0.5, 0),
-		adsk::core::Point3D::create(radius, -thickness * 0.5, 0));
-
-	return ptrSketchOuterRing;
+// Draws a ring cross section as four connected lines, starting with the side at the given radius.
+// With a parameter prefix the lines are constrained and dimensioned against the user parameters.
+Ptr<Sketch> drawRingSketch(Ptr<Sketches> sketches, Ptr<ConstructionPlane> plane, double radius, double ringWidth, double thickness, double centerHeight,
+	const std::string &parameterPrefix, const std::string &radiusExpression) {
+	Ptr<Sketch> ptrSketchRing = sketches->add(plane);
+	if (!checkReturn(ptrSketchRing))
+		return nullptr;
+	// Defer the profile solve until all curves are in.
+	ptrSketchRing->isComputeDeferred(gxDeferCompute);
+	Ptr<SketchLines> ptrLines = ptrSketchRing->sketchCurves()->sketchLines();
+	Ptr<SketchLine> ptrSide = ptrLines->addByTwoPoints(
+		adsk::core::Point3D::create(radius, centerHeight - thickness * 0.5, 0),
+		adsk::core::Point3D::create(radius, centerHeight + thickness * 0.5, 0));
+	if (!checkReturn(ptrSide))
+		return nullptr;
+	Ptr<SketchLine> ptrTop = ptrLines->addByTwoPoints(ptrSide->endSketchPoint(),
+		adsk::core::Point3D::create(radius + ringWidth, centerHeight + thickness * 0.5, 0));
+	if (!checkReturn(ptrTop))
+		return nullptr;
+	Ptr<SketchLine> ptrOtherSide = ptrLines->addByTwoPoints(ptrTop->endSketchPoint(),
+		adsk::core::Point3D::create(radius + ringWidth, centerHeight - thickness * 0.5, 0));
+	if (!checkReturn(ptrOtherSide))
+		return nullptr;
+	Ptr<SketchLine> ptrBottom = ptrLines->addByTwoPoints(ptrOtherSide->endSketchPoint(), ptrSide->startSketchPoint());
+	if (!checkReturn(ptrBottom))
+		return nullptr;
+
+	if (!parameterPrefix.empty()) {
+		Ptr<GeometricConstraints> ptrConstraints = ptrSketchRing->geometricConstraints();
+		Ptr<SketchPoint> ptrOrigin = ptrSketchRing->originPoint();
+		if (!checkReturn(ptrConstraints->addVertical(ptrSide)) || !checkReturn(ptrConstraints->addHorizontal(ptrTop)) ||
+			!checkReturn(ptrConstraints->addVertical(ptrOtherSide)) || !checkReturn(ptrConstraints->addHorizontal(ptrBottom)))
+			return nullptr;
+		// The ring is centred on the sketch origin in the axial direction.
+		if (!addDimension(ptrSketchRing, ptrOrigin, ptrSide->startSketchPoint(), HorizontalDimensionOrientation, radiusExpression) ||
+			!addDimension(ptrSketchRing, ptrSide->startSketchPoint(), ptrOtherSide->endSketchPoint(), HorizontalDimensionOrientation, parameterPrefix + "ringWidth") ||
+			!addDimension(ptrSketchRing, ptrSide->startSketchPoint(), ptrSide->endSketchPoint(), VerticalDimensionOrientation, parameterPrefix + "thickness") ||
+			!addDimension(ptrSketchRing, ptrOrigin, ptrSide->endSketchPoint(), VerticalDimensionOrientation, parameterPrefix + "thickness / 2"))
+			return nullptr;
+	}
+	ptrSketchRing->isComputeDeferred(false);
+
+	return ptrSketchRing;
+}
+
+Ptr<Sketch> drawInnerRingSketch(Ptr<Sketches> sketches, Ptr<ConstructionPlane> plane, double radius, double ringWidth, double thickness, double centerHeight,
+	const std::string &parameterPrefix) {
+	return drawRingSketch(sketches, plane, radius, ringWidth, thickness, centerHeight, parameterPrefix, parameterPrefix + "innerDiameter / 2");
+}
+Ptr<Sketch> drawOuterRingSketch(Ptr<Sketches> sketches, Ptr<ConstructionPlane> plane, double radius, double ringWidth, double thickness, double centerHeight,
+	const std::string &parameterPrefix) {
+	return drawRingSketch(sketches, plane, radius, -ringWidth, thickness, centerHeight, parameterPrefix, parameterPrefix + "outerDiameter / 2");
+}
+
+// Draws the full cross section of a roller as four connected lines.
+Ptr<Sketch> drawRollerSketch(Ptr<Sketches> sketches, Ptr<ConstructionPlane> plane, const RollerProfile &roller) {
+	Ptr<Sketch> ptrSketchRoller = sketches->add(plane);
+	if (!checkReturn(ptrSketchRoller))
+		return nullptr;
+	ptrSketchRoller->isComputeDeferred(gxDeferCompute);
+	double cornersR[4], cornersZ[4];
+	rollerCorners(roller, cornersR, cornersZ);
+	Ptr<SketchLines> ptrLines = ptrSketchRoller->sketchCurves()->sketchLines();
+	Ptr<SketchLine> ptrFirst, ptrLast;
+	for (int i = 0; i < 4; ++i) {
+		Ptr<SketchLine> ptrLine;
+		if (!ptrLast)
+			ptrLine = ptrLines->addByTwoPoints(adsk::core::Point3D::create(cornersR[0], cornersZ[0], 0.0), adsk::core::Point3D::create(cornersR[1], cornersZ[1], 0.0));
+		else if (i < 3)
+			ptrLine = ptrLines->addByTwoPoints(ptrLast->endSketchPoint(), adsk::core::Point3D::create(cornersR[i + 1], cornersZ[i + 1], 0.0));
+		else
+			ptrLine = ptrLines->addByTwoPoints(ptrLast->endSketchPoint(), ptrFirst->startSketchPoint());
+		if (!checkReturn(ptrLine))
+			return nullptr;
+		if (!ptrFirst)
+			ptrFirst = ptrLine;
+		ptrLast = ptrLine;
+	}
+	ptrSketchRoller->isComputeDeferred(false);
+	return ptrSketchRoller;
+}
+
+// Moves a sketch point to the given position in sketch coordinates.
+bool moveSketchPoint(Ptr<SketchPoint> point, double x, double y) {
+	if (!checkReturn(point))
+		return false;
+	Ptr<Point3D> ptrPosition = point->geometry();
+	if (!checkReturn(ptrPosition))
+		return false;
+	return point->move(adsk::core::Vector3D::create(x - ptrPosition->x(), y - ptrPosition->y(), 0.0));
+}
+
+// Moves the four lines drawn by drawInnerRingSketch or drawOuterRingSketch to a new ring profile.
+bool updateRingSketch(Ptr<Sketch> sketch, const RingProfile &ring, bool outer) {
+	Ptr<SketchLines> ptrLines = sketch->sketchCurves()->sketchLines();
+	if (!checkReturn(ptrLines) || ptrLines->count() != 4)
+		return false;
+
+	// Corners in the order the lines were drawn.
+	double dStart = outer ? ring.dRadiusMax : ring.dRadiusMin;
+	double dEnd = outer ? ring.dRadiusMin : ring.dRadiusMax;
+	double cornersX[4] = { dStart, dStart, dEnd, dEnd };
+	double dLow = ring.dCenterHeight - ring.dHalfThickness;
+	double dHigh = ring.dCenterHeight + ring.dHalfThickness;
+	double cornersY[4] = { dLow, dHigh, dHigh, dLow };
+
+	sketch->isComputeDeferred(gxDeferCompute);
+	bool xResult = true;
+	for (size_t i = 0; i < 4 && xResult; ++i) {
+		Ptr<SketchLine> ptrLine = ptrLines->item(i);
+		xResult = checkReturn(ptrLine) &&
+			moveSketchPoint(ptrLine->startSketchPoint(), cornersX[i], cornersY[i]) &&
+			moveSketchPoint(ptrLine->endSketchPoint(), cornersX[(i + 1) % 4], cornersY[(i + 1) % 4]);
+	}
+	sketch->isComputeDeferred(false);
+	return xResult;
+}
+
+// Moves the half ball drawn by createBalls and sets the number of balls of its pattern.
+bool updateBalls(Ptr<Component> component, const std::string &name, double ballRadius, double ballsOffset, int ballCount) {
+	Ptr<Sketch> ptrBallSketch = component->sketches()->itemByName(name + " Profile");
+	if (!checkReturn(ptrBallSketch))
+		return false;
+	Ptr<SketchArc> ptrArc = ptrBallSketch->sketchCurves()->sketchArcs()->item(0);
+	Ptr<SketchLine> ptrLine = ptrBallSketch->sketchCurves()->sketchLines()->item(0);
+	if (!checkReturn(ptrArc) || !checkReturn(ptrLine))
+		return false;
+
+	ptrBallSketch->isComputeDeferred(gxDeferCompute);
+	bool xResult = moveSketchPoint(ptrArc->centerSketchPoint(), ballsOffset, 0.0) &&
+		moveSketchPoint(ptrLine->startSketchPoint(), ballsOffset + ballRadius, 0.0) &&
+		moveSketchPoint(ptrLine->endSketchPoint(), ballsOffset - ballRadius, 0.0) &&
+		moveSketchPoint(ptrArc->startSketchPoint(), ballsOffset - ballRadius, 0.0) &&
+		moveSketchPoint(ptrArc->endSketchPoint(), ballsOffset + ballRadius, 0.0);
+	ptrBallSketch->isComputeDeferred(false);
+	if (!xResult)
+		return false;
+
+	Ptr<CircularPatternFeature> ptrPattern = component->features()->circularPatternFeatures()->itemByName(name);
+	if (!checkReturn(ptrPattern))
+		return false;
+	Ptr<ModelParameter> ptrQuantity = ptrPattern->quantity();
+	return checkReturn(ptrQuantity) && ptrQuantity->expression(std::to_string(ballCount));
 }
 
 Ptr<RevolveFeature> createComponentWithRevolve(Ptr<Component> component, Ptr<Sketch> sketch, Ptr<ConstructionAxis> axis) {
@@ -355,39 +869,73 @@ Ptr<RevolveFeature> createComponentWithRevolve(Ptr<Component> component, Ptr<Ske
 	return ptrRevolve;
 }
 
-bool applyFilletToRevolve(Ptr<Component> component, Ptr<RevolveFeature> revolve, double filletRadius) {
+// Fillets the circular edges of the revolved ring that lie on the corners of its
+// profile. The edges of the body are walked instead of those of every face, so
+// each edge is added once, and the edges the raceway and counterbore cuts made
+// are not on a corner and stay sharp.
+Ptr<FilletFeature> applyFilletToRevolve(Ptr<Component> component, Ptr<RevolveFeature> revolve, const RingProfile &ring, double filletRadius,
+	const std::string &parameterPrefix) {
+	Ptr<Profile> ptrProfile = revolve->profile();
+	if (!checkReturn(ptrProfile))
+		return nullptr;
+	Ptr<Sketch> ptrSketch = ptrProfile->parentSketch();
+	if (!checkReturn(ptrSketch))
+		return nullptr;
+
+	// Heights of the ring sides along the axis, the sketch plane may be flipped against it.
+	double dHeights[2];
+	for (int i = 0; i < 2; ++i) {
+		double dSketchHeight = ring.dCenterHeight + (i == 0 ? -ring.dHalfThickness : ring.dHalfThickness);
+		Ptr<Point3D> ptrCorner = ptrSketch->sketchToModelSpace(adsk::core::Point3D::create(ring.dRadiusMin, dSketchHeight, 0.0));
+		if (!checkReturn(ptrCorner))
+			return nullptr;
+		dHeights[i] = ptrCorner->z();
+	}
+
+	const double dTolerance = kMinFeatureSize * 0.1;
 	Ptr<ObjectCollection> ptrColEdges = adsk::core::ObjectCollection::create();
-	Ptr<FilletFeature> ptrFillet;
-	Ptr<BRepFaces> ptrFaces = revolve->faces();
-	for (Ptr<BRepFace> face : ptrFaces) {
-		for (Ptr<BRepEdge> edge : face->edges()) {
-			ptrColEdges->add(edge);
+	for (Ptr<BRepBody> body : revolve->bodies()) {
+		for (Ptr<BRepEdge> edge : body->edges()) {
+			Ptr<Circle3D> ptrCircle = edge->geometry();
+			if (!ptrCircle)
+				continue;
+			double dRadius = ptrCircle->radius();
+			double dHeight = ptrCircle->center()->z();
+			bool xCornerRadius = fabs(dRadius - ring.dRadiusMin) < dTolerance || fabs(dRadius - ring.dRadiusMax) < dTolerance;
+			bool xCornerHeight = fabs(dHeight - dHeights[0]) < dTolerance || fabs(dHeight - dHeights[1]) < dTolerance;
+			if (xCornerRadius && xCornerHeight)
+				ptrColEdges->add(edge);
 		}
 	}
+	if (ptrColEdges->count() == 0)
+		return nullptr;
+
+	Ptr<FilletFeature> ptrFillet;
 	// Create a fillet input to be able to define the input needed for a fillet.
 	Ptr<FilletFeatures> ptrFillets = component->features()->filletFeatures();
 	if (!checkReturn(ptrFillets))
-		return false;
+		return nullptr;
 
 	Ptr<FilletFeatureInput> ptrFilletInput = ptrFillets->createInput();
 	if (!checkReturn(ptrFilletInput))
-		return false;
+		return nullptr;
 
 	// Define fillet radius
-	Ptr<ValueInput> ptrRadius = adsk::core::ValueInput::createByReal(filletRadius);
+	Ptr<ValueInput> ptrRadius = parameterPrefix.empty() ?
+		adsk::core::ValueInput::createByReal(filletRadius) : adsk::core::ValueInput::createByString(parameterPrefix + "filletRadius");
 	if (!checkReturn(ptrRadius))
-		return false;
+		return nullptr;
 
 	bool xResult = ptrFilletInput->addConstantRadiusEdgeSet(ptrColEdges, ptrRadius, false);
 	if (!xResult)
-		return false;
+		return nullptr;
 
 	// Create the extrusion.
 	ptrFillet = ptrFillets->add(ptrFilletInput);
 	if (!checkReturn(ptrFillet))
-		return false;
+		return nullptr;
 
-	return true;
+	return ptrFillet;
 }
 Ptr<RevolveFeature> applyRevolveCut(Ptr<Component> component, Ptr<Sketch> sketch, Ptr<ConstructionAxis> axis) {
 	Ptr<Profile> ptrProfile = nullptr;
@@ -421,23 +969,14 @@ Ptr<RevolveFeature> applyRevolveCut(Ptr<Component> component, Ptr<Sketch> sketch
 	return ptrRevolve;
 }
 
-bool createBalls(Ptr<Component> newComp, Ptr<RevolveFeature> innerRing, double ballRadius, double ballsOffset) {
-	Ptr<Sketch> ptrBallSketch = newComp->sketches()->add(newComp->xZConstructionPlane());
-	if (!checkReturn(ptrBallSketch))
-		return nullptr;
-	ptrBallSketch->sketchCurves()->sketchArcs()->addByCenterStartSweep(
-		adsk::core::Point3D::create(ballsOffset, 0, 0.0),
-		adsk::core::Point3D::create(ballsOffset - ballRadius, 0, 0.0),
-		180.0
-	);
-	ptrBallSketch->sketchCurves()->sketchLines()->addByTwoPoints(
-		adsk::core::Point3D::create(ballsOffset + ballRadius, 0, 0.0),
-		adsk::core::Point3D::create(ballsOffset - ballRadius, 0, 0.0)
-	);
-
+// Revolves the profile of one rolling element around the axis line of its sketch
+// and copies the body around the bearing axis by a circular pattern. Balls and
+// rollers only differ in the sketch, cage pockets are the same revolve as a cut.
+bool patternRevolvedElement(Ptr<Component> newComp, Ptr<Sketch> sketch, Ptr<SketchLine> axis, const std::string &name, const std::string &countExpression,
+	FeatureOperations operation) {
 	Ptr<Profile> ptrProfile = nullptr;
 
-	ptrProfile = ptrBallSketch->profiles()->item(0);
+	ptrProfile = sketch->profiles()->item(0);
 	if (!checkReturn(ptrProfile))
 		return false;
 
@@ -445,7 +984,8 @@ bool createBalls(Ptr<Component> newComp, Ptr<RevolveFeature> innerRing, double b
 	if (!checkReturn(ptrRevolves))
 		return false;
 
-	Ptr<RevolveFeatureInput> ptrRevolveInput = ptrRevolves->createInput(ptrProfile, newComp->xConstructionAxis(), NewBodyFeatureOperation);
+	// Revolved around its own axis line, so the element stays in place wherever it is in the sketch.
+	Ptr<RevolveFeatureInput> ptrRevolveInput = ptrRevolves->createInput(ptrProfile, axis, operation);
 	if (!checkReturn(ptrRevolveInput))
 		return false;
 
@@ -475,8 +1015,7 @@ bool createBalls(Ptr<Component> newComp, Ptr<RevolveFeature> innerRing, double b
 	if (!checkReturn(ptrPatternInput))
 		return false;
 
-	int iBallCount = (int)(2.0 * 3.141592 * ballsOffset / (ballRadius * 2.0)) - 1;
-	Ptr<ValueInput> ptrBallCount = adsk::core::ValueInput::createByString(std::to_string(iBallCount));
+	Ptr<ValueInput> ptrBallCount = adsk::core::ValueInput::createByString(countExpression);
 	if (!checkReturn(ptrBallCount))
 		return false;
 
@@ -484,104 +1023,290 @@ bool createBalls(Ptr<Component> newComp, Ptr<RevolveFeature> innerRing, double b
 	Ptr<CircularPatternFeature> ptrPattern = ptrCircPatterns->add(ptrPatternInput);
 	if (!checkReturn(ptrPattern))
 		return false;
+	ptrPattern->name(name);
 
 	return true;
 }
 
-// Builds a ball bearing.
-Ptr<Component> drawBallBearing(Ptr<Design> design, double innerDiameter, double outerDiameter, double thickness)
-{
-	Ptr<Component> ptrNewComp = generateComponent(design);
-	if (!checkReturn(ptrNewComp))
+bool createBalls(Ptr<Component> newComp, Ptr<RevolveFeature> innerRing, const std::string &name, double ballRadius, double ballsOffset, double height, int ballCount,
+	const std::string &parameterPrefix, FeatureOperations operation = NewBodyFeatureOperation) {
+	Ptr<Sketch> ptrBallSketch = newComp->sketches()->add(newComp->xZConstructionPlane());
+	if (!checkReturn(ptrBallSketch))
 		return nullptr;
+	ptrBallSketch->name(name + " Profile");
+	ptrBallSketch->isComputeDeferred(gxDeferCompute);
+	Ptr<SketchArc> ptrArc = ptrBallSketch->sketchCurves()->sketchArcs()->addByCenterStartSweep(
+		adsk::core::Point3D::create(ballsOffset, height, 0.0),
+		adsk::core::Point3D::create(ballsOffset - ballRadius, height, 0.0),
+		180.0
+	);
+	if (!checkReturn(ptrArc))
+		return false;
+	Ptr<SketchLine> ptrLine = ptrBallSketch->sketchCurves()->sketchLines()->addByTwoPoints(ptrArc->endSketchPoint(), ptrArc->startSketchPoint());
+	if (!checkReturn(ptrLine))
+		return false;
+
+	// The half ball is centred on the pitch circle.
+	if (!parameterPrefix.empty()) {
+		Ptr<GeometricConstraints> ptrConstraints = ptrBallSketch->geometricConstraints();
+		Ptr<SketchPoint> ptrOrigin = ptrBallSketch->originPoint();
+		Ptr<SketchPoint> ptrCenter = ptrArc->centerSketchPoint();
+		if (!checkReturn(ptrConstraints->addHorizontal(ptrLine)) ||
+			!checkReturn(ptrConstraints->addCoincident(ptrCenter, ptrLine)) ||
+			!checkReturn(ptrConstraints->addHorizontalPoints(ptrOrigin, ptrCenter)) ||
+			!addDimension(ptrBallSketch, ptrOrigin, ptrCenter, HorizontalDimensionOrientation, parameterPrefix + "pitchRadius"))
+			return false;
+		Ptr<SketchRadialDimension> ptrRadius = ptrBallSketch->sketchDimensions()->addRadialDimension(ptrArc,
+			adsk::core::Point3D::create(ballsOffset, -ballRadius * 1.5, 0.0));
+		if (!checkReturn(ptrRadius) || !ptrRadius->parameter()->expression(parameterPrefix + "ballRadius"))
+			return false;
+	}
+	ptrBallSketch->isComputeDeferred(false);
+
+	return patternRevolvedElement(newComp, ptrBallSketch, ptrLine, name,
+		parameterPrefix.empty() ? std::to_string(ballCount) : parameterPrefix + "ballCount", operation);
+}
+
+// Draws half of the cross section of a roller, on the side away from the bearing
+// axis, starting with the roller axis, and patterns it like a ball.
+bool createRollers(Ptr<Component> newComp, const std::string &name, const RollerProfile &roller, int rollerCount,
+	FeatureOperations operation = NewBodyFeatureOperation) {
+	Ptr<Sketch> ptrRollerSketch = newComp->sketches()->add(newComp->xZConstructionPlane());
+	if (!checkReturn(ptrRollerSketch))
+		return false;
+	ptrRollerSketch->name(name + " Profile");
+	ptrRollerSketch->isComputeDeferred(gxDeferCompute);
+
+	double endsR[2], endsZ[2], radii[2];
+	double cornersR[4], cornersZ[4];
+	rollerEnds(roller, endsR, endsZ, radii);
+	rollerCorners(roller, cornersR, cornersZ);
+	Ptr<SketchLines> ptrLines = ptrRollerSketch->sketchCurves()->sketchLines();
+	Ptr<SketchLine> ptrAxis = ptrLines->addByTwoPoints(adsk::core::Point3D::create(endsR[0], endsZ[0], 0.0), adsk::core::Point3D::create(endsR[1], endsZ[1], 0.0));
+	if (!checkReturn(ptrAxis))
+		return false;
+	Ptr<SketchLine> ptrSmallEnd = ptrLines->addByTwoPoints(ptrAxis->endSketchPoint(), adsk::core::Point3D::create(cornersR[2], cornersZ[2], 0.0));
+	if (!checkReturn(ptrSmallEnd))
+		return false;
+	Ptr<SketchLine> ptrMantle = ptrLines->addByTwoPoints(ptrSmallEnd->endSketchPoint(), adsk::core::Point3D::create(cornersR[1], cornersZ[1], 0.0));
+	if (!checkReturn(ptrMantle))
+		return false;
+	if (!checkReturn(ptrLines->addByTwoPoints(ptrMantle->endSketchPoint(), ptrAxis->startSketchPoint())))
+		return false;
+	ptrRollerSketch->isComputeDeferred(false);
+
+	return patternRevolvedElement(newComp, ptrRollerSketch, ptrAxis, name, std::to_string(rollerCount), operation);
+}
 
-	// Create a new sketch.
-	Ptr<Sketches> ptrSketches = ptrNewComp->sketches();
-	if (!checkReturn(ptrSketches))
+// Builds all balls as one temporary body made from united spheres.
+Ptr<BRepBody> createBallSpheres(const BallPlacement &placement) {
+	Ptr<TemporaryBRepManager> ptrTempBRep = TemporaryBRepManager::get();
+	if (!checkReturn(ptrTempBRep))
 		return nullptr;
 
-	Ptr<ConstructionPlane> ptrXyPlane = ptrNewComp->xZConstructionPlane();
-	if (!checkReturn(ptrXyPlane))
+	Ptr<BRepBody> ptrBalls;
+	for (int i = 0; i < placement.iCount; ++i) {
+		Ptr<Point3D> ptrCenter = adsk::core::Point3D::create(placement.centersX[i], placement.centersY[i], placement.dHeight);
+		Ptr<BRepBody> ptrBall = ptrTempBRep->createSphere(ptrCenter, placement.dBallRadius);
+		if (!checkReturn(ptrBall))
+			return nullptr;
+
+		if (!ptrBalls)
+			ptrBalls = ptrBall;
+		else if (!ptrTempBRep->booleanOperation(ptrBalls, ptrBall, UnionBooleanType))
+			return nullptr;
+	}
+	return ptrBalls;
+}
+
+// Builds all rollers as one temporary body made from united cones.
+Ptr<BRepBody> createRollerCones(const RollerProfile &roller, const BallPlacement &placement) {
+	Ptr<TemporaryBRepManager> ptrTempBRep = TemporaryBRepManager::get();
+	if (!checkReturn(ptrTempBRep))
 		return nullptr;
 
-	Ptr<ConstructionAxis> ptrZAxis = ptrNewComp->zConstructionAxis();
+	double endsR[2], endsZ[2], radii[2];
+	rollerEnds(roller, endsR, endsZ, radii);
+	Ptr<BRepBody> ptrRollers;
+	for (int i = 0; i < placement.iCount; ++i) {
+		double dCos = cos(placement.dAngleStep * i);
+		double dSin = sin(placement.dAngleStep * i);
+		// The same place as the rollers revolved from the XZ sketches.
+		Ptr<Point3D> ptrLarge = adsk::core::Point3D::create(endsR[0] * dCos, endsR[0] * dSin, modelHeight(endsZ[0]));
+		Ptr<Point3D> ptrSmall = adsk::core::Point3D::create(endsR[1] * dCos, endsR[1] * dSin, modelHeight(endsZ[1]));
+		Ptr<BRepBody> ptrRoller = ptrTempBRep->createCylinderOrCone(ptrLarge, radii[0], ptrSmall, radii[1]);
+		if (!checkReturn(ptrRoller))
+			return nullptr;
+
+		if (!ptrRollers)
+			ptrRollers = ptrRoller;
+		else if (!ptrTempBRep->booleanOperation(ptrRollers, ptrRoller, UnionBooleanType))
+			return nullptr;
+	}
+	return ptrRollers;
+}
+
+// Adds the rolling elements built with the temporary BRep manager to the
+// component, so the timeline only gets one base feature.
+bool addRollingElementBody(Ptr<Component> newComp, const std::string &name, Ptr<BRepBody> ptrBalls) {
+	if (!ptrBalls)
+		return false;
 
-	double dBallRadius = thickness * 0.6;
-	if (dBallRadius > ((outerDiameter - innerDiameter) * 0.5 * 0.6)) {
-		dBallRadius = (outerDiameter - innerDiameter) * 0.5 * 0.6;
+	// Parametric designs need a base feature to hold a body that has no feature of its own.
+	Ptr<Design> ptrDesign = newComp->parentDesign();
+	if (ptrDesign && ptrDesign->designType() == ParametricDesignType) {
+		Ptr<BaseFeature> ptrBaseFeature = newComp->features()->baseFeatures()->add();
+		if (!checkReturn(ptrBaseFeature))
+			return false;
+		ptrBaseFeature->name(name);
+		ptrBaseFeature->startEdit();
+		Ptr<BRepBody> ptrBody = newComp->bRepBodies()->add(ptrBalls, ptrBaseFeature);
+		ptrBaseFeature->finishEdit();
+		if (!checkReturn(ptrBody))
+			return false;
+		return ptrBody->name(name);
 	}
-	dBallRadius *= 0.5;
 
-	double dRingWidth = (outerDiameter - innerDiameter) * 0.25 - dBallRadius * 0.5;
+	Ptr<BRepBody> ptrBody = newComp->bRepBodies()->add(ptrBalls);
+	return checkReturn(ptrBody) && ptrBody->name(name);
+}
 
-	// Draw sketch for the ball cutout
-	Ptr<Sketch> ptrSketchBallsCutout = drawBallCutoutSketch(ptrSketches, ptrXyPlane, dBallRadius, (outerDiameter + innerDiameter) * 0.5 * 0.5);
+// Creates all balls at once as a single body of united spheres.
+bool createBallsAsBody(Ptr<Component> newComp, const std::string &name, const BallPlacement &placement) {
+	return addRollingElementBody(newComp, name, createBallSpheres(placement));
+}
 
-	// Draw sketch of the inner ring
-	Ptr<Sketch> ptrSketchInnerRing = drawInnerRingSketch(ptrSketches, ptrXyPlane, innerDiameter * 0.5, dRingWidth, thickness);
+// Creates all rollers at once as a single body of united cones.
+bool createRollersAsBody(Ptr<Component> newComp, const std::string &name, const RollerProfile &roller, const BallPlacement &placement) {
+	return addRollingElementBody(newComp, name, createRollerCones(roller, placement));
+}
 
-	// Draw outer ring sketch
-	Ptr<Sketch> ptrSketchOuterRing = drawOuterRingSketch(ptrSketches, ptrXyPlane, outerDiameter * 0.5, dRingWidth, thickness);
+// Finds the component of a ball or roller that an earlier bearing created with the same key.
+Ptr<Component> findRollingElementComponent(Ptr<Design> design, const std::string &key) {
+	std::vector<Ptr<Attribute>> attributes = design->findAttributes("BallBearing", "elementKey");
+	for (Ptr<Attribute> attribute : attributes) {
+		if (!attribute || attribute->value() != key)
+			continue;
+		Ptr<Component> ptrComp = attribute->parent();
+		if (ptrComp)
+			return ptrComp;
+	}
+	return nullptr;
+}
 
-	//////// Revolve the profiles to get rings
+// Adds an occurrence of the element component for every position of the
+// placement. Without a component the first occurrence creates it from the body,
+// which is modelled at the origin with its axis along Z.
+bool addRollingElementOccurrences(Ptr<Component> newComp, Ptr<Component> element, Ptr<BRepBody> body, const std::string &name, const std::string &key,
+	const BallPlacement &placement, double axisAngle) {
+	Ptr<Occurrences> ptrOccs = newComp->occurrences();
+	if (!checkReturn(ptrOccs))
+		return false;
 
-	// Create a revolve input to be able to define the input needed for an revolve
-	// while specifying the profile and that a new component is to be created
+	std::vector<double> cells(16);
+	for (int i = 0; i < placement.iCount; ++i) {
+		rollingElementTransform(placement, axisAngle, i, cells.data());
+		Ptr<Matrix3D> ptrTransform = adsk::core::Matrix3D::create();
+		if (!checkReturn(ptrTransform) || !ptrTransform->setWithArray(cells))
+			return false;
 
-	// Inner Ring
-	// Create the revolve.
-	Ptr<RevolveFeature> ptrRevolveInnerRing = createComponentWithRevolve(ptrNewComp, ptrSketchInnerRing, ptrZAxis);
-	if (!checkReturn(ptrRevolveInnerRing))
-		return nullptr;
-	Ptr<Component> ptrCmpInnerRing = ptrRevolveInnerRing->parentComponent();
-	ptrCmpInnerRing->name("Inner Ring");
+		if (element) {
+			if (!checkReturn(ptrOccs->addExistingComponent(element, ptrTransform)))
+				return false;
+			continue;
+		}
 
-	// Fillet 
-	if (!applyFilletToRevolve(ptrNewComp, ptrRevolveInnerRing, dRingWidth * 0.1)) {
-		return nullptr;
+		Ptr<Occurrence> ptrOcc = ptrOccs->addNewComponent(ptrTransform);
+		if (!checkReturn(ptrOcc))
+			return false;
+		element = ptrOcc->component();
+		if (!checkReturn(element) || !addRollingElementBody(element, name, body))
+			return false;
+		element->name(name);
+		if (!checkReturn(element->attributes()->add("BallBearing", "elementKey", key)))
+			return false;
 	}
+	return true;
+}
 
-	// Outer Ring
-	// Create the revolve.
-	Ptr<RevolveFeature> ptrRevolveOuterRing = createComponentWithRevolve(ptrNewComp, ptrSketchOuterRing, ptrZAxis);
-	if (!checkReturn(ptrRevolveOuterRing))
-		return nullptr;
-	ptrRevolveOuterRing->parentComponent()->name("Outer Ring");
+bool createBallOccurrences(Ptr<Component> newComp, const BallPlacement &placement) {
+	char buffer[64];
+	std::snprintf(buffer, sizeof(buffer), "ball;radius=%.17g", placement.dBallRadius);
+	Ptr<Component> ptrBall = findRollingElementComponent(newComp->parentDesign(), buffer);
+	Ptr<BRepBody> ptrBody;
+	if (!ptrBall) {
+		Ptr<TemporaryBRepManager> ptrTempBRep = TemporaryBRepManager::get();
+		if (!checkReturn(ptrTempBRep))
+			return false;
+		ptrBody = ptrTempBRep->createSphere(adsk::core::Point3D::create(0.0, 0.0, 0.0), placement.dBallRadius);
+		if (!checkReturn(ptrBody))
+			return false;
+	}
+	return addRollingElementOccurrences(newComp, ptrBall, ptrBody, "Ball", buffer, placement, 0.0);
+}
 
-	// Fillet 
-	if (!applyFilletToRevolve(ptrNewComp, ptrRevolveOuterRing, dRingWidth * 0.1)) {
-		return nullptr;
+bool createRollerOccurrences(Ptr<Component> newComp, const RollerProfile &roller, const BallPlacement &placement) {
+	char buffer[128];
+	std::snprintf(buffer, sizeof(buffer), "roller;length=%.17g;radius=%.17g;taper=%.17g", roller.dLength, roller.dRadius, roller.dTaperAngle);
+	Ptr<Component> ptrRoller = findRollingElementComponent(newComp->parentDesign(), buffer);
+	Ptr<BRepBody> ptrBody;
+	if (!ptrRoller) {
+		Ptr<TemporaryBRepManager> ptrTempBRep = TemporaryBRepManager::get();
+		if (!checkReturn(ptrTempBRep))
+			return false;
+		// The large end is below the origin, rollingElementTransform turns the axis like the one of the sketched rollers.
+		double dHalfLength = roller.dLength * 0.5;
+		double dTaper = dHalfLength * tan(roller.dTaperAngle);
+		ptrBody = ptrTempBRep->createCylinderOrCone(adsk::core::Point3D::create(0.0, 0.0, -dHalfLength), roller.dRadius + dTaper,
+			adsk::core::Point3D::create(0.0, 0.0, dHalfLength), roller.dRadius - dTaper);
+		if (!checkReturn(ptrBody))
+			return false;
 	}
+	return addRollingElementOccurrences(newComp, ptrRoller, ptrBody, "Roller", buffer, placement, roller.dAxisAngle);
+}
 
-	// Balls cutout
-	// Create the cut.
-	Ptr<RevolveFeature> ptrRevolveBallsCutout = applyRevolveCut(ptrNewComp, ptrSketchBallsCutout, ptrZAxis);
-	if (!checkReturn(ptrRevolveBallsCutout))
-		return nullptr;
+// Replaces the balls made by createBallsAsBody.
+bool replaceBallBody(Ptr<Component> component, const std::string &name, const BallPlacement &placement) {
+	Ptr<BRepBody> ptrBalls = createBallSpheres(placement);
+	if (!ptrBalls)
+		return false;
 
-	// Add balls
-	if (!createBalls(ptrNewComp, ptrRevolveInnerRing, dBallRadius, (innerDiameter + outerDiameter) * 0.5 * 0.5)) {
-		return nullptr;
+	Ptr<BaseFeature> ptrBaseFeature = component->features()->baseFeatures()->itemByName(name);
+	if (ptrBaseFeature) {
+		ptrBaseFeature->startEdit();
+		for (Ptr<BRepBody> ptrOldBody : ptrBaseFeature->bodies())
+			ptrOldBody->deleteMe();
+		Ptr<BRepBody> ptrBody = component->bRepBodies()->add(ptrBalls, ptrBaseFeature);
+		ptrBaseFeature->finishEdit();
+		return checkReturn(ptrBody) && ptrBody->name(name);
 	}
 
-	// Create joint
+	Ptr<BRepBody> ptrOldBody = component->bRepBodies()->itemByName(name);
+	if (!checkReturn(ptrOldBody) || !ptrOldBody->deleteMe())
+		return false;
+	Ptr<BRepBody> ptrBody = component->bRepBodies()->add(ptrBalls);
+	return checkReturn(ptrBody) && ptrBody->name(name);
+}
+
+// Joins the rings with a revolute joint around the bearing axis.
+bool createBearingJoint(Ptr<Component> component, Ptr<RevolveFeature> innerRing, Ptr<RevolveFeature> outerRing) {
 	// Create the first joint geometry with the side face
-	Ptr<JointGeometry> ptrJntGeometryInner = JointGeometry::createByNonPlanarFace(ptrRevolveInnerRing->faces()->item(2), StartKeyPoint);
+	Ptr<JointGeometry> ptrJntGeometryInner = JointGeometry::createByNonPlanarFace(innerRing->faces()->item(2), StartKeyPoint);
 	if (!checkReturn(ptrJntGeometryInner))
-		return nullptr;
+		return false;
 
 	// Create the second joint geometry with prof1
-	Ptr<JointGeometry> ptrJntGeometryOuter = JointGeometry::createByNonPlanarFace(ptrRevolveOuterRing->faces()->item(0), StartKeyPoint);
+	Ptr<JointGeometry> ptrJntGeometryOuter = JointGeometry::createByNonPlanarFace(outerRing->faces()->item(0), StartKeyPoint);
 	if (!checkReturn(ptrJntGeometryOuter))
-		return nullptr;
+		return false;
 
 	// Create joint input
-	Ptr<Joints> ptrJoints = ptrNewComp->joints();
+	Ptr<Joints> ptrJoints = component->joints();
 	if (!checkReturn(ptrJoints))
-		return nullptr;
+		return false;
 	Ptr<JointInput> ptrJntInput = ptrJoints->createInput(ptrJntGeometryInner, ptrJntGeometryOuter);
 	if (!checkReturn(ptrJntInput))
-		return nullptr;
+		return false;
 
 	// Set the joint input
 	ptrJntInput->isFlipped(false);
@@ -590,15 +1315,823 @@ Ptr<Component> drawBallBearing(Ptr<Design> design, double innerDiameter, double
 	// Create the joint
 	Ptr<Joint> ptrJoint = ptrJoints->add(ptrJntInput);
 	if (!checkReturn(ptrJoint))
+		return false;
+
+	return true;
+}
+
+// Implements the modelling calls of the bearing build with the Fusion API.
+// Handles are positions in the list of created objects.
+class FusionBackend : public BearingBackend
+{
+public:
+	explicit FusionBackend(Ptr<Design> design) : mptrDesign(design), miNextParameter(1) {}
+
+	template <class T>
+	Ptr<T> object(BackendHandle handle) const
+	{
+		if (handle <= 0 || handle > (int)mObjects.size())
+			return nullptr;
+		return mObjects[handle - 1];
+	}
+
+	// Makes an object that was not created by this backend, like a selected bearing, usable in calls.
+	BackendHandle add(Ptr<Base> object)
+	{
+		if (!object)
+			return 0;
+		mObjects.push_back(object);
+		return (BackendHandle)mObjects.size();
+	}
+
+	BackendHandle insertCachedBearing(const std::string &key) override
+	{
+		return add(insertCachedBallBearing(mptrDesign, key));
+	}
+
+	BackendHandle createComponent() override
+	{
+		return add(generateComponent(mptrDesign));
+	}
+
+	int occurrenceCount(BackendHandle component) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		if (!ptrComp)
+			return 0;
+		Ptr<OccurrenceList> ptrOccs = mptrDesign->rootComponent()->allOccurrencesByComponent(ptrComp);
+		if (!checkReturn(ptrOccs))
+			return 0;
+		return (int)ptrOccs->count();
+	}
+
+	BackendHandle sketchCircle(BackendHandle component, const std::string &name, const RacewayCircle &circle) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		if (!ptrComp)
+			return 0;
+		Ptr<Sketch> ptrSketch = drawBallCutoutSketch(ptrComp->sketches(), ptrComp->xZConstructionPlane(), circle.dRadius, circle.dCenterRadius,
+			circle.dCenterHeight, prefix(component));
+		if (!ptrSketch)
+			return 0;
+		ptrSketch->name(name);
+		return add(ptrSketch);
+	}
+
+	BackendHandle sketchRing(BackendHandle component, const std::string &name, const RingProfile &ring, bool outer) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		if (!ptrComp)
+			return 0;
+		double dRingWidth = ring.dRadiusMax - ring.dRadiusMin;
+		Ptr<Sketch> ptrSketch;
+		if (outer)
+			ptrSketch = drawOuterRingSketch(ptrComp->sketches(), ptrComp->xZConstructionPlane(), ring.dRadiusMax, dRingWidth, ring.dHalfThickness * 2.0,
+				ring.dCenterHeight, prefix(component));
+		else
+			ptrSketch = drawInnerRingSketch(ptrComp->sketches(), ptrComp->xZConstructionPlane(), ring.dRadiusMin, dRingWidth, ring.dHalfThickness * 2.0,
+				ring.dCenterHeight, prefix(component));
+		if (!ptrSketch)
+			return 0;
+		ptrSketch->name(name);
+		return add(ptrSketch);
+	}
+
+	BackendHandle sketchCage(BackendHandle component, const std::string &name, const CageProfile &cage) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		if (!ptrComp)
+			return 0;
+		const RingProfile &band = cage.band;
+		Ptr<Sketch> ptrSketch = drawInnerRingSketch(ptrComp->sketches(), ptrComp->xZConstructionPlane(), band.dRadiusMin, band.dRadiusMax - band.dRadiusMin,
+			band.dHalfThickness * 2.0, band.dCenterHeight, "");
+		if (!ptrSketch)
+			return 0;
+		ptrSketch->name(name);
+		return add(ptrSketch);
+	}
+
+	BackendHandle sketchRoller(BackendHandle component, const std::string &name, const RollerProfile &roller) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		if (!ptrComp)
+			return 0;
+		Ptr<Sketch> ptrSketch = drawRollerSketch(ptrComp->sketches(), ptrComp->xZConstructionPlane(), roller);
+		if (!ptrSketch)
+			return 0;
+		ptrSketch->name(name);
+		return add(ptrSketch);
+	}
+
+	BackendHandle revolveRing(BackendHandle component, BackendHandle sketch, const std::string &name) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		Ptr<Sketch> ptrSketch = object<Sketch>(sketch);
+		if (!ptrComp || !ptrSketch)
+			return 0;
+		Ptr<RevolveFeature> ptrRevolve = createComponentWithRevolve(ptrComp, ptrSketch, ptrComp->zConstructionAxis());
+		if (!ptrRevolve)
+			return 0;
+		ptrRevolve->name(name);
+		ptrRevolve->parentComponent()->name(name);
+		return add(ptrRevolve);
+	}
+
+	BackendHandle revolveCut(BackendHandle component, BackendHandle sketch, const std::string &name) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		Ptr<Sketch> ptrSketch = object<Sketch>(sketch);
+		if (!ptrComp || !ptrSketch)
+			return 0;
+		Ptr<RevolveFeature> ptrRevolve = applyRevolveCut(ptrComp, ptrSketch, ptrComp->zConstructionAxis());
+		if (!ptrRevolve)
+			return 0;
+		ptrRevolve->name(name);
+		return add(ptrRevolve);
+	}
+
+	BackendHandle fillet(BackendHandle component, BackendHandle revolve, const RingProfile &ring, const std::string &name, double radius) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		Ptr<RevolveFeature> ptrRevolve = object<RevolveFeature>(revolve);
+		if (!ptrComp || !ptrRevolve)
+			return 0;
+		Ptr<FilletFeature> ptrFillet = applyFilletToRevolve(ptrComp, ptrRevolve, ring, radius, prefix(component));
+		if (!ptrFillet)
+			return 0;
+		ptrFillet->name(name);
+		return add(ptrFillet);
+	}
+
+	bool patternBalls(BackendHandle component, BackendHandle innerRing, const std::string &name, double ballRadius, double pitchRadius, double height, int count) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		return ptrComp && createBalls(ptrComp, object<RevolveFeature>(innerRing), name, ballRadius, pitchRadius, height, count, prefix(component));
+	}
+
+	bool ballBody(BackendHandle component, const std::string &name, const BallPlacement &placement) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		return ptrComp && createBallsAsBody(ptrComp, name, placement);
+	}
+
+	bool ballOccurrences(BackendHandle component, const std::string &, const BallPlacement &placement) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		return ptrComp && createBallOccurrences(ptrComp, placement);
+	}
+
+	bool rollerOccurrences(BackendHandle component, const std::string &, const RollerProfile &roller, const BallPlacement &placement) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		return ptrComp && createRollerOccurrences(ptrComp, roller, placement);
+	}
+
+	bool patternRollers(BackendHandle component, BackendHandle, const std::string &name, const RollerProfile &roller, int count) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		return ptrComp && createRollers(ptrComp, name, roller, count);
+	}
+
+	bool rollerBody(BackendHandle component, const std::string &name, const RollerProfile &roller, const BallPlacement &placement) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		return ptrComp && createRollersAsBody(ptrComp, name, roller, placement);
+	}
+
+	// The pockets are cut in the component of the cage, so they cannot touch the rings or the balls.
+	bool ballPockets(BackendHandle, BackendHandle cage, const std::string &name, const RacewayCircle &pocket, int count) override
+	{
+		Ptr<RevolveFeature> ptrCage = object<RevolveFeature>(cage);
+		return ptrCage && createBalls(ptrCage->parentComponent(), nullptr, name, pocket.dRadius, pocket.dCenterRadius, pocket.dCenterHeight, count, "",
+			CutFeatureOperation);
+	}
+
+	bool rollerPockets(BackendHandle, BackendHandle cage, const std::string &name, const RollerProfile &pocket, int count) override
+	{
+		Ptr<RevolveFeature> ptrCage = object<RevolveFeature>(cage);
+		return ptrCage && createRollers(ptrCage->parentComponent(), name, pocket, count, CutFeatureOperation);
+	}
+
+	bool joint(BackendHandle component, BackendHandle innerRing, BackendHandle outerRing) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		Ptr<RevolveFeature> ptrInnerRing = object<RevolveFeature>(innerRing);
+		Ptr<RevolveFeature> ptrOuterRing = object<RevolveFeature>(outerRing);
+		return ptrComp && ptrInnerRing && ptrOuterRing && createBearingJoint(ptrComp, ptrInnerRing, ptrOuterRing);
+	}
+
+	bool cageJoint(BackendHandle component, BackendHandle innerRing, BackendHandle cage) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		Ptr<RevolveFeature> ptrInnerRing = object<RevolveFeature>(innerRing);
+		Ptr<RevolveFeature> ptrCage = object<RevolveFeature>(cage);
+		return ptrComp && ptrInnerRing && ptrCage && createBearingJoint(ptrComp, ptrInnerRing, ptrCage);
+	}
+
+	bool setName(BackendHandle component, const std::string &name) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		return ptrComp && ptrComp->name(name);
+	}
+
+	bool setAttribute(BackendHandle component, const std::string &name, const std::string &value) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		if (!ptrComp || !checkReturn(ptrComp->attributes()->add("BallBearing", name, value)))
+			return false;
+		if (name == "parameterPrefix")
+			mPrefixes[component] = value;
+		return true;
+	}
+
+	bool getAttribute(BackendHandle component, const std::string &name, std::string *value) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		if (!ptrComp)
+			return false;
+		Ptr<Attribute> ptrAttribute = ptrComp->attributes()->itemByName("BallBearing", name);
+		if (!ptrAttribute)
+			return false;
+		*value = ptrAttribute->value();
+		return true;
+	}
+
+	std::string newParameterPrefix() override
+	{
+		// Direct modelling designs have no user parameters, their bearings keep fixed sizes.
+		if (mptrDesign->designType() != ParametricDesignType)
+			return std::string();
+		Ptr<UserParameters> ptrParameters = mptrDesign->userParameters();
+		// The search starts at 1 for every design, numbers freed by deleted bearings are used again.
+		while (ptrParameters->itemByName("Bearing" + std::to_string(miNextParameter) + "_innerDiameter"))
+			++miNextParameter;
+		return "Bearing" + std::to_string(miNextParameter++) + "_";
+	}
+
+	bool setUserParameters(const std::vector<BearingParameter> &parameters) override
+	{
+		Ptr<UserParameters> ptrParameters = mptrDesign->userParameters();
+		if (!checkReturn(ptrParameters))
+			return false;
+		// New parameters are added one by one, changed ones go through modifyParameters
+		// so that the design is recomputed once for all of them.
+		std::vector<Ptr<Parameter>> changed;
+		std::vector<Ptr<ValueInput>> values;
+		for (const BearingParameter &parameter : parameters) {
+			Ptr<ValueInput> ptrValue = adsk::core::ValueInput::createByString(parameter.strExpression);
+			if (!checkReturn(ptrValue))
+				return false;
+			Ptr<UserParameter> ptrParameter = ptrParameters->itemByName(parameter.strName);
+			if (ptrParameter) {
+				changed.push_back(ptrParameter);
+				values.push_back(ptrValue);
+			}
+			else if (!checkReturn(ptrParameters->add(parameter.strName, ptrValue, parameter.strUnits, parameter.strComment)))
+				return false;
+		}
+		return changed.empty() || mptrDesign->modifyParameters(changed, values);
+	}
+
+	bool getUserParameter(const std::string &name, std::string *expression) override
+	{
+		Ptr<UserParameter> ptrParameter = mptrDesign->userParameters()->itemByName(name);
+		if (!ptrParameter)
+			return false;
+		*expression = ptrParameter->expression();
+		return true;
+	}
+
+	BackendHandle findObject(BackendHandle component, const std::string &name) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		if (!ptrComp)
+			return 0;
+		// The ring revolves create their own components, so their features are looked for there as well.
+		std::vector<Ptr<Component>> components(1, ptrComp);
+		for (Ptr<Occurrence> ptrOcc : ptrComp->occurrences())
+			components.push_back(ptrOcc->component());
+		for (Ptr<Component> ptrSearched : components) {
+			Ptr<Base> ptrFound = ptrSearched->sketches()->itemByName(name);
+			if (!ptrFound)
+				ptrFound = ptrSearched->features()->revolveFeatures()->itemByName(name);
+			if (!ptrFound)
+				ptrFound = ptrSearched->features()->filletFeatures()->itemByName(name);
+			if (ptrFound)
+				return add(ptrFound);
+		}
+		return 0;
+	}
+
+	bool updateSketchCircle(BackendHandle sketch, const RacewayCircle &circle) override
+	{
+		Ptr<Sketch> ptrSketch = object<Sketch>(sketch);
+		if (!ptrSketch)
+			return false;
+		Ptr<SketchCircle> ptrCircle = ptrSketch->sketchCurves()->sketchCircles()->item(0);
+		if (!checkReturn(ptrCircle))
+			return false;
+		ptrSketch->isComputeDeferred(gxDeferCompute);
+		bool xResult = moveSketchPoint(ptrCircle->centerSketchPoint(), circle.dCenterRadius, circle.dCenterHeight) && ptrCircle->radius(circle.dRadius);
+		ptrSketch->isComputeDeferred(false);
+		return xResult;
+	}
+
+	bool updateSketchRing(BackendHandle sketch, const RingProfile &ring, bool outer) override
+	{
+		Ptr<Sketch> ptrSketch = object<Sketch>(sketch);
+		return ptrSketch && updateRingSketch(ptrSketch, ring, outer);
+	}
+
+	bool updateFillet(BackendHandle fillet, double radius) override
+	{
+		Ptr<FilletFeature> ptrFillet = object<FilletFeature>(fillet);
+		if (!ptrFillet)
+			return false;
+		Ptr<ConstantRadiusFilletEdgeSet> ptrEdgeSet = ptrFillet->edgeSets()->item(0);
+		if (!checkReturn(ptrEdgeSet))
+			return false;
+		Ptr<ModelParameter> ptrRadius = ptrEdgeSet->radius();
+		return checkReturn(ptrRadius) && ptrRadius->value(radius);
+	}
+
+	bool updatePatternBalls(BackendHandle component, const std::string &name, double ballRadius, double pitchRadius, int count) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		return ptrComp && updateBalls(ptrComp, name, ballRadius, pitchRadius, count);
+	}
+
+	bool updateBallBody(BackendHandle component, const std::string &name, const BallPlacement &placement) override
+	{
+		Ptr<Component> ptrComp = object<Component>(component);
+		return ptrComp && replaceBallBody(ptrComp, name, placement);
+	}
+
+private:
+	// Prefix of the user parameters that drive the component, empty if there are none.
+	std::string prefix(BackendHandle component) const
+	{
+		std::map<BackendHandle, std::string>::const_iterator it = mPrefixes.find(component);
+		return it != mPrefixes.end() ? it->second : std::string();
+	}
+
+	Ptr<Design> mptrDesign;
+	// Next number to try for the user parameters of a bearing in this design.
+	int miNextParameter;
+	std::vector<Ptr<Base>> mObjects;
+	std::map<BackendHandle, std::string> mPrefixes;
+};
+
+// Sizes the bearing of the current type with the current ball options and checks
+// that it can be built. Small problems like a too large fillet are corrected on the way.
+bool prepareBearingGeometry(double innerDiameter, double outerDiameter, double thickness, BearingGeometry *geometry, BearingValidation *validation)
+{
+	return sizeBearing(geFamily, innerDiameter, outerDiameter, thickness, gdBallClearance, geometry, validation);
+}
+
+// Build options from the command inputs. Sizes are in the internal units,
+// user parameters are shown in the units of the command.
+BearingBuildOptions bearingBuildOptions(Ptr<Design> design)
+{
+	Ptr<UnitsManager> ptrUnits = design->unitsManager();
+	BearingBuildOptions options;
+	options.eBallCreation = geBallCreation;
+	options.xReuseBearings = gxReuseBearings;
+	options.xCage = gxCage;
+	options.strUnits = ptrUnits->internalUnits();
+	options.strDisplayUnits = gstrUnits;
+	options.dDisplayScale = ptrUnits->convert(1.0, options.strUnits, gstrUnits);
+	return options;
+}
+
+// Builds a ball bearing.
+Ptr<Component> drawBallBearing(Ptr<Design> design, double innerDiameter, double outerDiameter, double thickness)
+{
+	BearingGeometry geometry;
+	BearingValidation validation;
+	if (!prepareBearingGeometry(innerDiameter, outerDiameter, thickness, &geometry, &validation))
 		return nullptr;
 
+	return drawBallBearing(design, geometry, bearingBuildOptions(design));
+}
 
-	// Set name
-	ptrNewComp->name("Ball Bearing (" + std::to_string(innerDiameter) + " : " + std::to_string(outerDiameter) + ")");
+// Builds a bearing that is already sized and validated.
+Ptr<Component> drawBallBearing(Ptr<Design> design, const BearingGeometry &geometry, const BearingBuildOptions &options)
+{
+	ScopedStage stage(gpBuildTrace, "drawBallBearing");
+
+	// While a trace is recorded every Fusion call is logged as well.
+	FusionBackend fusion(design);
+	BearingBackend *pBackend = &fusion;
+	if (gpBuildTrace) {
+		gBuildCalls.setInner(&fusion);
+		pBackend = &gBuildCalls;
+	}
+	BackendHandle component = buildBallBearing(pBackend, geometry, options, gpBuildTrace);
+	gBuildCalls.setInner(nullptr);
 
-	return ptrNewComp;
+	return fusion.object<Component>(component);
+}
+
+// Returns the bearing occurrence of a selected occurrence, which can also be one of its rings.
+Ptr<Occurrence> findBearingOccurrence(Ptr<Occurrence> occurrence)
+{
+	for (Ptr<Occurrence> ptrOcc = occurrence; ptrOcc; ptrOcc = ptrOcc->assemblyContext()) {
+		Ptr<Component> ptrComp = ptrOcc->component();
+		if (ptrComp && ptrComp->attributes()->itemByName("BallBearing", "innerDiameter"))
+			return ptrOcc;
+	}
+	return nullptr;
+}
+
+Ptr<Component> findBearingComponent(Ptr<Occurrence> occurrence)
+{
+	Ptr<Occurrence> ptrOcc = findBearingOccurrence(occurrence);
+	return ptrOcc ? ptrOcc->component() : nullptr;
+}
+
+// Draws a preview mesh as custom graphics in the root component, replacing the previous one.
+bool drawBearingPreview(Ptr<Design> design, const TriangleMesh &mesh, Ptr<Matrix3D> transform)
+{
+	clearBearingPreview();
+	if (!design || mesh.triangleCount() == 0)
+		return false;
+
+	std::vector<double> coordinates(mesh.vertexCount() * 3);
+	std::vector<double> normals(mesh.vertexCount() * 3);
+	for (size_t i = 0; i < mesh.vertexCount(); ++i) {
+		coordinates[i * 3] = mesh.x[i];
+		coordinates[i * 3 + 1] = mesh.y[i];
+		coordinates[i * 3 + 2] = mesh.z[i];
+		normals[i * 3] = mesh.normalX[i];
+		normals[i * 3 + 1] = mesh.normalY[i];
+		normals[i * 3 + 2] = mesh.normalZ[i];
+	}
+	std::vector<int> indices(mesh.indices.begin(), mesh.indices.end());
+
+	gptrPreviewGraphics = design->rootComponent()->customGraphicsGroups()->add();
+	if (!checkReturn(gptrPreviewGraphics))
+		return false;
+	Ptr<CustomGraphicsCoordinates> ptrCoordinates = CustomGraphicsCoordinates::create(coordinates);
+	if (!checkReturn(ptrCoordinates))
+		return false;
+	// The normals are stored per vertex, so they share the triangle indices.
+	Ptr<CustomGraphicsMesh> ptrMesh = gptrPreviewGraphics->addMesh(ptrCoordinates, indices, normals, indices);
+	if (!checkReturn(ptrMesh))
+		return false;
+	if (transform)
+		ptrMesh->transform(transform);
+	return true;
+}
+
+void clearBearingPreview()
+{
+	if (gptrPreviewGraphics && gptrPreviewGraphics->isValid())
+		gptrPreviewGraphics->deleteMe();
+	gptrPreviewGraphics = nullptr;
 }
 
+bool readBallBearingParameters(Ptr<Design> design, Ptr<Component> component, BearingParameters *parameters)
+{
+	FusionBackend fusion(design);
+	return loadBearingParameters(&fusion, fusion.add(component), parameters);
+}
+
+// Changes a bearing built earlier to new sizes. Bearings driven by user parameters
+// get the changed parameters, older ones the sketches and features that differ.
+// Fusion recomputes what depends on them.
+Ptr<Component> editBallBearing(Ptr<Design> design, Ptr<Component> component, double innerDiameter, double outerDiameter, double thickness, std::string *error)
+{
+	ScopedStage stage(gpBuildTrace, "editBallBearing");
+
+	BearingGeometry geometry;
+	BearingValidation validation;
+	if (!prepareBearingGeometry(innerDiameter, outerDiameter, thickness, &geometry, &validation)) {
+		*error = validation.message();
+		return nullptr;
+	}
+
+	FusionBackend fusion(design);
+	BearingBackend *pBackend = &fusion;
+	if (gpBuildTrace) {
+		gBuildCalls.setInner(&fusion);
+		pBackend = &gBuildCalls;
+	}
+	bool xUpdated = updateBallBearing(pBackend, fusion.add(component), geometry, bearingBuildOptions(design), gpBuildTrace, nullptr);
+	gBuildCalls.setInner(nullptr);
+
+	if (!xUpdated) {
+		*error = "The bearing cannot be changed in place, or other bearings share its component, build a new one instead.";
+		return nullptr;
+	}
+	return component;
+}
+
+void describeBallBearing(Ptr<Component> component, double innerDiameter, double outerDiameter, double thickness)
+{
+	std::string desc = "";
+	desc += "Inner Diameter: " + std::to_string(innerDiameter) + "; ";
+	desc += "Outer Diameter: " + std::to_string(outerDiameter) + "; ";
+	desc += "Thickness: " + std::to_string(thickness) + "; ";
+
+	component->description(desc);
+}
+
+// Asks for a bearing list, or a layout, and starts a job that builds every
+// bearing in it. Sizes and positions in the file are in the units of the dialog.
+// The bearings are sized, validated and placed on a worker thread and built by
+// runBuildSlice. Returns false with the error in the report if the job cannot
+// start, true without a job if the file dialog is cancelled.
+bool startBearingJob(Ptr<Design> design, bool layout, std::string *report)
+{
+	Ptr<FileDialog> ptrFileDialog = gptrUi->createFileDialog();
+	if (!checkReturn(ptrFileDialog))
+		return false;
+	ptrFileDialog->isMultiSelectEnabled(false);
+	ptrFileDialog->title(layout ? "Select a bearing layout" : "Select a bearing list");
+	ptrFileDialog->filter(layout ? "Bearing layouts (*.csv);;All files (*.*)" : "Bearing lists (*.csv;*.json;*.bbcat);;All files (*.*)");
+	if (ptrFileDialog->showOpen() != DialogOK)
+		return true;
+	std::string strPath = ptrFileDialog->filename();
+
+	std::vector<BearingSpec> specs;
+	std::vector<LayoutEntry> entries;
+	if (layout ? !readBearingLayout(strPath, &entries, report) : !readBearingSpecs(strPath, gstrUnits, &specs, report))
+		return false;
+	size_t iRows = layout ? entries.size() : specs.size();
+	if (iRows == 0) {
+		*report = "No bearings found in " + strPath;
+		return false;
+	}
+
+	Ptr<UnitsManager> ptrUnitsMgr = design->unitsManager();
+	if (!checkReturn(ptrUnitsMgr))
+		return false;
+	BearingJobSettings settings;
+	settings.eFamily = geFamily;
+	settings.dBallClearance = gdBallClearance;
+	settings.dScale = ptrUnitsMgr->convert(1.0, gstrUnits, ptrUnitsMgr->internalUnits());
+	settings.dMillimetres = unitsToMillimetres(ptrUnitsMgr->internalUnits());
+
+	// The event is only registered once the first job needs it.
+	if (!gptrBuildStepEvent) {
+		gptrBuildStepEvent = gptrApp->registerCustomEvent(kBuildStepEventId);
+		if (!checkReturn(gptrBuildStepEvent))
+			return false;
+		if (!gptrBuildStepEvent->add(&gBuildStep)) {
+			gptrApp->unregisterCustomEvent(kBuildStepEventId);
+			gptrBuildStepEvent = nullptr;
+			return false;
+		}
+	}
+
+	gJob.xLayout = layout;
+	gJob.strPath = strPath;
+	gJob.ptrDesign = design;
+	gJob.options = bearingBuildOptions(design);
+	// The timeline only exists in parametric designs.
+	Ptr<Timeline> ptrTimeline = design->timeline();
+	gJob.iTimelineStart = ptrTimeline ? (int)ptrTimeline->count() : 0;
+	gJob.tStart = std::chrono::steady_clock::now();
+	gJob.iRows = iRows;
+	gJob.iBuilt = 0;
+	gJob.iInvalid = 0;
+	gJob.iPlaced = 0;
+	gJob.iSkipped = 0;
+	if (!layout) {
+		gJob.timings.open(strPath + ".timing.csv");
+		gJob.timings << "index,innerDiameter,outerDiameter,thickness,seconds,status,mass,inertia,pitchDiameter,ballCount,dynamicLoadRating,staticLoadRating\n";
+	}
+
+	// Layouts only know their number of sizes once they are grouped, until then it is the number of rows.
+	gJob.ptrProgress = gptrUi->createProgressDialog();
+	if (gJob.ptrProgress) {
+		gJob.ptrProgress->isCancelButtonShown(true);
+		gJob.ptrProgress->show("Ball Bearing", layout ? "Placed %v of %m bearing sizes" : "Built %v of %m bearings", 0, (int)iRows, 1);
+	}
+
+	// Called on the worker thread, Fusion queues the event for the main thread.
+	std::function<void()> ready = []() { gptrApp->fireCustomEvent(kBuildStepEventId, ""); };
+	if (!(layout ? gJobQueue.startLayout(entries, settings, ready) : gJobQueue.startBatch(specs, settings, ready))) {
+		if (gJob.ptrProgress)
+			gJob.ptrProgress->hide();
+		gJob.ptrProgress = nullptr;
+		gJob.timings.close();
+		*report = "A bearing job is still running.";
+		return false;
+	}
+	return true;
+}
+
+// Builds one bearing of a batch job and writes its row of the timings.
+void buildBatchBearing(const PlannedBearing &bearing)
+{
+	const BearingSpec &spec = bearing.spec;
+	gJob.timings << bearing.iIndex + 1 << "," << spec.dInnerDiameter << "," << spec.dOuterDiameter << "," << spec.dThickness << ",";
+
+	// Rows that cannot be built were found by the planning, Fusion is not involved.
+	if (!bearing.xValid) {
+		std::string strReason = bearing.validation.message();
+		for (char &c : strReason) {
+			if (c == '\n' || c == ',')
+				c = ' ';
+		}
+		gJob.timings << "0,invalid: " << strReason << ",,,,,,\n";
+		++gJob.iInvalid;
+		return;
+	}
+
+	if (gpBuildTrace)
+		gpBuildTrace->setThread((int)bearing.iIndex + 1);
+
+	const BearingGeometry &geometry = bearing.geometry;
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point tStart = Clock::now();
+	Ptr<Component> ptrCmpBearing = drawBallBearing(gJob.ptrDesign, geometry, gJob.options);
+	double dSeconds = std::chrono::duration<double>(Clock::now() - tStart).count();
+
+	if (ptrCmpBearing) {
+		describeBallBearing(ptrCmpBearing, geometry.dInnerDiameter, geometry.dOuterDiameter, geometry.dThickness);
+		++gJob.iBuilt;
+	}
+	gJob.timings << dSeconds << "," << (ptrCmpBearing ? "ok" : "failed");
+	// The same values as the attributes of the bearing, in kg, kg mm^2, mm and N.
+	const BearingProperties &properties = bearing.properties;
+	if (bearing.xHasProperties)
+		gJob.timings << "," << properties.dMass << "," << properties.dInertia << "," << properties.dPitchDiameter << "," << properties.iElementCount
+			<< "," << properties.dDynamicLoadRating << "," << properties.dStaticLoadRating << "\n";
+	else
+		gJob.timings << ",,,,,,\n";
+}
+
+// Builds one size of a layout job once and places it at all of its entries.
+// The new occurrence of the build is moved to the first entry, the others
+// are occurrences of the same component.
+void placeLayoutBearing(const PlannedBearing &bearing)
+{
+	gJob.iSkipped += (int)bearing.iUnplaced;
+	if (!bearing.xValid || bearing.entries.empty()) {
+		gJob.iSkipped += (int)bearing.entries.size();
+		return;
+	}
+
+	if (gpBuildTrace)
+		gpBuildTrace->setThread((int)bearing.iIndex + 1);
+
+	const BearingGeometry &geometry = bearing.geometry;
+	Ptr<Component> ptrCmpBearing = drawBallBearing(gJob.ptrDesign, geometry, gJob.options);
+	if (!ptrCmpBearing) {
+		gJob.iSkipped += (int)bearing.entries.size();
+		return;
+	}
+	describeBallBearing(ptrCmpBearing, geometry.dInnerDiameter, geometry.dOuterDiameter, geometry.dThickness);
+
+	Ptr<Component> ptrRoot = gJob.ptrDesign->rootComponent();
+	Ptr<Occurrences> ptrOccs = ptrRoot ? ptrRoot->occurrences() : nullptr;
+	if (!checkReturn(ptrOccs)) {
+		gJob.iSkipped += (int)bearing.entries.size();
+		return;
+	}
+	Ptr<OccurrenceList> ptrBuilt = ptrRoot->occurrencesByComponent(ptrCmpBearing);
+	Ptr<Occurrence> ptrFirst = ptrBuilt && ptrBuilt->count() > 0 ? ptrBuilt->item(ptrBuilt->count() - 1) : nullptr;
+
+	for (size_t i = 0; i < bearing.entries.size(); ++i) {
+		std::vector<double> cells(bearing.transforms.begin() + i * 16, bearing.transforms.begin() + (i + 1) * 16);
+		Ptr<Matrix3D> ptrTransform = adsk::core::Matrix3D::create();
+		if (!checkReturn(ptrTransform) || !ptrTransform->setWithArray(cells)) {
+			++gJob.iSkipped;
+			continue;
+		}
+		bool xPlaced = (i == 0 && ptrFirst) ? ptrFirst->transform2(ptrTransform) :
+			checkReturn(ptrOccs->addExistingComponent(ptrCmpBearing, ptrTransform));
+		if (xPlaced)
+			++gJob.iPlaced;
+		else
+			++gJob.iSkipped;
+	}
+}
+
+// Ends the running job: groups everything it built in the timeline and reports it.
+void finishBearingJob()
+{
+	bool xCancelled = gJobQueue.cancelled();
+	size_t iTotal = gJobQueue.total();
+	size_t iTaken = gJobQueue.taken();
+	gJobQueue.reset();
+	if (gJob.ptrProgress) {
+		gJob.ptrProgress->hide();
+		gJob.ptrProgress = nullptr;
+	}
+	gJob.timings.close();
+	double dTotalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - gJob.tStart).count();
+
+	Ptr<Design> design = gJob.ptrDesign;
+	gJob.ptrDesign = nullptr;
+	if (design && design->isValid()) {
+		Ptr<Timeline> ptrTimeline = design->timeline();
+		// Moved occurrences are captured in one position snapshot instead of one per bearing.
+		Ptr<Snapshots> ptrSnapshots = ptrTimeline && gJob.xLayout ? design->snapshots() : nullptr;
+		if (ptrSnapshots && ptrSnapshots->hasPendingSnapshot())
+			ptrSnapshots->add();
+		if (ptrTimeline && (int)ptrTimeline->count() > gJob.iTimelineStart + 1) {
+			Ptr<TimelineGroup> ptrGroup = ptrTimeline->timelineGroups()->add(gJob.iTimelineStart, (int)ptrTimeline->count() - 1);
+			if (ptrGroup)
+				ptrGroup->name(gJob.xLayout ? "Ball Bearing Layout" : "Ball Bearing Batch");
+		}
+	}
+
+	std::string strReport;
+	if (xCancelled)
+		strReport = "Cancelled after " + std::to_string(iTaken) + " of " + std::to_string(iTotal) + (gJob.xLayout ? " bearing sizes.\n" : " bearings.\n");
+	if (gJob.xLayout) {
+		strReport += "Placed " + std::to_string(gJob.iPlaced) + " of " + std::to_string(gJob.iRows) + " bearings of "
+			+ std::to_string(iTotal) + " sizes in " + std::to_string(dTotalSeconds) + " s.";
+		if (gJob.iSkipped > 0)
+			strReport += "\n" + std::to_string(gJob.iSkipped) + " rows were skipped because they cannot be built or have no shaft axis.";
+	}
+	else {
+		strReport += "Built " + std::to_string(gJob.iBuilt) + " of " + std::to_string(gJob.iRows) + " bearings in "
+			+ std::to_string(dTotalSeconds) + " s";
+		// Skipped and cancelled rows cost next to nothing, they would hide the cost of a bearing.
+		if (gJob.iBuilt > 0)
+			strReport += " (" + std::to_string(dTotalSeconds * 1000.0 / gJob.iBuilt) + " ms per bearing)";
+		strReport += ".\n";
+		if (gJob.iInvalid > 0)
+			strReport += std::to_string(gJob.iInvalid) + " rows were skipped because they cannot be built.\n";
+		strReport += "Timings, masses and load ratings were written to " + gJob.strPath + ".timing.csv";
+	}
+	if (gpBuildTrace) {
+		strReport += "\n" + writeBuildTrace(getTempFilePath("BallBearingBatchTrace.json"));
+		gpBuildTrace = nullptr;
+	}
+	gptrUi->messageBox(strReport);
+}
+
+// Builds planned bearings of the running job for about kBuildSliceSeconds, at
+// least one, and hands the main thread back to Fusion. The next slice is
+// started by the same event, fired here while planned bearings are left or by
+// the planning thread when new ones arrive.
+void runBuildSlice()
+{
+	if (!gJobQueue.active())
+		return;
+	// Closing the design ends the job like the cancel button.
+	if (!gJob.ptrDesign || !gJob.ptrDesign->isValid() || (gJob.ptrProgress && gJob.ptrProgress->wasCancelled()))
+		gJobQueue.cancel();
+
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point tEnd = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(kBuildSliceSeconds));
+	PlannedBearing bearing;
+	while (Clock::now() < tEnd && gJobQueue.take(&bearing)) {
+		if (gJob.xLayout)
+			placeLayoutBearing(bearing);
+		else
+			buildBatchBearing(bearing);
+	}
+
+	if (gJob.ptrProgress) {
+		if (gJobQueue.total() > 0)
+			gJob.ptrProgress->maximumValue((int)gJobQueue.total());
+		gJob.ptrProgress->progressValue((int)gJobQueue.taken());
+	}
+
+	if (gJobQueue.finished())
+		finishBearingJob();
+	else if (gJobQueue.hasReady())
+		gptrApp->fireCustomEvent(kBuildStepEventId, "");
+}
+
+std::string getTempFilePath(const std::string &name)
+{
+	const char *pDir = std::getenv("TEMP");
+	if (!pDir)
+		pDir = std::getenv("TMPDIR");
+	std::string strDir = pDir ? pDir : "/tmp";
+	if (!strDir.empty() && strDir.back() != '/' && strDir.back() != '\\')
+		strDir += "/";
+	return strDir + name;
+}
+
+// Writes the recorded build trace and calls and returns a summary of the slowest stages.
+std::string writeBuildTrace(const std::string &path)
+{
+	static const char *stages[] = { "component", "cache lookup", "sketch ball cutout", "sketch inner ring", "sketch outer ring",
+		"revolve ring", "raceway cut", "counterbore", "fillet", "balls", "joint", "drawBallBearing", "editBallBearing" };
+
+	std::string strSummary = "Stage times (s):\n";
+	for (const char *pStage : stages)
+		strSummary += std::string(pStage) + ": " + std::to_string(gBuildTrace.totalSeconds(pStage)) + "\n";
+
+	strSummary += "\nFusion calls: " + gBuildCalls.summary() + "\n";
+
+	if (gBuildTrace.writeChromeTrace(path))
+		strSummary += "Trace written to " + path;
+	else
+		strSummary += "Could not write " + path;
+	if (gBuildCalls.writeCsv(path + ".calls.csv"))
+		strSummary += "\nCalls written to " + path + ".calls.csv";
+	return strSummary;
+}
 
 extern "C" XI_EXPORT bool run(const char* context)
 {
@@ -634,30 +2167,32 @@ extern "C" XI_EXPORT bool run(const char* context)
 	if (!isOk)
 		return false;
 
-	isOk = cmdDef->execute();
-	if (!isOk)
-		return false;
-
-	std::string strContext = context;
-	if (strContext.find("IsApplicationStartup", 0) != std::string::npos)
-	{
-		if (strContext.find("false", 0) != std::string::npos)
-		{
-			gptrUi->messageBox("The \"Ball Bearing\" command has been added\nto the CREATE panel of the MODEL workspace.");
-		}
-	}
+	// Nothing else happens until the command is invoked: no dialog, no message
+	// and no design access, the job event is registered by the first job.
 
 	// Prevent this module from terminating so that the command can continue to run until
 	// the user completes the command.
 	adsk::autoTerminate(false);
 
-	//ui->messageBox("Hello addin");
-
 	return true;
 }
 
 extern "C" XI_EXPORT bool stop(const char* context)
 {
+	// A running job is dropped, its planning thread has to end before the module is unloaded.
+	gJobQueue.reset();
+	if (gJob.ptrProgress) {
+		gJob.ptrProgress->hide();
+		gJob.ptrProgress = nullptr;
+	}
+	gJob.timings.close();
+	gJob.ptrDesign = nullptr;
+	if (gptrBuildStepEvent) {
+		gptrBuildStepEvent->remove(&gBuildStep);
+		gptrApp->unregisterCustomEvent(kBuildStepEventId);
+		gptrBuildStepEvent = nullptr;
+	}
+
 	if (gptrUi) 
 	{
 		Ptr<ToolbarPanel> createPanel = gptrUi->allToolbarPanels()->itemById("SolidCreatePanel");
@@ -0,0 +1,434 @@
+#include "BearingBackend.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <set>
+
+static std::string formatArguments(const char *format, ...)
+{
+	char buffer[256];
+	va_list args;
+	va_start(args, format);
+	std::vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+	return buffer;
+}
+
+RecordingBackend::RecordingBackend(BearingBackend *inner)
+	: mpInner(inner), mtOrigin(Clock::now()), miAllocations(0), miCheckReturns(0), miLastHandle(0), miLastPrefix(0)
+{
+}
+
+void RecordingBackend::clear()
+{
+	mtOrigin = Clock::now();
+	mCalls.clear();
+	miAllocations = 0;
+	miCheckReturns = 0;
+	miLastHandle = 0;
+	mAttributes.clear();
+	mNames.clear();
+	mOccurrences.clear();
+	mParameters.clear();
+	miLastPrefix = 0;
+}
+
+long long RecordingBackend::redundantCallCount() const
+{
+	// Calls that do not refer to an existing object add something new every time.
+	std::set<std::pair<std::string, std::string>> seen;
+	long long iRedundant = 0;
+	for (const Call &call : mCalls) {
+		if (call.strName == "createComponent" || call.strName == "insertCachedBearing")
+			continue;
+		if (!seen.insert(std::make_pair(call.strName, call.strArguments)).second)
+			++iRedundant;
+	}
+	return iRedundant;
+}
+
+std::string RecordingBackend::summary() const
+{
+	struct Totals
+	{
+		int iCalls;
+		double dSeconds;
+	};
+	std::map<std::string, Totals> totals;
+	double dSeconds = 0.0;
+	for (const Call &call : mCalls) {
+		Totals &entry = totals[call.strName];
+		entry.iCalls += 1;
+		entry.dSeconds += call.dSeconds;
+		dSeconds += call.dSeconds;
+	}
+
+	std::string strSummary = formatArguments("%zu calls in %.3f ms, %lld objects created, %lld checkReturn calls, %lld redundant calls\n",
+		mCalls.size(), dSeconds * 1.0e3, miAllocations, miCheckReturns, redundantCallCount());
+	for (const auto &entry : totals)
+		strSummary += formatArguments("%-20s %6d calls %10.3f ms\n", entry.first.c_str(), entry.second.iCalls, entry.second.dSeconds * 1.0e3);
+	return strSummary;
+}
+
+bool RecordingBackend::writeCsv(const std::string &path) const
+{
+	FILE *pFile = std::fopen(path.c_str(), "wb");
+	if (!pFile)
+		return false;
+
+	std::fprintf(pFile, "call,arguments,startMs,durationMs,result\n");
+	for (const Call &call : mCalls) {
+		std::string strArguments;
+		for (char c : call.strArguments) {
+			if (c == '"')
+				strArguments += '"';
+			strArguments += c;
+		}
+		std::fprintf(pFile, "%s,\"%s\",%.3f,%.3f,%d\n", call.strName.c_str(), strArguments.c_str(),
+			call.dStart * 1.0e3, call.dSeconds * 1.0e3, call.result);
+	}
+	return std::fclose(pFile) == 0;
+}
+
+BackendHandle RecordingBackend::record(const char *name, const std::string &arguments, Clock::time_point start, BackendHandle result, bool allocates)
+{
+	Clock::time_point tEnd = Clock::now();
+	Call call;
+	call.strName = name;
+	call.strArguments = arguments;
+	call.dStart = std::chrono::duration<double>(start - mtOrigin).count();
+	call.dSeconds = std::chrono::duration<double>(tEnd - start).count();
+	call.result = result;
+	mCalls.push_back(call);
+	if (allocates && result != 0)
+		++miAllocations;
+	return result;
+}
+
+BackendHandle RecordingBackend::remember(BackendHandle component, const std::string &name, BackendHandle object)
+{
+	if (object != 0)
+		mNames[std::make_pair(component, name)] = object;
+	return object;
+}
+
+BackendHandle RecordingBackend::insertCachedBearing(const std::string &key)
+{
+	Clock::time_point tStart = Clock::now();
+	BackendHandle result = 0;
+	if (mpInner) {
+		result = mpInner->insertCachedBearing(key);
+	}
+	else {
+		for (const auto &attribute : mAttributes) {
+			if (attribute.first.second == "cacheKey" && attribute.second == key) {
+				result = attribute.first.first;
+				++mOccurrences[result];
+				break;
+			}
+		}
+	}
+	// A hit adds an occurrence, the component itself already exists.
+	return record("insertCachedBearing", key, tStart, result, true);
+}
+
+BackendHandle RecordingBackend::createComponent()
+{
+	Clock::time_point tStart = Clock::now();
+	BackendHandle result = mpInner ? mpInner->createComponent() : allocate();
+	if (!mpInner)
+		mOccurrences[result] = 1;
+	return record("createComponent", "", tStart, result, true);
+}
+
+int RecordingBackend::occurrenceCount(BackendHandle component)
+{
+	Clock::time_point tStart = Clock::now();
+	int iCount = 0;
+	if (mpInner) {
+		iCount = mpInner->occurrenceCount(component);
+	}
+	else {
+		auto occurrences = mOccurrences.find(component);
+		if (occurrences != mOccurrences.end())
+			iCount = occurrences->second;
+	}
+	record("occurrenceCount", formatArguments("%d", component), tStart, iCount, false);
+	return iCount;
+}
+
+BackendHandle RecordingBackend::sketchCircle(BackendHandle component, const std::string &name, const RacewayCircle &circle)
+{
+	Clock::time_point tStart = Clock::now();
+	BackendHandle result = mpInner ? mpInner->sketchCircle(component, name, circle) : allocate();
+	remember(component, name, result);
+	return record("sketchCircle", formatArguments("%d,%.9g,%.9g,%.9g,", component, circle.dCenterRadius, circle.dCenterHeight, circle.dRadius) + name, tStart, result, true);
+}
+
+BackendHandle RecordingBackend::sketchRing(BackendHandle component, const std::string &name, const RingProfile &ring, bool outer)
+{
+	Clock::time_point tStart = Clock::now();
+	BackendHandle result = mpInner ? mpInner->sketchRing(component, name, ring, outer) : allocate();
+	remember(component, name, result);
+	return record("sketchRing", formatArguments("%d,%.9g,%.9g,%.9g,%.9g,%s,", component, ring.dRadiusMin, ring.dRadiusMax,
+		ring.dHalfThickness, ring.dCenterHeight, outer ? "outer" : "inner") + name, tStart, result, true);
+}
+
+static std::string formatRoller(const RollerProfile &roller)
+{
+	return formatArguments("%.9g,%.9g,%.9g,%.9g,%.9g,%.9g", roller.dCenterRadius, roller.dCenterHeight, roller.dLength, roller.dRadius,
+		roller.dAxisAngle, roller.dTaperAngle);
+}
+
+BackendHandle RecordingBackend::sketchRoller(BackendHandle component, const std::string &name, const RollerProfile &roller)
+{
+	Clock::time_point tStart = Clock::now();
+	BackendHandle result = mpInner ? mpInner->sketchRoller(component, name, roller) : allocate();
+	remember(component, name, result);
+	return record("sketchRoller", formatArguments("%d,", component) + formatRoller(roller) + "," + name, tStart, result, true);
+}
+
+BackendHandle RecordingBackend::sketchCage(BackendHandle component, const std::string &name, const CageProfile &cage)
+{
+	Clock::time_point tStart = Clock::now();
+	BackendHandle result = mpInner ? mpInner->sketchCage(component, name, cage) : allocate();
+	remember(component, name, result);
+	return record("sketchCage", formatArguments("%d,%.9g,%.9g,%.9g,%.9g,", component, cage.band.dRadiusMin, cage.band.dRadiusMax,
+		cage.band.dHalfThickness, cage.band.dCenterHeight) + name, tStart, result, true);
+}
+
+BackendHandle RecordingBackend::revolveRing(BackendHandle component, BackendHandle sketch, const std::string &name)
+{
+	Clock::time_point tStart = Clock::now();
+	BackendHandle result = mpInner ? mpInner->revolveRing(component, sketch, name) : allocate();
+	remember(component, name, result);
+	return record("revolveRing", formatArguments("%d,%d,", component, sketch) + name, tStart, result, true);
+}
+
+BackendHandle RecordingBackend::revolveCut(BackendHandle component, BackendHandle sketch, const std::string &name)
+{
+	Clock::time_point tStart = Clock::now();
+	BackendHandle result = mpInner ? mpInner->revolveCut(component, sketch, name) : allocate();
+	remember(component, name, result);
+	return record("revolveCut", formatArguments("%d,%d,", component, sketch) + name, tStart, result, true);
+}
+
+BackendHandle RecordingBackend::fillet(BackendHandle component, BackendHandle revolve, const RingProfile &ring, const std::string &name, double radius)
+{
+	Clock::time_point tStart = Clock::now();
+	BackendHandle result = mpInner ? mpInner->fillet(component, revolve, ring, name, radius) : allocate();
+	remember(component, name, result);
+	return record("fillet", formatArguments("%d,%d,%.9g,%.9g,%.9g,%.9g,%.9g,", component, revolve, ring.dRadiusMin, ring.dRadiusMax,
+		ring.dHalfThickness, ring.dCenterHeight, radius) + name, tStart, result, true);
+}
+
+bool RecordingBackend::patternBalls(BackendHandle component, BackendHandle innerRing, const std::string &name, double ballRadius, double pitchRadius, double height, int count)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->patternBalls(component, innerRing, name, ballRadius, pitchRadius, height, count) : true;
+	return record("patternBalls", formatArguments("%d,%d,%.9g,%.9g,%.9g,%d,", component, innerRing, ballRadius, pitchRadius, height, count) + name,
+		tStart, xResult ? 1 : 0, true) != 0;
+}
+
+bool RecordingBackend::ballBody(BackendHandle component, const std::string &name, const BallPlacement &placement)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->ballBody(component, name, placement) : true;
+	return record("ballBody", formatArguments("%d,%.9g,%.9g,%d,", component, placement.dBallRadius, placement.dPitchRadius, placement.iCount) + name,
+		tStart, xResult ? 1 : 0, true) != 0;
+}
+
+bool RecordingBackend::patternRollers(BackendHandle component, BackendHandle innerRing, const std::string &name, const RollerProfile &roller, int count)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->patternRollers(component, innerRing, name, roller, count) : true;
+	return record("patternRollers", formatArguments("%d,%d,", component, innerRing) + formatRoller(roller) + formatArguments(",%d,", count) + name,
+		tStart, xResult ? 1 : 0, true) != 0;
+}
+
+bool RecordingBackend::rollerBody(BackendHandle component, const std::string &name, const RollerProfile &roller, const BallPlacement &placement)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->rollerBody(component, name, roller, placement) : true;
+	return record("rollerBody", formatArguments("%d,", component) + formatRoller(roller) + formatArguments(",%d,", placement.iCount) + name,
+		tStart, xResult ? 1 : 0, true) != 0;
+}
+
+bool RecordingBackend::ballOccurrences(BackendHandle component, const std::string &name, const BallPlacement &placement)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->ballOccurrences(component, name, placement) : true;
+	return record("ballOccurrences", formatArguments("%d,%.9g,%.9g,%d,", component, placement.dBallRadius, placement.dPitchRadius, placement.iCount) + name,
+		tStart, xResult ? 1 : 0, true) != 0;
+}
+
+bool RecordingBackend::rollerOccurrences(BackendHandle component, const std::string &name, const RollerProfile &roller, const BallPlacement &placement)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->rollerOccurrences(component, name, roller, placement) : true;
+	return record("rollerOccurrences", formatArguments("%d,", component) + formatRoller(roller) + formatArguments(",%d,", placement.iCount) + name,
+		tStart, xResult ? 1 : 0, true) != 0;
+}
+
+bool RecordingBackend::ballPockets(BackendHandle component, BackendHandle cage, const std::string &name, const RacewayCircle &pocket, int count)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->ballPockets(component, cage, name, pocket, count) : true;
+	return record("ballPockets", formatArguments("%d,%d,%.9g,%.9g,%.9g,%d,", component, cage, pocket.dCenterRadius, pocket.dCenterHeight, pocket.dRadius, count) + name,
+		tStart, xResult ? 1 : 0, true) != 0;
+}
+
+bool RecordingBackend::rollerPockets(BackendHandle component, BackendHandle cage, const std::string &name, const RollerProfile &pocket, int count)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->rollerPockets(component, cage, name, pocket, count) : true;
+	return record("rollerPockets", formatArguments("%d,%d,", component, cage) + formatRoller(pocket) + formatArguments(",%d,", count) + name,
+		tStart, xResult ? 1 : 0, true) != 0;
+}
+
+bool RecordingBackend::joint(BackendHandle component, BackendHandle innerRing, BackendHandle outerRing)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->joint(component, innerRing, outerRing) : true;
+	return record("joint", formatArguments("%d,%d,%d", component, innerRing, outerRing), tStart, xResult ? 1 : 0, true) != 0;
+}
+
+bool RecordingBackend::cageJoint(BackendHandle component, BackendHandle innerRing, BackendHandle cage)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->cageJoint(component, innerRing, cage) : true;
+	return record("cageJoint", formatArguments("%d,%d,%d", component, innerRing, cage), tStart, xResult ? 1 : 0, true) != 0;
+}
+
+bool RecordingBackend::setName(BackendHandle component, const std::string &name)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->setName(component, name) : true;
+	return record("setName", formatArguments("%d,", component) + name, tStart, xResult ? 1 : 0, false) != 0;
+}
+
+bool RecordingBackend::setAttribute(BackendHandle component, const std::string &name, const std::string &value)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->setAttribute(component, name, value) : true;
+	if (xResult)
+		mAttributes[std::make_pair(component, name)] = value;
+	return record("setAttribute", formatArguments("%d,", component) + name + "," + value, tStart, xResult ? 1 : 0, true) != 0;
+}
+
+bool RecordingBackend::getAttribute(BackendHandle component, const std::string &name, std::string *value)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = false;
+	if (mpInner) {
+		xResult = mpInner->getAttribute(component, name, value);
+	}
+	else {
+		auto attribute = mAttributes.find(std::make_pair(component, name));
+		xResult = attribute != mAttributes.end();
+		if (xResult)
+			*value = attribute->second;
+	}
+	return record("getAttribute", formatArguments("%d,", component) + name, tStart, xResult ? 1 : 0, false) != 0;
+}
+
+std::string RecordingBackend::newParameterPrefix()
+{
+	Clock::time_point tStart = Clock::now();
+	std::string strPrefix = mpInner ? mpInner->newParameterPrefix() : "Bearing" + std::to_string(++miLastPrefix) + "_";
+	record("newParameterPrefix", strPrefix, tStart, strPrefix.empty() ? 0 : 1, false);
+	return strPrefix;
+}
+
+bool RecordingBackend::setUserParameters(const std::vector<BearingParameter> &parameters)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->setUserParameters(parameters) : true;
+	std::string strArguments;
+	long long iCreated = 0;
+	for (const BearingParameter &parameter : parameters) {
+		strArguments += (strArguments.empty() ? "" : ";") + parameter.strName + "=" + parameter.strExpression;
+		if (xResult && mParameters.find(parameter.strName) == mParameters.end())
+			++iCreated;
+		if (xResult)
+			mParameters[parameter.strName] = parameter.strExpression;
+	}
+	record("setUserParameters", strArguments, tStart, xResult ? 1 : 0, false);
+	miAllocations += iCreated;
+	return xResult;
+}
+
+bool RecordingBackend::getUserParameter(const std::string &name, std::string *expression)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = false;
+	if (mpInner) {
+		xResult = mpInner->getUserParameter(name, expression);
+	}
+	else {
+		auto parameter = mParameters.find(name);
+		xResult = parameter != mParameters.end();
+		if (xResult)
+			*expression = parameter->second;
+	}
+	return record("getUserParameter", name, tStart, xResult ? 1 : 0, false) != 0;
+}
+
+BackendHandle RecordingBackend::findObject(BackendHandle component, const std::string &name)
+{
+	Clock::time_point tStart = Clock::now();
+	BackendHandle result = 0;
+	if (mpInner) {
+		result = mpInner->findObject(component, name);
+	}
+	else {
+		auto named = mNames.find(std::make_pair(component, name));
+		if (named != mNames.end())
+			result = named->second;
+	}
+	return record("findObject", formatArguments("%d,", component) + name, tStart, result, false);
+}
+
+bool RecordingBackend::updateSketchCircle(BackendHandle sketch, const RacewayCircle &circle)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->updateSketchCircle(sketch, circle) : true;
+	return record("updateSketchCircle", formatArguments("%d,%.9g,%.9g,%.9g", sketch, circle.dCenterRadius, circle.dCenterHeight, circle.dRadius), tStart, xResult ? 1 : 0, false) != 0;
+}
+
+bool RecordingBackend::updateSketchRing(BackendHandle sketch, const RingProfile &ring, bool outer)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->updateSketchRing(sketch, ring, outer) : true;
+	return record("updateSketchRing", formatArguments("%d,%.9g,%.9g,%.9g,%.9g,%s", sketch, ring.dRadiusMin, ring.dRadiusMax,
+		ring.dHalfThickness, ring.dCenterHeight, outer ? "outer" : "inner"), tStart, xResult ? 1 : 0, false) != 0;
+}
+
+bool RecordingBackend::updateFillet(BackendHandle fillet, double radius)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->updateFillet(fillet, radius) : true;
+	return record("updateFillet", formatArguments("%d,%.9g", fillet, radius), tStart, xResult ? 1 : 0, false) != 0;
+}
+
+bool RecordingBackend::updatePatternBalls(BackendHandle component, const std::string &name, double ballRadius, double pitchRadius, int count)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->updatePatternBalls(component, name, ballRadius, pitchRadius, count) : true;
+	return record("updatePatternBalls", formatArguments("%d,%.9g,%.9g,%d,", component, ballRadius, pitchRadius, count) + name,
+		tStart, xResult ? 1 : 0, false) != 0;
+}
+
+bool RecordingBackend::updateBallBody(BackendHandle component, const std::string &name, const BallPlacement &placement)
+{
+	Clock::time_point tStart = Clock::now();
+	bool xResult = mpInner ? mpInner->updateBallBody(component, name, placement) : true;
+	return record("updateBallBody", formatArguments("%d,%.9g,%.9g,%d,", component, placement.dBallRadius, placement.dPitchRadius, placement.iCount) + name,
+		tStart, xResult ? 1 : 0, false) != 0;
+}
+
+bool RecordingBackend::checkReturn(BackendHandle handle)
+{
+	++miCheckReturns;
+	return mpInner ? mpInner->checkReturn(handle) : handle != 0;
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BearingGeometry.h"
+#include "BearingPlacement.h"
+
+// Object created by a backend, like a component, sketch or feature. The
+// backend decides what a handle stands for, 0 means the call failed.
+typedef int BackendHandle;
+
+// User parameter of a bearing. The expression refers to other parameters by their full name.
+struct BearingParameter
+{
+	std::string strName;
+	std::string strExpression;
+	// Empty for parameters without a unit, like the ball count.
+	std::string strUnits;
+	std::string strComment;
+};
+
+// Modelling calls the bearing is built from. The add-in implements them with
+// the Fusion API, the recording backend below runs without Fusion.
+// All sketches lie in the XZ plane of the component and are revolved around its Z axis.
+// Created objects get a name, so that an existing bearing can be edited later.
+// The sketches and features of a component with a "parameterPrefix" attribute are
+// dimensioned against the user parameters with that prefix instead of fixed values.
+class BearingBackend
+{
+public:
+	virtual ~BearingBackend() {}
+
+	// Adds an occurrence of a bearing that was built with the same cache key
+	// and returns its component, 0 if there is none.
+	virtual BackendHandle insertCachedBearing(const std::string &key) = 0;
+	virtual BackendHandle createComponent() = 0;
+	// Number of occurrences of the component anywhere in the design. Reused
+	// bearings share their component, an edit changes all of them.
+	virtual int occurrenceCount(BackendHandle component) = 0;
+
+	virtual BackendHandle sketchCircle(BackendHandle component, const std::string &name, const RacewayCircle &circle) = 0;
+	// The inner ring sketch starts at the bore, the outer one at the outer diameter.
+	virtual BackendHandle sketchRing(BackendHandle component, const std::string &name, const RingProfile &ring, bool outer) = 0;
+	// Full cross section of a roller, revolved around the bearing axis it cuts the roller groove.
+	virtual BackendHandle sketchRoller(BackendHandle component, const std::string &name, const RollerProfile &roller) = 0;
+	// Cross section of the cage band, never dimensioned against user parameters.
+	virtual BackendHandle sketchCage(BackendHandle component, const std::string &name, const CageProfile &cage) = 0;
+
+	// Revolves the sketch into a new component, the feature and the component get the name.
+	virtual BackendHandle revolveRing(BackendHandle component, BackendHandle sketch, const std::string &name) = 0;
+	virtual BackendHandle revolveCut(BackendHandle component, BackendHandle sketch, const std::string &name) = 0;
+	// Rounds the circular edges of the revolved ring body that lie on the corners
+	// of the ring profile, each edge once. Called after all cuts, so corners that
+	// a counterbore removed are left out.
+	virtual BackendHandle fillet(BackendHandle component, BackendHandle revolve, const RingProfile &ring, const std::string &name, double radius) = 0;
+
+	// One revolved ball at the height copied around the axis by a circular pattern.
+	virtual bool patternBalls(BackendHandle component, BackendHandle innerRing, const std::string &name, double ballRadius, double pitchRadius, double height, int count) = 0;
+	// All balls as one body.
+	virtual bool ballBody(BackendHandle component, const std::string &name, const BallPlacement &placement) = 0;
+	// The same for rollers: one roller revolved around its own axis and copied by
+	// a circular pattern, or all rollers of the placement as one body.
+	virtual bool patternRollers(BackendHandle component, BackendHandle innerRing, const std::string &name, const RollerProfile &roller, int count) = 0;
+	virtual bool rollerBody(BackendHandle component, const std::string &name, const RollerProfile &roller, const BallPlacement &placement) = 0;
+	// One ball or roller as a component of its own with an occurrence at every
+	// position of the placement, see rollingElementTransform. Bearings with
+	// elements of the same size may share the component.
+	virtual bool ballOccurrences(BackendHandle component, const std::string &name, const BallPlacement &placement) = 0;
+	virtual bool rollerOccurrences(BackendHandle component, const std::string &name, const RollerProfile &roller, const BallPlacement &placement) = 0;
+
+	// Pockets of the cage around one row of balls or around the rollers: a single
+	// pocket is cut from the cage and copied by a circular pattern, so the number
+	// of features does not grow with the number of balls.
+	virtual bool ballPockets(BackendHandle component, BackendHandle cage, const std::string &name, const RacewayCircle &pocket, int count) = 0;
+	virtual bool rollerPockets(BackendHandle component, BackendHandle cage, const std::string &name, const RollerProfile &pocket, int count) = 0;
+
+	// Revolute joint between the two rings.
+	virtual bool joint(BackendHandle component, BackendHandle innerRing, BackendHandle outerRing) = 0;
+	// Revolute joint between the inner ring and the cage.
+	virtual bool cageJoint(BackendHandle component, BackendHandle innerRing, BackendHandle cage) = 0;
+
+	virtual bool setName(BackendHandle component, const std::string &name) = 0;
+	virtual bool setAttribute(BackendHandle component, const std::string &name, const std::string &value) = 0;
+	virtual bool getAttribute(BackendHandle component, const std::string &name, std::string *value) = 0;
+
+	// Prefix for the user parameters of a new bearing that no other bearing uses yet,
+	// empty if the design cannot hold user parameters.
+	virtual std::string newParameterPrefix() = 0;
+	// Creates the parameters that do not exist yet and changes the expressions of the others with a single recompute.
+	virtual bool setUserParameters(const std::vector<BearingParameter> &parameters) = 0;
+	virtual bool getUserParameter(const std::string &name, std::string *expression) = 0;
+
+	// Finds a sketch or feature of a bearing by the name it was created with, 0 if there is none.
+	virtual BackendHandle findObject(BackendHandle component, const std::string &name) = 0;
+
+	// Changes existing objects in place, everything that depends on them is recomputed.
+	virtual bool updateSketchCircle(BackendHandle sketch, const RacewayCircle &circle) = 0;
+	virtual bool updateSketchRing(BackendHandle sketch, const RingProfile &ring, bool outer) = 0;
+	virtual bool updateFillet(BackendHandle fillet, double radius) = 0;
+	virtual bool updatePatternBalls(BackendHandle component, const std::string &name, double ballRadius, double pitchRadius, int count) = 0;
+	virtual bool updateBallBody(BackendHandle component, const std::string &name, const BallPlacement &placement) = 0;
+
+	// Checks the result of a call and reports the error if it failed.
+	virtual bool checkReturn(BackendHandle handle) { return handle != 0; }
+};
+
+// Backend that logs every call with its arguments and timing. On its own it
+// hands out new handles and does nothing else, so the build sequence can be
+// profiled and checked without Fusion. Given another backend it forwards all
+// calls to it and records what they cost.
+class RecordingBackend : public BearingBackend
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Call
+	{
+		std::string strName;
+		std::string strArguments;
+		// Seconds since the recording was cleared.
+		double dStart;
+		double dSeconds;
+		BackendHandle result;
+	};
+
+	explicit RecordingBackend(BearingBackend *inner = nullptr);
+
+	void setInner(BearingBackend *inner) { mpInner = inner; }
+	void clear();
+
+	const std::vector<Call> &calls() const { return mCalls; }
+	// Objects the calls created, like components, sketches and features.
+	long long allocationCount() const { return miAllocations; }
+	long long checkReturnCount() const { return miCheckReturns; }
+	// Calls that repeat an earlier call with the same arguments.
+	long long redundantCallCount() const;
+
+	// Calls, time and allocations per call name.
+	std::string summary() const;
+	// One CSV row per call.
+	bool writeCsv(const std::string &path) const;
+
+	BackendHandle insertCachedBearing(const std::string &key) override;
+	BackendHandle createComponent() override;
+	int occurrenceCount(BackendHandle component) override;
+	BackendHandle sketchCircle(BackendHandle component, const std::string &name, const RacewayCircle &circle) override;
+	BackendHandle sketchRing(BackendHandle component, const std::string &name, const RingProfile &ring, bool outer) override;
+	BackendHandle sketchRoller(BackendHandle component, const std::string &name, const RollerProfile &roller) override;
+	BackendHandle sketchCage(BackendHandle component, const std::string &name, const CageProfile &cage) override;
+	BackendHandle revolveRing(BackendHandle component, BackendHandle sketch, const std::string &name) override;
+	BackendHandle revolveCut(BackendHandle component, BackendHandle sketch, const std::string &name) override;
+	BackendHandle fillet(BackendHandle component, BackendHandle revolve, const RingProfile &ring, const std::string &name, double radius) override;
+	bool patternBalls(BackendHandle component, BackendHandle innerRing, const std::string &name, double ballRadius, double pitchRadius, double height, int count) override;
+	bool ballBody(BackendHandle component, const std::string &name, const BallPlacement &placement) override;
+	bool patternRollers(BackendHandle component, BackendHandle innerRing, const std::string &name, const RollerProfile &roller, int count) override;
+	bool rollerBody(BackendHandle component, const std::string &name, const RollerProfile &roller, const BallPlacement &placement) override;
+	bool ballOccurrences(BackendHandle component, const std::string &name, const BallPlacement &placement) override;
+	bool rollerOccurrences(BackendHandle component, const std::string &name, const RollerProfile &roller, const BallPlacement &placement) override;
+	bool ballPockets(BackendHandle component, BackendHandle cage, const std::string &name, const RacewayCircle &pocket, int count) override;
+	bool rollerPockets(BackendHandle component, BackendHandle cage, const std::string &name, const RollerProfile &pocket, int count) override;
+	bool joint(BackendHandle component, BackendHandle innerRing, BackendHandle outerRing) override;
+	bool cageJoint(BackendHandle component, BackendHandle innerRing, BackendHandle cage) override;
+	bool setName(BackendHandle component, const std::string &name) override;
+	bool setAttribute(BackendHandle component, const std::string &name, const std::string &value) override;
+	bool getAttribute(BackendHandle component, const std::string &name, std::string *value) override;
+	std::string newParameterPrefix() override;
+	bool setUserParameters(const std::vector<BearingParameter> &parameters) override;
+	bool getUserParameter(const std::string &name, std::string *expression) override;
+	BackendHandle findObject(BackendHandle component, const std::string &name) override;
+	bool updateSketchCircle(BackendHandle sketch, const RacewayCircle &circle) override;
+	bool updateSketchRing(BackendHandle sketch, const RingProfile &ring, bool outer) override;
+	bool updateFillet(BackendHandle fillet, double radius) override;
+	bool updatePatternBalls(BackendHandle component, const std::string &name, double ballRadius, double pitchRadius, int count) override;
+	bool updateBallBody(BackendHandle component, const std::string &name, const BallPlacement &placement) override;
+	bool checkReturn(BackendHandle handle) override;
+
+private:
+	BackendHandle allocate() { return ++miLastHandle; }
+	BackendHandle record(const char *name, const std::string &arguments, Clock::time_point start, BackendHandle result, bool allocates);
+	BackendHandle remember(BackendHandle component, const std::string &name, BackendHandle object);
+
+	BearingBackend *mpInner;
+	Clock::time_point mtOrigin;
+	std::vector<Call> mCalls;
+	long long miAllocations;
+	long long miCheckReturns;
+	BackendHandle miLastHandle;
+	// Attributes and named objects per component, so that cached bearings and
+	// the parts of a bearing are found without Fusion too.
+	std::map<std::pair<BackendHandle, std::string>, std::string> mAttributes;
+	std::map<std::pair<BackendHandle, std::string>, BackendHandle> mNames;
+	std::map<BackendHandle, int> mOccurrences;
+	std::map<std::string, std::string> mParameters;
+	int miLastPrefix;
+};
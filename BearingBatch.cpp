@@ -0,0 +1,175 @@
+#include "BearingBatch.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "BearingCatalog.h"
+
+static bool endsWith(const std::string &text, const std::string &suffix)
+{
+	if (text.size() < suffix.size())
+		return false;
+	for (size_t i = 0; i < suffix.size(); ++i) {
+		if (std::tolower((unsigned char)text[text.size() - suffix.size() + i]) != suffix[i])
+			return false;
+	}
+	return true;
+}
+
+bool readBearingSpecs(const std::string &path, const std::string &units, std::vector<BearingSpec> *specs, std::string *error)
+{
+	if (endsWith(path, ".bbcat"))
+		return readBearingCatalogSpecs(path, units, specs, error);
+
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	if (!file) {
+		if (error)
+			*error = "Cannot open " + path;
+		return false;
+	}
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+
+	if (endsWith(path, ".json"))
+		return parseBearingSpecsJson(buffer.str(), specs, error);
+	return parseBearingSpecsCsv(buffer.str(), specs, error);
+}
+
+bool parseBearingSpecsCsv(const std::string &text, std::vector<BearingSpec> *specs, std::string *error)
+{
+	std::istringstream stream(text);
+	std::string strLine;
+	int iLine = 0;
+	while (std::getline(stream, strLine)) {
+		++iLine;
+
+		// Treat ';', tabs and spaces like commas.
+		for (char &c : strLine) {
+			if (c == ';' || c == '\t' || c == '\r')
+				c = ',';
+		}
+
+		size_t iFirst = strLine.find_first_not_of(", ");
+		if (iFirst == std::string::npos || strLine[iFirst] == '#')
+			continue;
+
+		double dValues[3];
+		int iCount = 0;
+		const char *pCursor = strLine.c_str() + iFirst;
+		while (iCount < 3 && *pCursor) {
+			char *pEnd = nullptr;
+			double dValue = std::strtod(pCursor, &pEnd);
+			if (pEnd == pCursor)
+				break;
+			dValues[iCount++] = dValue;
+			pCursor = pEnd;
+			while (*pCursor == ',' || *pCursor == ' ')
+				++pCursor;
+		}
+
+		if (iCount == 0 && specs->empty())
+			continue; // header
+		if (iCount != 3) {
+			if (error)
+				*error = "Line " + std::to_string(iLine) + ": expected inner, outer and thickness values";
+			return false;
+		}
+		// strtod also reads "nan" and "inf".
+		if (!(std::isfinite(dValues[0]) && std::isfinite(dValues[1]) && std::isfinite(dValues[2]))) {
+			if (error)
+				*error = "Line " + std::to_string(iLine) + ": the sizes must be finite numbers";
+			return false;
+		}
+		specs->push_back({ dValues[0], dValues[1], dValues[2] });
+	}
+	return true;
+}
+
+bool parseBearingSpecsJson(const std::string &text, std::vector<BearingSpec> *specs, std::string *error)
+{
+	// Only the small subset of JSON used by bearing lists is understood:
+	// an outer array of objects or of three number arrays.
+	double dValues[3];
+	bool xHasValue[3] = { false, false, false };
+	int iArrayCount = 0;
+	int iDepth = 0;
+	bool xInObject = false;
+	int iKey = -1;
+
+	for (size_t i = 0; i < text.size(); ++i) {
+		char c = text[i];
+		if (c == '[') {
+			++iDepth;
+			iArrayCount = 0;
+		}
+		else if (c == ']') {
+			if (iDepth == 2 && !xInObject) {
+				if (iArrayCount != 3) {
+					if (error)
+						*error = "Bearing " + std::to_string(specs->size() + 1) + ": expected [inner, outer, thickness]";
+					return false;
+				}
+				specs->push_back({ dValues[0], dValues[1], dValues[2] });
+			}
+			--iDepth;
+		}
+		else if (c == '{') {
+			xInObject = true;
+			xHasValue[0] = xHasValue[1] = xHasValue[2] = false;
+			iKey = -1;
+		}
+		else if (c == '}') {
+			if (!xHasValue[0] || !xHasValue[1] || !xHasValue[2]) {
+				if (error)
+					*error = "Bearing " + std::to_string(specs->size() + 1) + ": innerDiameter, outerDiameter and thickness are required";
+				return false;
+			}
+			specs->push_back({ dValues[0], dValues[1], dValues[2] });
+			xInObject = false;
+		}
+		else if (c == '"') {
+			size_t iEnd = text.find('"', i + 1);
+			if (iEnd == std::string::npos)
+				break;
+			std::string strKey = text.substr(i + 1, iEnd - i - 1);
+			i = iEnd;
+			if (strKey == "innerDiameter" || strKey == "inner")
+				iKey = 0;
+			else if (strKey == "outerDiameter" || strKey == "outer")
+				iKey = 1;
+			else if (strKey == "thickness")
+				iKey = 2;
+			else
+				iKey = -1;
+		}
+		else if (c == '-' || c == '.' || std::isdigit((unsigned char)c)) {
+			char *pEnd = nullptr;
+			double dValue = std::strtod(text.c_str() + i, &pEnd);
+			if (pEnd == text.c_str() + i)
+				continue;
+			i = (pEnd - text.c_str()) - 1;
+			if (!std::isfinite(dValue)) {
+				if (error)
+					*error = "Bearing " + std::to_string(specs->size() + 1) + ": the sizes must be finite numbers";
+				return false;
+			}
+			if (xInObject) {
+				if (iKey >= 0) {
+					dValues[iKey] = dValue;
+					xHasValue[iKey] = true;
+				}
+			}
+			else if (iArrayCount < 3) {
+				dValues[iArrayCount] = dValue;
+				++iArrayCount;
+			}
+			else {
+				++iArrayCount;
+			}
+		}
+	}
+	return true;
+}
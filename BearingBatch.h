@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Main sizes of one bearing as given by the user.
+struct BearingSpec
+{
+	double dInnerDiameter;
+	double dOuterDiameter;
+	double dThickness;
+};
+
+// Reads a list of bearings from a file. CSV files hold one
+// "inner,outer,thickness" row per bearing, header and '#' comment lines are
+// skipped. JSON files hold an array of either [inner, outer, thickness]
+// arrays or objects with innerDiameter/outerDiameter/thickness members.
+// Binary catalogs (.bbcat, see BearingCatalog.h) give all of their sizes,
+// converted from the units stored in the catalog to the given units. Lists
+// have no units of their own and are taken as they are.
+// Returns false and sets the error if the file cannot be read.
+bool readBearingSpecs(const std::string &path, const std::string &units, std::vector<BearingSpec> *specs, std::string *error);
+
+bool parseBearingSpecsCsv(const std::string &text, std::vector<BearingSpec> *specs, std::string *error);
+bool parseBearingSpecsJson(const std::string &text, std::vector<BearingSpec> *specs, std::string *error);
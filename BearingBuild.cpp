@@ -0,0 +1,503 @@
+#include "BearingBuild.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "BearingPlacement.h"
+#include "BearingProperties.h"
+#include "BearingValidation.h"
+
+// Names of the sketches and features of a bearing, used to find them again when it is edited.
+static const char *kRacewaySketch = "Raceway Profile";
+static const char *kInnerRingSketch = "Inner Ring Profile";
+static const char *kOuterRingSketch = "Outer Ring Profile";
+static const char *kInnerRing = "Inner Ring";
+static const char *kOuterRing = "Outer Ring";
+static const char *kInnerRingFillet = "Inner Ring Fillet";
+static const char *kOuterRingFillet = "Outer Ring Fillet";
+static const char *kRacewayCut = "Raceway Cut";
+static const char *kBalls = "Balls";
+static const char *kRollers = "Rollers";
+static const char *kInnerCounterboreSketch = "Inner Ring Counterbore Profile";
+static const char *kOuterCounterboreSketch = "Outer Ring Counterbore Profile";
+static const char *kInnerCounterbore = "Inner Ring Counterbore";
+static const char *kOuterCounterbore = "Outer Ring Counterbore";
+static const char *kCageSketch = "Cage Profile";
+static const char *kCage = "Cage";
+static const char *kCagePockets = "Cage Pockets";
+
+// The objects of the second row of balls get a number, those of the first keep the plain name.
+static std::string rowName(const char *name, int row)
+{
+	return row == 0 ? std::string(name) : std::string(name) + " " + std::to_string(row + 1);
+}
+
+static bool sameLength(double a, double b)
+{
+	return std::fabs(a - b) <= 1.0e-9 * std::fmax(std::fabs(a), std::fabs(b));
+}
+
+static bool sameRing(const RingProfile &a, const RingProfile &b)
+{
+	return sameLength(a.dRadiusMin, b.dRadiusMin) && sameLength(a.dRadiusMax, b.dRadiusMax) && sameLength(a.dHalfThickness, b.dHalfThickness) &&
+		sameLength(a.dCenterHeight, b.dCenterHeight);
+}
+
+static std::string bearingName(const BearingGeometry &geometry)
+{
+	const char *pKind = "Ball Bearing";
+	switch (geometry.eFamily) {
+	case DoubleRowBearing: pKind = "Double Row Ball Bearing"; break;
+	case AngularContactBearing: pKind = "Angular Contact Ball Bearing"; break;
+	case ThrustBearing: pKind = "Thrust Ball Bearing"; break;
+	case CylindricalRollerBearing: pKind = "Cylindrical Roller Bearing"; break;
+	case TaperedRollerBearing: pKind = "Tapered Roller Bearing"; break;
+	default: break;
+	}
+	return std::string(pKind) + " (" + std::to_string(geometry.dInnerDiameter) + " : " + std::to_string(geometry.dOuterDiameter) + ")";
+}
+
+static const char *ballCreationName(BallCreationMode ballCreation)
+{
+	switch (ballCreation) {
+	case SingleBodyBallCreation: return "body";
+	case OccurrenceBallCreation: return "occurrences";
+	default: return "pattern";
+	}
+}
+
+static std::string bearingVariant(BearingFamily family, int ballCount, BallCreationMode ballCreation, bool cage, const std::string &units)
+{
+	// Bearings built with other ball options are different components.
+	std::string strVariant = units + ";balls=" + std::to_string(ballCount);
+	if (ballCreation == SingleBodyBallCreation)
+		strVariant += ";body";
+	else if (ballCreation == OccurrenceBallCreation)
+		strVariant += ";occurrences";
+	if (cage)
+		strVariant += ";cage";
+	// Deep groove bearings keep the keys they had before there were families.
+	if (family != DeepGrooveBearing)
+		strVariant += std::string(";family=") + bearingFamilyName(family);
+	return strVariant;
+}
+
+BackendHandle buildBallBearing(BearingBackend *backend, const BearingGeometry &geometry, const BearingBuildOptions &options, BuildTrace *trace)
+{
+	std::string strCacheKey = bearingCacheKey(geometry.dInnerDiameter, geometry.dOuterDiameter, geometry.dThickness,
+		bearingVariant(geometry.eFamily, geometry.iBallCount, options.eBallCreation, options.xCage, options.strUnits));
+	if (options.xReuseBearings) {
+		ScopedStage stage(trace, "cache lookup");
+		BackendHandle cached = backend->insertCachedBearing(strCacheKey);
+		if (cached != 0)
+			return cached;
+	}
+
+	BackendHandle component;
+	{
+		ScopedStage stage(trace, "component");
+		component = backend->createComponent();
+		if (!backend->checkReturn(component))
+			return 0;
+	}
+
+	// Parametric designs get the sizes of deep groove bearings as user parameters that drive the sketches and features.
+	if (geometry.eFamily == DeepGrooveBearing) {
+		ScopedStage stage(trace, "parameters");
+		std::string strPrefix = backend->newParameterPrefix();
+		if (!strPrefix.empty()) {
+			std::vector<BearingParameter> parameters;
+			bearingUserParameters(geometry, options, strPrefix, &parameters);
+			if (!backend->setAttribute(component, "parameterPrefix", strPrefix) || !backend->setUserParameters(parameters))
+				return 0;
+		}
+	}
+
+	BackendHandle sketchBallsCutout[kMaxBallRows];
+	for (int iRow = 0; iRow < geometry.iRowCount; ++iRow) {
+		ScopedStage stage(trace, "sketch ball cutout");
+		// Roller bearings cut the groove with the cross section of the roller.
+		if (geometry.eElement != BallElement)
+			sketchBallsCutout[iRow] = backend->sketchRoller(component, rowName(kRacewaySketch, iRow), geometry.roller);
+		else
+			sketchBallsCutout[iRow] = backend->sketchCircle(component, rowName(kRacewaySketch, iRow), rowRaceway(geometry, iRow));
+		if (!backend->checkReturn(sketchBallsCutout[iRow]))
+			return 0;
+	}
+	BackendHandle sketchInnerRing;
+	{
+		ScopedStage stage(trace, "sketch inner ring");
+		sketchInnerRing = backend->sketchRing(component, kInnerRingSketch, geometry.innerRing, false);
+		if (!backend->checkReturn(sketchInnerRing))
+			return 0;
+	}
+	BackendHandle sketchOuterRing;
+	{
+		ScopedStage stage(trace, "sketch outer ring");
+		sketchOuterRing = backend->sketchRing(component, kOuterRingSketch, geometry.outerRing, true);
+		if (!backend->checkReturn(sketchOuterRing))
+			return 0;
+	}
+
+	// Revolve the profiles into one component per ring.
+	BackendHandle revolveInnerRing;
+	{
+		ScopedStage stage(trace, "revolve ring");
+		revolveInnerRing = backend->revolveRing(component, sketchInnerRing, kInnerRing);
+		if (!backend->checkReturn(revolveInnerRing))
+			return 0;
+	}
+	BackendHandle revolveOuterRing;
+	{
+		ScopedStage stage(trace, "revolve ring");
+		revolveOuterRing = backend->revolveRing(component, sketchOuterRing, kOuterRing);
+		if (!backend->checkReturn(revolveOuterRing))
+			return 0;
+	}
+
+	for (int iRow = 0; iRow < geometry.iRowCount; ++iRow) {
+		ScopedStage stage(trace, "raceway cut");
+		if (!backend->checkReturn(backend->revolveCut(component, sketchBallsCutout[iRow], rowName(kRacewayCut, iRow))))
+			return 0;
+	}
+
+	// Lowered shoulders of angular contact bearings.
+	if (hasCounterbore(geometry.innerCounterbore)) {
+		ScopedStage stage(trace, "counterbore");
+		BackendHandle sketch = backend->sketchRing(component, kInnerCounterboreSketch, geometry.innerCounterbore, false);
+		if (!backend->checkReturn(sketch) || !backend->checkReturn(backend->revolveCut(component, sketch, kInnerCounterbore)))
+			return 0;
+	}
+	if (hasCounterbore(geometry.outerCounterbore)) {
+		ScopedStage stage(trace, "counterbore");
+		BackendHandle sketch = backend->sketchRing(component, kOuterCounterboreSketch, geometry.outerCounterbore, true);
+		if (!backend->checkReturn(sketch) || !backend->checkReturn(backend->revolveCut(component, sketch, kOuterCounterbore)))
+			return 0;
+	}
+
+	// Fillets last, so they only see the ring corners that the cuts leave.
+	if (geometry.dFilletRadius > 0.0) {
+		ScopedStage stage(trace, "fillet");
+		if (!backend->checkReturn(backend->fillet(component, revolveInnerRing, geometry.innerRing, kInnerRingFillet, geometry.dFilletRadius)))
+			return 0;
+		if (!backend->checkReturn(backend->fillet(component, revolveOuterRing, geometry.outerRing, kOuterRingFillet, geometry.dFilletRadius)))
+			return 0;
+	}
+
+	// The rolling elements differ only in the generator, their positions come from the same placement.
+	bool xRollers = geometry.eElement != BallElement;
+	for (int iRow = 0; iRow < geometry.iRowCount; ++iRow) {
+		ScopedStage stage(trace, "balls");
+		std::string strName = rowName(xRollers ? kRollers : kBalls, iRow);
+		if (options.eBallCreation == SingleBodyBallCreation) {
+			BallPlacement placement;
+			if (!placeRollingElements(geometry, iRow, &placement))
+				return 0;
+			if (xRollers ? !backend->rollerBody(component, strName, geometry.roller, placement) : !backend->ballBody(component, strName, placement))
+				return 0;
+		}
+		else if (options.eBallCreation == OccurrenceBallCreation) {
+			BallPlacement placement;
+			if (!placeRollingElements(geometry, iRow, &placement))
+				return 0;
+			if (xRollers ? !backend->rollerOccurrences(component, strName, geometry.roller, placement) : !backend->ballOccurrences(component, strName, placement))
+				return 0;
+		}
+		else if (xRollers) {
+			if (!backend->patternRollers(component, revolveInnerRing, strName, geometry.roller, geometry.iBallCount))
+				return 0;
+		}
+		else if (!backend->patternBalls(component, revolveInnerRing, strName, geometry.dBallRadius, geometry.dPitchRadius,
+			geometry.rowHeights[iRow], geometry.iBallCount)) {
+			return 0;
+		}
+	}
+
+	// The cage band gets one pocket per row, patterned around the axis.
+	BackendHandle revolveCage = 0;
+	if (options.xCage && geometry.cage.band.dHalfThickness > 0.0) {
+		ScopedStage stage(trace, "cage");
+		BackendHandle sketch = backend->sketchCage(component, kCageSketch, geometry.cage);
+		revolveCage = backend->checkReturn(sketch) ? backend->revolveRing(component, sketch, kCage) : 0;
+		if (!backend->checkReturn(revolveCage))
+			return 0;
+		for (int iRow = 0; iRow < geometry.iRowCount; ++iRow) {
+			std::string strName = rowName(kCagePockets, iRow);
+			if (xRollers ? !backend->rollerPockets(component, revolveCage, strName, cageRollerPocket(geometry), geometry.iBallCount) :
+				!backend->ballPockets(component, revolveCage, strName, cageBallPocket(geometry, iRow), geometry.iBallCount))
+				return 0;
+		}
+	}
+
+	{
+		ScopedStage stage(trace, "joint");
+		if (!backend->joint(component, revolveInnerRing, revolveOuterRing))
+			return 0;
+		if (revolveCage != 0 && !backend->cageJoint(component, revolveInnerRing, revolveCage))
+			return 0;
+	}
+
+	backend->setName(component, bearingName(geometry));
+
+	// Remember the size so that later requests can reuse or edit this component.
+	storeBearingParameters(backend, component, geometry, options);
+
+	return component;
+}
+
+void bearingUserParameters(const BearingGeometry &geometry, const BearingBuildOptions &options, const std::string &prefix, std::vector<BearingParameter> *parameters)
+{
+	std::string strInner = prefix + "innerDiameter";
+	std::string strOuter = prefix + "outerDiameter";
+	std::string strThickness = prefix + "thickness";
+	std::string strBallRadius = prefix + "ballRadius";
+	std::string strRingWidth = prefix + "ringWidth";
+	std::string strPitchRadius = prefix + "pitchRadius";
+
+	auto length = [&](double value) {
+		char buffer[64];
+		std::snprintf(buffer, sizeof(buffer), "%.12g %s", value * options.dDisplayScale, options.strDisplayUnits.c_str());
+		return std::string(buffer);
+	};
+
+	// The rules of computeBearingGeometry, min(a, b) is written as (a + b - abs(a - b)) / 2.
+	BearingGeometry standard;
+	computeBearingGeometry(geometry.dInnerDiameter, geometry.dOuterDiameter, geometry.dThickness, &standard);
+	std::string strGap = "(" + strOuter + " - " + strInner + ")";
+	std::string strBallRadiusRule = "(0.6 * " + strThickness + " + 0.3 * " + strGap + " - abs(0.6 * " + strThickness + " - 0.3 * " + strGap + ")) / 4";
+	std::string strRingWidthRule = strGap + " * 0.25 - " + strBallRadius + " * 0.5";
+	std::string strPitchRadiusRule = "(" + strOuter + " + " + strInner + ") / 4";
+	std::string strFilletRadiusRule = strRingWidth + " * 0.1";
+	std::string strBallCountRule = "floor(3.141592 * " + strPitchRadius + " / " + strBallRadius + ") - 1";
+
+	parameters->clear();
+	parameters->push_back({ strInner, length(geometry.dInnerDiameter), options.strDisplayUnits, "Bearing bore" });
+	parameters->push_back({ strOuter, length(geometry.dOuterDiameter), options.strDisplayUnits, "Bearing outer diameter" });
+	parameters->push_back({ strThickness, length(geometry.dThickness), options.strDisplayUnits, "Bearing width" });
+	parameters->push_back({ strBallRadius, sameLength(geometry.dBallRadius, standard.dBallRadius) ? strBallRadiusRule : length(geometry.dBallRadius),
+		options.strDisplayUnits, "Ball radius" });
+	parameters->push_back({ strRingWidth, sameLength(geometry.dRingWidth, standard.dRingWidth) ? strRingWidthRule : length(geometry.dRingWidth),
+		options.strDisplayUnits, "Radial width of each ring" });
+	parameters->push_back({ strPitchRadius, sameLength(geometry.dPitchRadius, standard.dPitchRadius) ? strPitchRadiusRule : length(geometry.dPitchRadius),
+		options.strDisplayUnits, "Radius of the ball centres" });
+	parameters->push_back({ prefix + "filletRadius", sameLength(geometry.dFilletRadius, standard.dFilletRadius) ? strFilletRadiusRule : length(geometry.dFilletRadius),
+		options.strDisplayUnits, "Ring edge fillet" });
+	parameters->push_back({ prefix + "ballCount", geometry.iBallCount == standard.iBallCount ? strBallCountRule : std::to_string(geometry.iBallCount),
+		"", "Number of balls" });
+}
+
+bool storeBearingParameters(BearingBackend *backend, BackendHandle component, const BearingGeometry &geometry, const BearingBuildOptions &options)
+{
+	// Stored with full precision, the edit compares them with the new sizes.
+	char buffer[32];
+	bool xResult = true;
+	std::snprintf(buffer, sizeof(buffer), "%.17g", geometry.dInnerDiameter);
+	xResult &= backend->setAttribute(component, "innerDiameter", buffer);
+	std::snprintf(buffer, sizeof(buffer), "%.17g", geometry.dOuterDiameter);
+	xResult &= backend->setAttribute(component, "outerDiameter", buffer);
+	std::snprintf(buffer, sizeof(buffer), "%.17g", geometry.dThickness);
+	xResult &= backend->setAttribute(component, "thickness", buffer);
+	xResult &= backend->setAttribute(component, "ballCount", std::to_string(geometry.iBallCount));
+	xResult &= backend->setAttribute(component, "ballCreation", ballCreationName(options.eBallCreation));
+	xResult &= backend->setAttribute(component, "cage", options.xCage ? "yes" : "no");
+	xResult &= backend->setAttribute(component, "units", options.strUnits);
+	xResult &= backend->setAttribute(component, "family", bearingFamilyName(geometry.eFamily));
+	xResult &= backend->setAttribute(component, "cacheKey", bearingCacheKey(geometry.dInnerDiameter, geometry.dOuterDiameter, geometry.dThickness,
+		bearingVariant(geometry.eFamily, geometry.iBallCount, options.eBallCreation, options.xCage, options.strUnits)));
+
+	// Computed from the geometry, so BOM tools do not have to query the bodies.
+	BearingProperties properties;
+	if (computeBearingProperties(geometry, unitsToMillimetres(options.strUnits), kBearingSteelDensity, &properties)) {
+		std::snprintf(buffer, sizeof(buffer), "%.9g", properties.dMass);
+		xResult &= backend->setAttribute(component, "mass", buffer);
+		std::snprintf(buffer, sizeof(buffer), "%.9g", properties.dInertia);
+		xResult &= backend->setAttribute(component, "inertia", buffer);
+		std::snprintf(buffer, sizeof(buffer), "%.9g", properties.dPitchDiameter);
+		xResult &= backend->setAttribute(component, "pitchDiameter", buffer);
+		std::snprintf(buffer, sizeof(buffer), "%.9g", properties.dDynamicLoadRating);
+		xResult &= backend->setAttribute(component, "dynamicLoadRating", buffer);
+		std::snprintf(buffer, sizeof(buffer), "%.9g", properties.dStaticLoadRating);
+		xResult &= backend->setAttribute(component, "staticLoadRating", buffer);
+	}
+	return xResult;
+}
+
+bool loadBearingParameters(BearingBackend *backend, BackendHandle component, BearingParameters *parameters)
+{
+	std::string strInner, strOuter, strThickness, strBallCount, strBallCreation, strFamily, strCage;
+	if (!backend->getAttribute(component, "innerDiameter", &strInner) || !backend->getAttribute(component, "outerDiameter", &strOuter) ||
+		!backend->getAttribute(component, "thickness", &strThickness) || !backend->getAttribute(component, "ballCount", &strBallCount))
+		return false;
+	if (!backend->getAttribute(component, "ballCreation", &strBallCreation))
+		strBallCreation = "pattern";
+	parameters->xCage = backend->getAttribute(component, "cage", &strCage) && strCage == "yes";
+	if (!backend->getAttribute(component, "units", &parameters->strUnits))
+		parameters->strUnits = "cm";
+	if (!backend->getAttribute(component, "parameterPrefix", &parameters->strParameterPrefix))
+		parameters->strParameterPrefix.clear();
+	// Bearings from before the families are deep groove ones.
+	if (!backend->getAttribute(component, "family", &strFamily) || !parseBearingFamily(strFamily, &parameters->eFamily))
+		parameters->eFamily = DeepGrooveBearing;
+
+	parameters->dInnerDiameter = std::atof(strInner.c_str());
+	parameters->dOuterDiameter = std::atof(strOuter.c_str());
+	parameters->dThickness = std::atof(strThickness.c_str());
+	parameters->iBallCount = std::atoi(strBallCount.c_str());
+	parameters->eBallCreation = PatternBallCreation;
+	if (strBallCreation == "body")
+		parameters->eBallCreation = SingleBodyBallCreation;
+	else if (strBallCreation == "occurrences")
+		parameters->eBallCreation = OccurrenceBallCreation;
+	return true;
+}
+
+std::string formatDialogDefaults(const DialogDefaults &defaults)
+{
+	char buffer[96];
+	std::snprintf(buffer, sizeof(buffer), "%.17g;%.17g;%.17g;", defaults.dInnerDiameter, defaults.dOuterDiameter, defaults.dThickness);
+	return buffer + std::string(bearingFamilyName(defaults.eFamily));
+}
+
+bool parseDialogDefaults(const std::string &record, DialogDefaults *defaults)
+{
+	double dSizes[3];
+	const char *pCursor = record.c_str();
+	for (int i = 0; i < 3; ++i) {
+		char *pEnd = nullptr;
+		dSizes[i] = std::strtod(pCursor, &pEnd);
+		if (pEnd == pCursor || *pEnd != ';' || !(dSizes[i] > 0.0))
+			return false;
+		pCursor = pEnd + 1;
+	}
+	BearingFamily eFamily;
+	if (!parseBearingFamily(pCursor, &eFamily))
+		return false;
+
+	defaults->dInnerDiameter = dSizes[0];
+	defaults->dOuterDiameter = dSizes[1];
+	defaults->dThickness = dSizes[2];
+	defaults->eFamily = eFamily;
+	return true;
+}
+
+BearingChanges diffBearingGeometry(const BearingGeometry &from, const BearingGeometry &to)
+{
+	BearingChanges changes;
+	changes.xRaceway = !sameLength(from.raceway.dCenterRadius, to.raceway.dCenterRadius) || !sameLength(from.raceway.dCenterHeight, to.raceway.dCenterHeight) ||
+		!sameLength(from.raceway.dRadius, to.raceway.dRadius);
+	changes.xInnerRing = !sameRing(from.innerRing, to.innerRing);
+	changes.xOuterRing = !sameRing(from.outerRing, to.outerRing);
+	changes.xFillet = !sameLength(from.dFilletRadius, to.dFilletRadius);
+	changes.xBalls = !sameLength(from.dBallRadius, to.dBallRadius) || !sameLength(from.dPitchRadius, to.dPitchRadius) || from.iBallCount != to.iBallCount;
+	return changes;
+}
+
+bool updateBallBearing(BearingBackend *backend, BackendHandle component, const BearingGeometry &geometry, const BearingBuildOptions &options,
+	BuildTrace *trace, BearingChanges *changes)
+{
+	BearingParameters parameters;
+	if (!loadBearingParameters(backend, component, &parameters))
+		return false;
+
+	// The stored sizes give the geometry the bearing was built with.
+	BearingGeometry from;
+	BearingValidation validation;
+	if (!computeBearingGeometry(parameters.eFamily, parameters.dInnerDiameter, parameters.dOuterDiameter, parameters.dThickness, &from))
+		return false;
+	validateBearingGeometry(&from, true, &validation);
+	from.iBallCount = parameters.iBallCount;
+
+	BearingChanges diff = diffBearingGeometry(from, geometry);
+	if (changes)
+		*changes = diff;
+	// Reused bearings of the same size share the component and would all change.
+	if (backend->occurrenceCount(component) > 1)
+		return false;
+	// Only deep groove bearings are edited in place, the other families are built again.
+	if (from.eFamily != DeepGrooveBearing || geometry.eFamily != DeepGrooveBearing)
+		return false;
+	if ((from.dFilletRadius > 0.0) != (geometry.dFilletRadius > 0.0))
+		return false;
+	// Ball occurrences may be shared with other bearings, so new balls mean a new bearing.
+	if (diff.xBalls && parameters.eBallCreation == OccurrenceBallCreation)
+		return false;
+	// The cage is not part of the edit.
+	if (parameters.xCage && diff.any())
+		return false;
+
+	BearingBuildOptions stored;
+	stored.eBallCreation = parameters.eBallCreation;
+	stored.xReuseBearings = false;
+	stored.xCage = parameters.xCage;
+	stored.strUnits = parameters.strUnits;
+	stored.strDisplayUnits = options.strDisplayUnits;
+	stored.dDisplayScale = options.dDisplayScale;
+
+	if (!parameters.strParameterPrefix.empty()) {
+		// Only the parameters that differ are changed, the sketches and features follow them.
+		ScopedStage stage(trace, "parameters");
+		std::vector<BearingParameter> userParameters;
+		std::vector<BearingParameter> changed;
+		bearingUserParameters(geometry, stored, parameters.strParameterPrefix, &userParameters);
+		for (const BearingParameter &parameter : userParameters) {
+			std::string strExpression;
+			if (!backend->getUserParameter(parameter.strName, &strExpression) || strExpression != parameter.strExpression)
+				changed.push_back(parameter);
+		}
+		if (!changed.empty() && !backend->setUserParameters(changed))
+			return false;
+		// Balls made of one body are not part of the parametric model.
+		if (diff.xBalls && parameters.eBallCreation == SingleBodyBallCreation) {
+			BallPlacement placement;
+			if (!placeBalls(geometry.dPitchRadius, geometry.dBallRadius, 0.0, geometry.iBallCount, &placement) ||
+				!backend->updateBallBody(component, kBalls, placement))
+				return false;
+		}
+		backend->setName(component, bearingName(geometry));
+		return storeBearingParameters(backend, component, geometry, stored);
+	}
+
+	if (diff.xRaceway) {
+		ScopedStage stage(trace, "sketch ball cutout");
+		BackendHandle sketch = backend->findObject(component, kRacewaySketch);
+		if (!backend->checkReturn(sketch) || !backend->updateSketchCircle(sketch, geometry.raceway))
+			return false;
+	}
+	if (diff.xInnerRing) {
+		ScopedStage stage(trace, "sketch inner ring");
+		BackendHandle sketch = backend->findObject(component, kInnerRingSketch);
+		if (!backend->checkReturn(sketch) || !backend->updateSketchRing(sketch, geometry.innerRing, false))
+			return false;
+	}
+	if (diff.xOuterRing) {
+		ScopedStage stage(trace, "sketch outer ring");
+		BackendHandle sketch = backend->findObject(component, kOuterRingSketch);
+		if (!backend->checkReturn(sketch) || !backend->updateSketchRing(sketch, geometry.outerRing, true))
+			return false;
+	}
+	if (diff.xFillet && geometry.dFilletRadius > 0.0) {
+		ScopedStage stage(trace, "fillet");
+		for (const char *pName : { kInnerRingFillet, kOuterRingFillet }) {
+			BackendHandle fillet = backend->findObject(component, pName);
+			if (!backend->checkReturn(fillet) || !backend->updateFillet(fillet, geometry.dFilletRadius))
+				return false;
+		}
+	}
+	if (diff.xBalls) {
+		ScopedStage stage(trace, "balls");
+		if (parameters.eBallCreation == SingleBodyBallCreation) {
+			BallPlacement placement;
+			if (!placeBalls(geometry.dPitchRadius, geometry.dBallRadius, 0.0, geometry.iBallCount, &placement))
+				return false;
+			if (!backend->updateBallBody(component, kBalls, placement))
+				return false;
+		}
+		else if (!backend->updatePatternBalls(component, kBalls, geometry.dBallRadius, geometry.dPitchRadius, geometry.iBallCount)) {
+			return false;
+		}
+	}
+
+	backend->setName(component, bearingName(geometry));
+	return storeBearingParameters(backend, component, geometry, stored);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "BearingBackend.h"
+#include "BearingGeometry.h"
+#include "BearingTrace.h"
+
+// How the balls are created: one revolved ball copied by a circular pattern,
+// all balls as a single body, or one ball component placed as an occurrence
+// per ball. The occurrences share one body, so a bearing only holds the
+// transforms of its balls.
+enum BallCreationMode
+{
+	PatternBallCreation,
+	SingleBodyBallCreation,
+	OccurrenceBallCreation
+};
+
+struct BearingBuildOptions
+{
+	BallCreationMode eBallCreation;
+	// Insert another occurrence of an existing bearing of the same size instead of building it again.
+	bool xReuseBearings;
+	// Add a cage with a pocket around every rolling element, jointed to the inner ring.
+	bool xCage;
+	// Units of the sizes, part of the cache key.
+	std::string strUnits;
+	// Units the user parameters are shown in and the factor from the units of the sizes to them.
+	std::string strDisplayUnits;
+	double dDisplayScale;
+};
+
+// Builds a validated bearing with the backend and returns its component, 0 on failure.
+// Every step is timed into the trace if one is given.
+BackendHandle buildBallBearing(BearingBackend *backend, const BearingGeometry &geometry, const BearingBuildOptions &options, BuildTrace *trace);
+
+// User parameters that drive a bearing, their names start with the prefix. The
+// derived sizes are expressions of the main sizes as long as the geometry follows
+// the standard sizing rules, values that were changed by the validation or the
+// ball clearance are stored as plain values.
+void bearingUserParameters(const BearingGeometry &geometry, const BearingBuildOptions &options, const std::string &prefix, std::vector<BearingParameter> *parameters);
+
+// Sizes and options a bearing was built with. They are stored as attributes of
+// its component, so that the bearing can be found and edited later.
+struct BearingParameters
+{
+	double dInnerDiameter;
+	double dOuterDiameter;
+	double dThickness;
+	int iBallCount;
+	BallCreationMode eBallCreation;
+	bool xCage;
+	std::string strUnits;
+	BearingFamily eFamily;
+	// Empty for bearings that are not driven by user parameters.
+	std::string strParameterPrefix;
+};
+
+// Also stores the mass in kg, the inertia about the axis in kg mm^2, the pitch
+// diameter in mm and the load ratings in N, see BearingProperties.h.
+bool storeBearingParameters(BearingBackend *backend, BackendHandle component, const BearingGeometry &geometry, const BearingBuildOptions &options);
+// Returns false if the component holds no bearing parameters.
+bool loadBearingParameters(BearingBackend *backend, BackendHandle component, BearingParameters *parameters);
+
+// Values the dialog opens with, the last ones used in a design. They are kept
+// as one "BallBearing/dialog" attribute of the design in the form
+// "inner;outer;thickness;family", sizes in internal units, so opening the
+// dialog reads a single attribute.
+struct DialogDefaults
+{
+	double dInnerDiameter;
+	double dOuterDiameter;
+	double dThickness;
+	BearingFamily eFamily;
+};
+
+std::string formatDialogDefaults(const DialogDefaults &defaults);
+// Returns false and leaves the defaults alone if the record is damaged.
+bool parseDialogDefaults(const std::string &record, DialogDefaults *defaults);
+
+// Parts of a bearing that differ between two geometries.
+struct BearingChanges
+{
+	bool xRaceway;
+	bool xInnerRing;
+	bool xOuterRing;
+	bool xFillet;
+	bool xBalls;
+
+	bool any() const { return xRaceway || xInnerRing || xOuterRing || xFillet || xBalls; }
+};
+
+BearingChanges diffBearingGeometry(const BearingGeometry &from, const BearingGeometry &to);
+
+// Changes an existing bearing to the new geometry. Bearings driven by user
+// parameters only get the parameters that differ, older ones get the sketches
+// and features that differ edited, everything else stays as it is. Returns
+// false if the component is no bearing or cannot be changed in place, which is
+// the case for components with more than one occurrence, for bearings of another
+// family than deep groove, when the fillets have to be added or removed, when
+// balls made of occurrences change and for bearings with a cage. Only the
+// display units of the options are used, the others are taken from the bearing.
+bool updateBallBearing(BearingBackend *backend, BackendHandle component, const BearingGeometry &geometry, const BearingBuildOptions &options,
+	BuildTrace *trace, BearingChanges *changes);
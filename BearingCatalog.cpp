@@ -0,0 +1,328 @@
+#include "BearingCatalog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "BearingProperties.h"
+
+static const char kCatalogMagic[8] = { 'B', 'B', 'C', 'A', 'T', 0, 0, 0 };
+
+static bool boreLess(const CatalogRecord &a, const CatalogRecord &b)
+{
+	if (a.dInnerDiameter != b.dInnerDiameter)
+		return a.dInnerDiameter < b.dInnerDiameter;
+	if (a.dOuterDiameter != b.dOuterDiameter)
+		return a.dOuterDiameter < b.dOuterDiameter;
+	return a.dThickness < b.dThickness;
+}
+
+static bool outerLess(const CatalogRecord &a, const CatalogRecord &b)
+{
+	if (a.dOuterDiameter != b.dOuterDiameter)
+		return a.dOuterDiameter < b.dOuterDiameter;
+	if (a.dInnerDiameter != b.dInnerDiameter)
+		return a.dInnerDiameter < b.dInnerDiameter;
+	return a.dThickness < b.dThickness;
+}
+
+static bool widthLess(const CatalogRecord &a, const CatalogRecord &b)
+{
+	if (a.dThickness != b.dThickness)
+		return a.dThickness < b.dThickness;
+	if (a.dInnerDiameter != b.dInnerDiameter)
+		return a.dInnerDiameter < b.dInnerDiameter;
+	return a.dOuterDiameter < b.dOuterDiameter;
+}
+
+// Record numbers sorted by the given order.
+static std::vector<uint32_t> sortedIndex(const std::vector<CatalogRecord> &records, bool (*less)(const CatalogRecord &, const CatalogRecord &))
+{
+	std::vector<uint32_t> index(records.size());
+	for (size_t i = 0; i < index.size(); ++i)
+		index[i] = (uint32_t)i;
+	std::stable_sort(index.begin(), index.end(), [&](uint32_t a, uint32_t b) { return less(records[a], records[b]); });
+	return index;
+}
+
+// False if an index points past the records.
+static bool validIndex(const uint32_t *index, size_t count)
+{
+	for (size_t i = 0; i < count; ++i) {
+		if (index[i] >= count)
+			return false;
+	}
+	return true;
+}
+
+static bool isLittleEndian()
+{
+	const uint16_t iProbe = 1;
+	return *(const unsigned char *)&iProbe == 1;
+}
+
+void makeCatalogRecord(const BearingGeometry &geometry, const std::string &designation, CatalogRecord *record)
+{
+	std::memset(record, 0, sizeof(*record));
+	record->dInnerDiameter = geometry.dInnerDiameter;
+	record->dOuterDiameter = geometry.dOuterDiameter;
+	record->dThickness = geometry.dThickness;
+	record->dBallRadius = geometry.dBallRadius;
+	record->dRingWidth = geometry.dRingWidth;
+	record->dPitchRadius = geometry.dPitchRadius;
+	record->dFilletRadius = geometry.dFilletRadius;
+	record->iBallCount = geometry.iBallCount;
+	std::strncpy(record->designation, designation.c_str(), sizeof(record->designation) - 1);
+}
+
+bool writeBearingCatalog(const std::string &path, const std::string &units, std::vector<CatalogRecord> records, std::string *error)
+{
+	if (!isLittleEndian()) {
+		if (error)
+			*error = "Catalogs can only be written on little endian machines.";
+		return false;
+	}
+	if (records.size() > 0xffffffffu || units.size() >= sizeof(CatalogHeader::units)) {
+		if (error)
+			*error = "Too many records or units too long for a catalog.";
+		return false;
+	}
+	// Readers convert the sizes to their own units.
+	if (unitsToMillimetres(units) <= 0.0) {
+		if (error)
+			*error = "Unknown catalog units '" + units + "', use mm, cm, m, in or ft.";
+		return false;
+	}
+
+	std::sort(records.begin(), records.end(), boreLess);
+	std::vector<uint32_t> outerIndex = sortedIndex(records, outerLess);
+	std::vector<uint32_t> widthIndex = sortedIndex(records, widthLess);
+
+	CatalogHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, kCatalogMagic, sizeof(header.magic));
+	header.iVersion = kCatalogVersion;
+	header.iRecordSize = sizeof(CatalogRecord);
+	header.iRecordCount = records.size();
+	header.iRecordOffset = sizeof(CatalogHeader);
+	header.iOuterIndexOffset = header.iRecordOffset + records.size() * sizeof(CatalogRecord);
+	header.iWidthIndexOffset = header.iOuterIndexOffset + records.size() * sizeof(uint32_t);
+	std::strncpy(header.units, units.c_str(), sizeof(header.units) - 1);
+
+	FILE *pFile = std::fopen(path.c_str(), "wb");
+	if (!pFile) {
+		if (error)
+			*error = "Cannot write " + path;
+		return false;
+	}
+	bool xWritten = std::fwrite(&header, sizeof(header), 1, pFile) == 1 &&
+		std::fwrite(records.data(), sizeof(CatalogRecord), records.size(), pFile) == records.size() &&
+		std::fwrite(outerIndex.data(), sizeof(uint32_t), outerIndex.size(), pFile) == outerIndex.size() &&
+		std::fwrite(widthIndex.data(), sizeof(uint32_t), widthIndex.size(), pFile) == widthIndex.size();
+	if (std::fclose(pFile) != 0)
+		xWritten = false;
+	if (!xWritten && error)
+		*error = "Writing " + path + " failed";
+	return xWritten;
+}
+
+BearingCatalog::BearingCatalog()
+	: mpData(nullptr), miSize(0), mpRecords(nullptr), mpOuterIndex(nullptr), mpWidthIndex(nullptr), miCount(0),
+#ifdef _WIN32
+	mpFile(INVALID_HANDLE_VALUE), mpMapping(nullptr)
+#else
+	miFile(-1)
+#endif
+{
+}
+
+BearingCatalog::~BearingCatalog()
+{
+	close();
+}
+
+bool BearingCatalog::open(const std::string &path, std::string *error)
+{
+	close();
+
+#ifdef _WIN32
+	mpFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER fileSize;
+	if (mpFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(mpFile, &fileSize)) {
+		if (error)
+			*error = "Cannot open " + path;
+		close();
+		return false;
+	}
+	miSize = (size_t)fileSize.QuadPart;
+	if (miSize >= sizeof(CatalogHeader)) {
+		mpMapping = CreateFileMappingA(mpFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mpMapping)
+			mpData = (const unsigned char *)MapViewOfFile(mpMapping, FILE_MAP_READ, 0, 0, 0);
+	}
+#else
+	miFile = ::open(path.c_str(), O_RDONLY);
+	struct stat status;
+	if (miFile < 0 || fstat(miFile, &status) != 0) {
+		if (error)
+			*error = "Cannot open " + path;
+		close();
+		return false;
+	}
+	miSize = (size_t)status.st_size;
+	if (miSize >= sizeof(CatalogHeader)) {
+		void *pMapped = mmap(nullptr, miSize, PROT_READ, MAP_SHARED, miFile, 0);
+		if (pMapped != MAP_FAILED)
+			mpData = (const unsigned char *)pMapped;
+	}
+#endif
+
+	if (!mpData) {
+		if (error)
+			*error = path + " is no bearing catalog";
+		close();
+		return false;
+	}
+
+	const CatalogHeader *pHeader = (const CatalogHeader *)mpData;
+	bool xValid = isLittleEndian() &&
+		std::memcmp(pHeader->magic, kCatalogMagic, sizeof(kCatalogMagic)) == 0 &&
+		pHeader->iVersion == kCatalogVersion &&
+		pHeader->iRecordSize == sizeof(CatalogRecord) &&
+		pHeader->iRecordOffset % alignof(CatalogRecord) == 0 &&
+		pHeader->iOuterIndexOffset % alignof(uint32_t) == 0 &&
+		pHeader->iWidthIndexOffset % alignof(uint32_t) == 0 &&
+		pHeader->iRecordCount <= miSize / sizeof(CatalogRecord) &&
+		pHeader->iRecordOffset <= miSize && pHeader->iOuterIndexOffset <= miSize && pHeader->iWidthIndexOffset <= miSize &&
+		pHeader->iRecordOffset + pHeader->iRecordCount * sizeof(CatalogRecord) <= miSize &&
+		pHeader->iOuterIndexOffset + pHeader->iRecordCount * sizeof(uint32_t) <= miSize &&
+		pHeader->iWidthIndexOffset + pHeader->iRecordCount * sizeof(uint32_t) <= miSize;
+	if (!xValid) {
+		if (error)
+			*error = path + " is no bearing catalog of version " + std::to_string(kCatalogVersion);
+		close();
+		return false;
+	}
+
+	miCount = (size_t)pHeader->iRecordCount;
+	mpRecords = (const CatalogRecord *)(mpData + pHeader->iRecordOffset);
+	mpOuterIndex = (const uint32_t *)(mpData + pHeader->iOuterIndexOffset);
+	mpWidthIndex = (const uint32_t *)(mpData + pHeader->iWidthIndexOffset);
+	if (!validIndex(mpOuterIndex, miCount) || !validIndex(mpWidthIndex, miCount)) {
+		if (error)
+			*error = path + " has a broken index";
+		close();
+		return false;
+	}
+	return true;
+}
+
+void BearingCatalog::close()
+{
+#ifdef _WIN32
+	if (mpData)
+		UnmapViewOfFile(mpData);
+	if (mpMapping)
+		CloseHandle(mpMapping);
+	if (mpFile != INVALID_HANDLE_VALUE)
+		CloseHandle(mpFile);
+	mpMapping = nullptr;
+	mpFile = INVALID_HANDLE_VALUE;
+#else
+	if (mpData)
+		munmap((void *)mpData, miSize);
+	if (miFile >= 0)
+		::close(miFile);
+	miFile = -1;
+#endif
+	mpData = nullptr;
+	miSize = 0;
+	mpRecords = nullptr;
+	mpOuterIndex = nullptr;
+	mpWidthIndex = nullptr;
+	miCount = 0;
+}
+
+std::string BearingCatalog::units() const
+{
+	if (!mpData)
+		return std::string();
+	const CatalogHeader *pHeader = (const CatalogHeader *)mpData;
+	return std::string(pHeader->units, strnlen(pHeader->units, sizeof(pHeader->units)));
+}
+
+const CatalogRecord *BearingCatalog::find(double innerDiameter, double outerDiameter, double thickness, double tolerance) const
+{
+	const CatalogRecord *pEnd = mpRecords + miCount;
+	const CatalogRecord *pRecord = std::lower_bound(mpRecords, pEnd, innerDiameter - tolerance,
+		[](const CatalogRecord &record, double bore) { return record.dInnerDiameter < bore; });
+	for (; pRecord != pEnd && pRecord->dInnerDiameter <= innerDiameter + tolerance; ++pRecord) {
+		if (std::fabs(pRecord->dOuterDiameter - outerDiameter) <= tolerance && std::fabs(pRecord->dThickness - thickness) <= tolerance)
+			return pRecord;
+	}
+	return nullptr;
+}
+
+void BearingCatalog::findByBore(double minimum, double maximum, std::vector<const CatalogRecord *> *records) const
+{
+	records->clear();
+	const CatalogRecord *pEnd = mpRecords + miCount;
+	const CatalogRecord *pRecord = std::lower_bound(mpRecords, pEnd, minimum,
+		[](const CatalogRecord &record, double bore) { return record.dInnerDiameter < bore; });
+	for (; pRecord != pEnd && pRecord->dInnerDiameter <= maximum; ++pRecord)
+		records->push_back(pRecord);
+}
+
+void BearingCatalog::findByOuterDiameter(double minimum, double maximum, std::vector<const CatalogRecord *> *records) const
+{
+	records->clear();
+	const uint32_t *pEnd = mpOuterIndex + miCount;
+	const uint32_t *pIndex = std::lower_bound(mpOuterIndex, pEnd, minimum,
+		[&](uint32_t index, double outer) { return mpRecords[index].dOuterDiameter < outer; });
+	for (; pIndex != pEnd && mpRecords[*pIndex].dOuterDiameter <= maximum; ++pIndex)
+		records->push_back(mpRecords + *pIndex);
+}
+
+void BearingCatalog::findByThickness(double minimum, double maximum, std::vector<const CatalogRecord *> *records) const
+{
+	records->clear();
+	const uint32_t *pEnd = mpWidthIndex + miCount;
+	const uint32_t *pIndex = std::lower_bound(mpWidthIndex, pEnd, minimum,
+		[&](uint32_t index, double width) { return mpRecords[index].dThickness < width; });
+	for (; pIndex != pEnd && mpRecords[*pIndex].dThickness <= maximum; ++pIndex)
+		records->push_back(mpRecords + *pIndex);
+}
+
+bool readBearingCatalogSpecs(const std::string &path, const std::string &units, std::vector<BearingSpec> *specs, std::string *error)
+{
+	BearingCatalog catalog;
+	if (!catalog.open(path, error))
+		return false;
+	double dCatalogMillimetres = unitsToMillimetres(catalog.units());
+	double dMillimetres = unitsToMillimetres(units);
+	if (dCatalogMillimetres <= 0.0 || dMillimetres <= 0.0) {
+		if (error)
+			*error = path + " holds sizes in '" + catalog.units() + "', which cannot be converted to '" + units + "'";
+		return false;
+	}
+
+	double dScale = dCatalogMillimetres / dMillimetres;
+	specs->reserve(specs->size() + catalog.size());
+	for (size_t i = 0; i < catalog.size(); ++i) {
+		const CatalogRecord &record = catalog.record(i);
+		specs->push_back({ record.dInnerDiameter * dScale, record.dOuterDiameter * dScale, record.dThickness * dScale });
+	}
+	return true;
+}
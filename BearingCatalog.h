@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BearingBatch.h"
+#include "BearingGeometry.h"
+
+// Binary catalog of bearing sizes, like the table of a standard bearing series.
+//
+// The file starts with a CatalogHeader, followed by the records sorted by bore,
+// outer diameter and width, an index of record numbers sorted by outer
+// diameter, bore and width and one sorted by width, bore and outer diameter.
+// All values are little endian. Records have a fixed
+// size, so the file is used in place through a read only memory mapping and a
+// lookup is a binary search without parsing or copying anything.
+
+const uint32_t kCatalogVersion = 2;
+
+struct CatalogHeader
+{
+	// "BBCAT" followed by zeros.
+	char magic[8];
+	uint32_t iVersion;
+	uint32_t iRecordSize;
+	uint64_t iRecordCount;
+	// Byte offsets of the records and of the outer diameter and width indexes.
+	uint64_t iRecordOffset;
+	uint64_t iOuterIndexOffset;
+	uint64_t iWidthIndexOffset;
+	// Units of all lengths, like "mm".
+	char units[8];
+};
+
+// One bearing with its derived geometry after validation.
+struct CatalogRecord
+{
+	double dInnerDiameter;
+	double dOuterDiameter;
+	double dThickness;
+	double dBallRadius;
+	double dRingWidth;
+	double dPitchRadius;
+	double dFilletRadius;
+	int32_t iBallCount;
+	// Series designation like "6204", zero terminated.
+	char designation[20];
+};
+
+static_assert(sizeof(CatalogHeader) == 56, "The catalog header layout is part of the file format.");
+static_assert(sizeof(CatalogRecord) == 80, "The catalog record layout is part of the file format.");
+
+// Fills the record from a bearing that passed validation.
+void makeCatalogRecord(const BearingGeometry &geometry, const std::string &designation, CatalogRecord *record);
+
+// Sorts the records, builds the index and writes the catalog.
+bool writeBearingCatalog(const std::string &path, const std::string &units, std::vector<CatalogRecord> records, std::string *error);
+
+// Read only view of a catalog file.
+class BearingCatalog
+{
+public:
+	BearingCatalog();
+	~BearingCatalog();
+
+	// Maps the file and checks its header.
+	bool open(const std::string &path, std::string *error);
+	void close();
+
+	bool isOpen() const { return mpData != nullptr; }
+	size_t size() const { return miCount; }
+	std::string units() const;
+	// Records in bore order, they point into the mapping and stay valid until close.
+	const CatalogRecord &record(size_t index) const { return mpRecords[index]; }
+
+	// The record with the given sizes, nullptr if there is none. Sizes that
+	// differ by less than the tolerance count as equal.
+	const CatalogRecord *find(double innerDiameter, double outerDiameter, double thickness, double tolerance = 1.0e-6) const;
+	// Records with a bore, outer diameter or width in [minimum, maximum], in ascending order.
+	void findByBore(double minimum, double maximum, std::vector<const CatalogRecord *> *records) const;
+	void findByOuterDiameter(double minimum, double maximum, std::vector<const CatalogRecord *> *records) const;
+	void findByThickness(double minimum, double maximum, std::vector<const CatalogRecord *> *records) const;
+
+private:
+	BearingCatalog(const BearingCatalog &) = delete;
+	BearingCatalog &operator=(const BearingCatalog &) = delete;
+
+	const unsigned char *mpData;
+	size_t miSize;
+	const CatalogRecord *mpRecords;
+	const uint32_t *mpOuterIndex;
+	const uint32_t *mpWidthIndex;
+	size_t miCount;
+#ifdef _WIN32
+	void *mpFile;
+	void *mpMapping;
+#else
+	int miFile;
+#endif
+};
+
+// Reads all sizes of a catalog as a bearing list for the batch tools, converted
+// from the units of the catalog to the given units (mm, cm, m, in or ft).
+bool readBearingCatalogSpecs(const std::string &path, const std::string &units, std::vector<BearingSpec> *specs, std::string *error);
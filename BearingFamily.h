@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cmath>
+
+#include "BearingGeometry.h"
+
+// Sizing rules of the bearing families. A family is a layout struct of static
+// inline functions, and computeFamilyGeometry is instantiated once per layout,
+// so the rules of a family are compiled into its own generator without any
+// runtime dispatch. The resulting BearingGeometry drives the Fusion build, the
+// validation and the tessellation alike.
+//
+// A layout provides:
+//   kFamily, kRows                    family and number of ball rows
+//   rowWidth(thickness)               axial room for the balls of one row
+//   rowHeight(row, thickness)         axial position of the ball centres of a row
+//   contactAngle()                    in radians
+//   layoutRings(geometry)             ring width, fillet and both ring profiles
+//   layoutCounterbores(geometry)      lowered shoulders, if any
+//   kElement, layoutRoller(geometry)  rolling element and the roller, if any
+//   layoutCage(geometry)              band of the cage around the rolling elements
+
+// Inner and outer ring side by side around the balls, shared by the radial families.
+struct RadialLayout
+{
+	static const RollingElement kElement = BallElement;
+
+	static double rowWidth(double thickness) { return thickness; }
+	static double rowHeight(int, double) { return 0.0; }
+	static double contactAngle() { return 0.0; }
+
+	static void layoutRings(BearingGeometry *geometry)
+	{
+		double dInnerDiameter = geometry->dInnerDiameter;
+		double dOuterDiameter = geometry->dOuterDiameter;
+		double dThickness = geometry->dThickness;
+
+		geometry->dRingWidth = (dOuterDiameter - dInnerDiameter) * 0.25 - geometry->dBallRadius * 0.5;
+		geometry->dFilletRadius = geometry->dRingWidth * 0.1;
+
+		geometry->innerRing.dRadiusMin = dInnerDiameter * 0.5;
+		geometry->innerRing.dRadiusMax = dInnerDiameter * 0.5 + geometry->dRingWidth;
+		geometry->innerRing.dHalfThickness = dThickness * 0.5;
+		geometry->innerRing.dCenterHeight = 0.0;
+
+		geometry->outerRing.dRadiusMin = dOuterDiameter * 0.5 - geometry->dRingWidth;
+		geometry->outerRing.dRadiusMax = dOuterDiameter * 0.5;
+		geometry->outerRing.dHalfThickness = dThickness * 0.5;
+		geometry->outerRing.dCenterHeight = 0.0;
+	}
+
+	static void layoutCounterbores(BearingGeometry *geometry)
+	{
+		geometry->innerCounterbore = RingProfile{ 0.0, 0.0, 0.0, 0.0 };
+		geometry->outerCounterbore = RingProfile{ 0.0, 0.0, 0.0, 0.0 };
+	}
+
+	static void layoutRoller(BearingGeometry *geometry)
+	{
+		geometry->roller = RollerProfile{ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+	}
+
+	// The band fills the middle half of the gap between the rings and reaches
+	// past all rows far enough to close around the pockets, tilted rollers included.
+	static void layoutCage(BearingGeometry *geometry)
+	{
+		double dGap = geometry->outerRing.dRadiusMin - geometry->innerRing.dRadiusMax;
+		double dReach = geometry->dBallRadius * 1.4;
+		double dLow = std::fmax(geometry->rowHeights[0] - dReach, -geometry->dThickness * 0.5);
+		double dHigh = std::fmin(geometry->rowHeights[geometry->iRowCount - 1] + dReach, geometry->dThickness * 0.5);
+		geometry->cage.band = RingProfile{ geometry->innerRing.dRadiusMax + dGap * 0.25, geometry->outerRing.dRadiusMin - dGap * 0.25,
+			(dHigh - dLow) * 0.5, (dHigh + dLow) * 0.5 };
+		geometry->cage.dPocketClearance = geometry->dBallRadius * 0.05;
+	}
+};
+
+// Single row deep groove ball bearing.
+struct DeepGrooveLayout : RadialLayout
+{
+	static const BearingFamily kFamily = DeepGrooveBearing;
+	static const int kRows = 1;
+};
+
+// Two rows of balls side by side, each in its own groove of both rings.
+struct DoubleRowLayout : RadialLayout
+{
+	static const BearingFamily kFamily = DoubleRowBearing;
+	static const int kRows = 2;
+
+	static double rowWidth(double thickness) { return thickness * 0.5; }
+	static double rowHeight(int row, double thickness) { return row == 0 ? -thickness * 0.25 : thickness * 0.25; }
+};
+
+// Single row angular contact ball bearing with a 40 degree contact angle. The
+// outer ring shoulder is lowered on the upper side and the inner ring shoulder
+// on the lower one, so the balls carry axial load in one direction.
+struct AngularContactLayout : RadialLayout
+{
+	static const BearingFamily kFamily = AngularContactBearing;
+	static const int kRows = 1;
+
+	static double contactAngle() { return 40.0 * 3.14159265358979323846 / 180.0; }
+
+	static void layoutCounterbores(BearingGeometry *geometry)
+	{
+		// The lowered shoulder ends where the ball surface is at the contact angle.
+		double dShoulder = geometry->dBallRadius * std::cos(contactAngle());
+		double dQuarter = geometry->dThickness * 0.25;
+		geometry->innerCounterbore = RingProfile{ geometry->dPitchRadius - dShoulder, geometry->innerRing.dRadiusMax, dQuarter, -dQuarter };
+		geometry->outerCounterbore = RingProfile{ geometry->outerRing.dRadiusMin, geometry->dPitchRadius + dShoulder, dQuarter, dQuarter };
+	}
+};
+
+// Single direction thrust ball bearing. The inner ring is the shaft washer
+// below the balls, the outer ring the housing washer above them. Both washers
+// span the full radial width, less a small clearance at the side where the
+// other washer sits on the shaft or in the housing.
+struct ThrustLayout
+{
+	static const BearingFamily kFamily = ThrustBearing;
+	static const int kRows = 1;
+	static const RollingElement kElement = BallElement;
+
+	static double rowWidth(double thickness) { return thickness; }
+	static double rowHeight(int, double) { return 0.0; }
+	static double contactAngle() { return 3.14159265358979323846 * 0.5; }
+
+	static void layoutRings(BearingGeometry *geometry)
+	{
+		double dInnerRadius = geometry->dInnerDiameter * 0.5;
+		double dOuterRadius = geometry->dOuterDiameter * 0.5;
+		double dClearance = (geometry->dOuterDiameter - geometry->dInnerDiameter) * 0.025;
+		// The washers are one ball radius apart, so each raceway is half a ball radius deep.
+		double dWasherHalf = (geometry->dThickness - geometry->dBallRadius) * 0.25;
+		double dWasherCenter = geometry->dBallRadius * 0.5 + dWasherHalf;
+
+		geometry->dRingWidth = dOuterRadius - dInnerRadius - dClearance;
+		geometry->dFilletRadius = std::fmin(geometry->dRingWidth, dWasherHalf * 2.0) * 0.1;
+		geometry->innerRing = RingProfile{ dInnerRadius, dOuterRadius - dClearance, dWasherHalf, -dWasherCenter };
+		geometry->outerRing = RingProfile{ dInnerRadius + dClearance, dOuterRadius, dWasherHalf, dWasherCenter };
+	}
+
+	static void layoutCounterbores(BearingGeometry *geometry)
+	{
+		RadialLayout::layoutCounterbores(geometry);
+	}
+
+	static void layoutRoller(BearingGeometry *geometry)
+	{
+		RadialLayout::layoutRoller(geometry);
+	}
+
+	// A flat disc in the middle of the gap between the washers.
+	static void layoutCage(BearingGeometry *geometry)
+	{
+		double dReach = geometry->dBallRadius * 1.4;
+		geometry->cage.band = RingProfile{ geometry->dPitchRadius - dReach, geometry->dPitchRadius + dReach, geometry->dBallRadius * 0.25, 0.0 };
+		geometry->cage.dPocketClearance = geometry->dBallRadius * 0.05;
+	}
+};
+
+// Single row cylindrical roller bearing with ribs on both rings. The rollers
+// are as long as they are thick and sit in a groove of half their radius in
+// each ring, in place of the ball raceway.
+struct CylindricalRollerLayout : RadialLayout
+{
+	static const BearingFamily kFamily = CylindricalRollerBearing;
+	static const int kRows = 1;
+	static const RollingElement kElement = CylindricalRollerElement;
+
+	static void layoutRoller(BearingGeometry *geometry)
+	{
+		double dRadius = geometry->dBallRadius;
+		geometry->roller = RollerProfile{ geometry->dPitchRadius, 0.0, dRadius * 2.0, dRadius, 0.0, 0.0 };
+	}
+};
+
+// Single row tapered roller bearing. The rollers are tilted by 15 degrees and
+// tapered so that their cones meet on the bearing axis.
+struct TaperedRollerLayout : RadialLayout
+{
+	static const BearingFamily kFamily = TaperedRollerBearing;
+	static const int kRows = 1;
+	static const RollingElement kElement = TaperedRollerElement;
+
+	static double contactAngle() { return 15.0 * 3.14159265358979323846 / 180.0; }
+
+	static void layoutRoller(BearingGeometry *geometry)
+	{
+		double dRadius = geometry->dBallRadius;
+		double dTaper = std::atan(dRadius * std::sin(contactAngle()) / geometry->dPitchRadius);
+		geometry->roller = RollerProfile{ geometry->dPitchRadius, 0.0, dRadius * 2.0, dRadius, contactAngle(), dTaper };
+	}
+};
+
+template <class Layout>
+bool computeFamilyGeometry(double innerDiameter, double outerDiameter, double thickness, BearingGeometry *geometry)
+{
+	if (!geometry)
+		return false;
+	// Written as a positive test, so NaN and infinite sizes fail it too.
+	if (!(std::isfinite(innerDiameter) && std::isfinite(outerDiameter) && std::isfinite(thickness) &&
+		innerDiameter >= 0.0 && innerDiameter < outerDiameter && thickness > 0.0))
+		return false;
+
+	geometry->eFamily = Layout::kFamily;
+	geometry->eElement = Layout::kElement;
+	geometry->dInnerDiameter = innerDiameter;
+	geometry->dOuterDiameter = outerDiameter;
+	geometry->dThickness = thickness;
+
+	// The ball is limited by the axial room of its row and by the gap between the diameters.
+	double dBallRadius = Layout::rowWidth(thickness) * 0.6;
+	if (dBallRadius > ((outerDiameter - innerDiameter) * 0.5 * 0.6)) {
+		dBallRadius = (outerDiameter - innerDiameter) * 0.5 * 0.6;
+	}
+	dBallRadius *= 0.5;
+
+	geometry->dBallRadius = dBallRadius;
+	geometry->dPitchRadius = (outerDiameter + innerDiameter) * 0.5 * 0.5;
+	geometry->iBallCount = computeBallCount(geometry->dPitchRadius, dBallRadius);
+
+	geometry->iRowCount = Layout::kRows;
+	for (int i = 0; i < kMaxBallRows; ++i)
+		geometry->rowHeights[i] = i < Layout::kRows ? Layout::rowHeight(i, thickness) : 0.0;
+	geometry->dContactAngle = Layout::contactAngle();
+
+	Layout::layoutRings(geometry);
+	Layout::layoutCounterbores(geometry);
+	Layout::layoutRoller(geometry);
+	Layout::layoutCage(geometry);
+
+	geometry->raceway.dCenterRadius = geometry->dPitchRadius;
+	geometry->raceway.dCenterHeight = geometry->rowHeights[0];
+	geometry->raceway.dRadius = dBallRadius;
+
+	return true;
+}
@@ -0,0 +1,140 @@
+#include "BearingGeometry.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "BearingFamily.h"
+
+int computeBallCount(double pitchRadius, double ballRadius)
+{
+	// Casting NaN or a value beyond the int range is undefined, such balls do not fit.
+	double dCount = 2.0 * 3.141592 * pitchRadius / (ballRadius * 2.0);
+	if (!(dCount >= 0.0 && dCount < 2147483647.0))
+		return 0;
+	return (int)dCount - 1;
+}
+
+bool computeBearingGeometry(double innerDiameter, double outerDiameter, double thickness, BearingGeometry *geometry)
+{
+	return computeFamilyGeometry<DeepGrooveLayout>(innerDiameter, outerDiameter, thickness, geometry);
+}
+
+bool computeBearingGeometry(BearingFamily family, double innerDiameter, double outerDiameter, double thickness, BearingGeometry *geometry)
+{
+	switch (family) {
+	case DeepGrooveBearing:
+		return computeFamilyGeometry<DeepGrooveLayout>(innerDiameter, outerDiameter, thickness, geometry);
+	case DoubleRowBearing:
+		return computeFamilyGeometry<DoubleRowLayout>(innerDiameter, outerDiameter, thickness, geometry);
+	case AngularContactBearing:
+		return computeFamilyGeometry<AngularContactLayout>(innerDiameter, outerDiameter, thickness, geometry);
+	case ThrustBearing:
+		return computeFamilyGeometry<ThrustLayout>(innerDiameter, outerDiameter, thickness, geometry);
+	case CylindricalRollerBearing:
+		return computeFamilyGeometry<CylindricalRollerLayout>(innerDiameter, outerDiameter, thickness, geometry);
+	case TaperedRollerBearing:
+		return computeFamilyGeometry<TaperedRollerLayout>(innerDiameter, outerDiameter, thickness, geometry);
+	}
+	return false;
+}
+
+RacewayCircle rowRaceway(const BearingGeometry &geometry, int row)
+{
+	RacewayCircle raceway = geometry.raceway;
+	raceway.dCenterHeight += geometry.rowHeights[row] - geometry.rowHeights[0];
+	return raceway;
+}
+
+RacewayCircle cageBallPocket(const BearingGeometry &geometry, int row)
+{
+	return RacewayCircle{ geometry.dPitchRadius, geometry.rowHeights[row], geometry.dBallRadius + geometry.cage.dPocketClearance };
+}
+
+RollerProfile cageRollerPocket(const BearingGeometry &geometry)
+{
+	RollerProfile pocket = geometry.roller;
+	pocket.dLength += geometry.cage.dPocketClearance * 2.0;
+	pocket.dRadius += geometry.cage.dPocketClearance;
+	return pocket;
+}
+
+void rollerEnds(const RollerProfile &roller, double endsR[2], double endsZ[2], double radii[2])
+{
+	// Along the axis towards the small end.
+	double dAxisR = -std::sin(roller.dAxisAngle);
+	double dAxisZ = std::cos(roller.dAxisAngle);
+	double dHalf = roller.dLength * 0.5;
+	double dTaper = dHalf * std::tan(roller.dTaperAngle);
+	endsR[0] = roller.dCenterRadius - dAxisR * dHalf;
+	endsZ[0] = roller.dCenterHeight - dAxisZ * dHalf;
+	radii[0] = roller.dRadius + dTaper;
+	endsR[1] = roller.dCenterRadius + dAxisR * dHalf;
+	endsZ[1] = roller.dCenterHeight + dAxisZ * dHalf;
+	radii[1] = roller.dRadius - dTaper;
+}
+
+void rollerCorners(const RollerProfile &roller, double cornersR[4], double cornersZ[4])
+{
+	double endsR[2], endsZ[2], radii[2];
+	rollerEnds(roller, endsR, endsZ, radii);
+	// Perpendicular to the axis, away from the bearing axis.
+	double dNormalR = std::cos(roller.dAxisAngle);
+	double dNormalZ = std::sin(roller.dAxisAngle);
+	cornersR[0] = endsR[0] - dNormalR * radii[0];
+	cornersZ[0] = endsZ[0] - dNormalZ * radii[0];
+	cornersR[1] = endsR[0] + dNormalR * radii[0];
+	cornersZ[1] = endsZ[0] + dNormalZ * radii[0];
+	cornersR[2] = endsR[1] + dNormalR * radii[1];
+	cornersZ[2] = endsZ[1] + dNormalZ * radii[1];
+	cornersR[3] = endsR[1] - dNormalR * radii[1];
+	cornersZ[3] = endsZ[1] - dNormalZ * radii[1];
+}
+
+bool hasCounterbore(const RingProfile &counterbore)
+{
+	return counterbore.dHalfThickness > 0.0 && counterbore.dRadiusMax > counterbore.dRadiusMin;
+}
+
+static const char *kFamilyNames[] = { "deep-groove", "double-row", "angular-contact", "thrust", "cylindrical-roller", "tapered-roller" };
+
+const char *bearingFamilyName(BearingFamily family)
+{
+	return kFamilyNames[family];
+}
+
+bool parseBearingFamily(const std::string &name, BearingFamily *family)
+{
+	for (int i = 0; i < (int)(sizeof(kFamilyNames) / sizeof(kFamilyNames[0])); ++i) {
+		if (name == kFamilyNames[i]) {
+			*family = (BearingFamily)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+std::string bearingCacheKey(double innerDiameter, double outerDiameter, double thickness, const std::string &variant)
+{
+	// Quantize to a micro unit and hash with FNV-1a.
+	long long iValues[3] = {
+		std::llround(innerDiameter * 1.0e6),
+		std::llround(outerDiameter * 1.0e6),
+		std::llround(thickness * 1.0e6)
+	};
+
+	uint64_t iHash = 14695981039346656037ull;
+	const unsigned char *pBytes = (const unsigned char *)iValues;
+	for (size_t i = 0; i < sizeof(iValues); ++i) {
+		iHash ^= pBytes[i];
+		iHash *= 1099511628211ull;
+	}
+	for (char c : variant) {
+		iHash ^= (unsigned char)c;
+		iHash *= 1099511628211ull;
+	}
+
+	char buffer[17];
+	std::snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)iHash);
+	return buffer;
+}
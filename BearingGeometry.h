@@ -0,0 +1,146 @@
+#pragma once
+
+#include <string>
+
+// Fusion independent bearing sizing. Everything in here is plain C++ so that
+// it can be used both by the add-in and by the command line tools.
+// All lengths are in the units of the inputs (Fusion internal units are cm).
+
+// Rectangular ring cross section in sketch coordinates, x is the radial
+// direction and y the axial one.
+struct RingProfile
+{
+	double dRadiusMin;
+	double dRadiusMax;
+	double dHalfThickness;
+	// Axial position of the centre, only the washers of thrust bearings are off the middle plane.
+	double dCenterHeight;
+};
+
+// Circle that is revolved around the bearing axis to cut the raceway.
+struct RacewayCircle
+{
+	double dCenterRadius;
+	double dCenterHeight;
+	double dRadius;
+};
+
+// Roller as a truncated cone around its own axis. The axis lies in the XZ plane
+// and is tilted from the bearing axis by dAxisAngle, with the small end up in
+// the sketch and towards the bearing axis. The cone of a tapered roller has its
+// apex on the bearing axis, so it rolls without sliding. Cylindrical rollers
+// have no tilt and no taper.
+struct RollerProfile
+{
+	double dCenterRadius;
+	double dCenterHeight;
+	double dLength;
+	// Radius in the middle of the roller.
+	double dRadius;
+	double dAxisAngle;
+	// Half angle of the cone.
+	double dTaperAngle;
+};
+
+// Cage that keeps the rolling elements apart: a band of revolution with a pocket
+// around every element. The pockets are the elements grown by the clearance.
+struct CageProfile
+{
+	RingProfile band;
+	double dPocketClearance;
+};
+
+// Centres of the end faces of a roller in sketch coordinates and their radii, the large end first.
+void rollerEnds(const RollerProfile &roller, double endsR[2], double endsZ[2], double radii[2]);
+// Corners of the full cross section of a roller, counter clockwise, starting at the large end next to the axis.
+void rollerCorners(const RollerProfile &roller, double cornersR[4], double cornersZ[4]);
+
+// The build sketches the cross sections on the XZ plane of the component, where
+// the sketch height runs along -Z. Everything built from the sketch coordinates
+// above without a sketch, the bodies, meshes and STEP solids, turns them into
+// model coordinates with this, so that all of them give the same bearing.
+inline double modelHeight(double sketchHeight) { return -sketchHeight; }
+
+// Bearing types the generator knows, see BearingFamily.h for their sizing rules.
+enum BearingFamily
+{
+	DeepGrooveBearing,
+	DoubleRowBearing,
+	AngularContactBearing,
+	ThrustBearing,
+	CylindricalRollerBearing,
+	TaperedRollerBearing
+};
+
+enum RollingElement
+{
+	BallElement,
+	CylindricalRollerElement,
+	TaperedRollerElement
+};
+
+const int kMaxBallRows = 2;
+
+// Full parametric description of a bearing. The inner ring is the shaft
+// washer and the outer ring the housing washer of a thrust bearing.
+struct BearingGeometry
+{
+	BearingFamily eFamily;
+	RollingElement eElement;
+	double dInnerDiameter;
+	double dOuterDiameter;
+	double dThickness;
+
+	// Radius of the balls, or of the rollers in their middle.
+	double dBallRadius;
+	double dRingWidth;
+	double dPitchRadius;
+	double dFilletRadius;
+	// Balls per row.
+	int iBallCount;
+
+	// Rows of balls on the pitch circle, at these heights along the axis.
+	int iRowCount;
+	double rowHeights[kMaxBallRows];
+	// Angle between the line through the ball contacts and the radial plane in
+	// radians, 0 for radial bearings and pi/2 for thrust bearings.
+	double dContactAngle;
+
+	RingProfile innerRing;
+	RingProfile outerRing;
+	// Cuts that lower one shoulder of a ring of an angular contact bearing,
+	// dHalfThickness is 0 where there is none.
+	RingProfile innerCounterbore;
+	RingProfile outerCounterbore;
+	// Raceway of the first row, the raceways of the other rows are the same circle at their heights.
+	RacewayCircle raceway;
+	// Roller of roller bearings, its cross section is also the raceway cut.
+	RollerProfile roller;
+	// Built only on request, the band has no thickness if the family has no cage.
+	CageProfile cage;
+};
+
+// Raceway circle of one row.
+RacewayCircle rowRaceway(const BearingGeometry &geometry, int row);
+bool hasCounterbore(const RingProfile &counterbore);
+// Pocket of the cage around the balls of one row, or around the rollers.
+RacewayCircle cageBallPocket(const BearingGeometry &geometry, int row);
+RollerProfile cageRollerPocket(const BearingGeometry &geometry);
+const char *bearingFamilyName(BearingFamily family);
+// Parses the names returned by bearingFamilyName, false if the name is unknown.
+bool parseBearingFamily(const std::string &name, BearingFamily *family);
+
+// Number of balls that fit on the pitch circle. Rollers of the same radius fit
+// as often, tapered rollers too, since their size grows with the distance from the axis.
+int computeBallCount(double pitchRadius, double ballRadius);
+
+// Derives all dimensions of the bearing from its main sizes.
+// Returns false if the sizes do not describe a bearing.
+bool computeBearingGeometry(double innerDiameter, double outerDiameter, double thickness, BearingGeometry *geometry);
+// The same for a bearing of the given family, the one above builds deep groove bearings.
+bool computeBearingGeometry(BearingFamily family, double innerDiameter, double outerDiameter, double thickness, BearingGeometry *geometry);
+
+// Key that identifies a bearing size, the sizes are quantized so that values
+// that differ only by rounding noise map to the same key. The variant holds the
+// units and any build option that changes the result.
+std::string bearingCacheKey(double innerDiameter, double outerDiameter, double thickness, const std::string &variant);
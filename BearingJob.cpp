@@ -0,0 +1,166 @@
+#include "BearingJob.h"
+
+#include <utility>
+
+#include "BearingPlacement.h"
+
+bool sizeBearing(BearingFamily family, double innerDiameter, double outerDiameter, double thickness, double ballClearance,
+	BearingGeometry *geometry, BearingValidation *validation)
+{
+	if (!computeBearingGeometry(family, innerDiameter, outerDiameter, thickness, geometry)) {
+		validation->xValid = false;
+		validation->errors.assign(1, "The sizes do not describe a bearing.");
+		validation->corrections.clear();
+		return false;
+	}
+	if (ballClearance > 0.0)
+		geometry->iBallCount = computeBallCountWithClearance(geometry->dPitchRadius, geometry->dBallRadius, ballClearance);
+
+	return validateBearingGeometry(geometry, true, validation);
+}
+
+static void planBearing(size_t index, const BearingSpec &spec, const BearingJobSettings &settings, PlannedBearing *bearing)
+{
+	bearing->iIndex = index;
+	bearing->spec = spec;
+	bearing->xValid = sizeBearing(settings.eFamily, spec.dInnerDiameter * settings.dScale, spec.dOuterDiameter * settings.dScale,
+		spec.dThickness * settings.dScale, settings.dBallClearance, &bearing->geometry, &bearing->validation);
+	bearing->xHasProperties = bearing->xValid &&
+		computeBearingProperties(bearing->geometry, settings.dMillimetres, kBearingSteelDensity, &bearing->properties);
+	bearing->iUnplaced = 0;
+}
+
+BearingJobQueue::BearingJobQueue()
+	: mxActive(false), mxPlanned(false), mxCancelled(false), miTotal(0), miTaken(0)
+{
+}
+
+BearingJobQueue::~BearingJobQueue()
+{
+	reset();
+}
+
+void BearingJobQueue::begin(size_t total, const std::function<void()> &ready)
+{
+	mReady.clear();
+	mReadyCallback = ready;
+	mxPlanned = false;
+	mxCancelled = false;
+	miTotal = total;
+	miTaken = 0;
+	mxActive = true;
+}
+
+bool BearingJobQueue::startBatch(const std::vector<BearingSpec> &specs, const BearingJobSettings &settings, const std::function<void()> &ready)
+{
+	if (mxActive)
+		return false;
+	begin(specs.size(), ready);
+	mWorker = std::thread([this, specs, settings]() {
+		for (size_t i = 0; i < specs.size() && !mxCancelled; ++i) {
+			PlannedBearing bearing;
+			planBearing(i, specs[i], settings, &bearing);
+			push(std::move(bearing));
+		}
+		finishPlanning();
+	});
+	return true;
+}
+
+bool BearingJobQueue::startLayout(const std::vector<LayoutEntry> &entries, const BearingJobSettings &settings, const std::function<void()> &ready)
+{
+	if (mxActive)
+		return false;
+	begin(0, ready);
+	mWorker = std::thread([this, entries, settings]() {
+		std::vector<LayoutGroup> groups;
+		groupBearingLayout(entries, &groups);
+		miTotal = groups.size();
+
+		double cells[16];
+		for (size_t i = 0; i < groups.size() && !mxCancelled; ++i) {
+			const LayoutGroup &group = groups[i];
+			PlannedBearing bearing;
+			planBearing(group.entries.front(), group.spec, settings, &bearing);
+			for (size_t iEntry : group.entries) {
+				if (layoutTransform(entries[iEntry], settings.dScale, cells)) {
+					bearing.entries.push_back(iEntry);
+					bearing.transforms.insert(bearing.transforms.end(), cells, cells + 16);
+				}
+				else {
+					++bearing.iUnplaced;
+				}
+			}
+			push(std::move(bearing));
+		}
+		finishPlanning();
+	});
+	return true;
+}
+
+void BearingJobQueue::push(PlannedBearing &&bearing)
+{
+	bool xWasEmpty;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mxCancelled)
+			return;
+		xWasEmpty = mReady.empty();
+		mReady.push_back(std::move(bearing));
+	}
+	// Bearings added to a queue that is not empty are picked up by the builds already under way.
+	if (xWasEmpty && mReadyCallback)
+		mReadyCallback();
+}
+
+void BearingJobQueue::finishPlanning()
+{
+	mxPlanned = true;
+	if (mReadyCallback)
+		mReadyCallback();
+}
+
+bool BearingJobQueue::take(PlannedBearing *bearing)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (mxCancelled || mReady.empty())
+		return false;
+	*bearing = std::move(mReady.front());
+	mReady.pop_front();
+	++miTaken;
+	return true;
+}
+
+bool BearingJobQueue::hasReady() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return !mxCancelled && !mReady.empty();
+}
+
+bool BearingJobQueue::finished() const
+{
+	if (mxCancelled)
+		return true;
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mxPlanned && mReady.empty();
+}
+
+void BearingJobQueue::cancel()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mxCancelled = true;
+	mReady.clear();
+}
+
+void BearingJobQueue::reset()
+{
+	// A job that is still planning is stopped first.
+	if (!mxPlanned)
+		cancel();
+	if (mWorker.joinable())
+		mWorker.join();
+	std::lock_guard<std::mutex> lock(mMutex);
+	mReady.clear();
+	mReadyCallback = nullptr;
+	mxActive = false;
+}
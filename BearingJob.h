@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "BearingBatch.h"
+#include "BearingGeometry.h"
+#include "BearingLayout.h"
+#include "BearingProperties.h"
+#include "BearingValidation.h"
+
+// Sizes and validates a bearing like the dialog does: the rules of the family,
+// the ball count for the clearance (0 keeps the standard count) and the
+// corrections of the validation. False if the bearing cannot be built.
+bool sizeBearing(BearingFamily family, double innerDiameter, double outerDiameter, double thickness, double ballClearance,
+	BearingGeometry *geometry, BearingValidation *validation);
+
+// Settings of a job, copied from the dialog when the job starts.
+struct BearingJobSettings
+{
+	BearingFamily eFamily;
+	double dBallClearance;
+	// Factor from the units of the file to the units of the geometry.
+	double dScale;
+	// Millimetres per unit of the geometry, for the mass properties.
+	double dMillimetres;
+};
+
+// One bearing of a job, sized, validated and placed on the planning thread, so
+// that only the build is left.
+struct PlannedBearing
+{
+	// Row in the bearing list, or the first entry of the layout group.
+	size_t iIndex;
+	// Sizes as given in the file.
+	BearingSpec spec;
+	bool xValid;
+	BearingGeometry geometry;
+	BearingValidation validation;
+	bool xHasProperties;
+	BearingProperties properties;
+	// Layouts only: the entries placed from this bearing in file order and
+	// their row major transforms, 16 values each. Entries without a shaft axis
+	// are left out and only counted.
+	std::vector<size_t> entries;
+	std::vector<double> transforms;
+	size_t iUnplaced;
+};
+
+// Plans the bearings of a batch or layout job on a worker thread and hands
+// them to the thread that builds them, in file order. Planning needs no
+// Fusion, so it runs ahead while Fusion builds the bearings planned before.
+class BearingJobQueue
+{
+public:
+	BearingJobQueue();
+	~BearingJobQueue();
+
+	// Start planning a bearing list, or a layout grouped by size. Ready is
+	// called on the worker whenever planned bearings arrive in an empty queue
+	// and once more when the planning is done. False if a job is active.
+	bool startBatch(const std::vector<BearingSpec> &specs, const BearingJobSettings &settings, const std::function<void()> &ready);
+	bool startLayout(const std::vector<LayoutEntry> &entries, const BearingJobSettings &settings, const std::function<void()> &ready);
+
+	// Moves the next planned bearing to the caller, false if none is ready.
+	bool take(PlannedBearing *bearing);
+	bool hasReady() const;
+
+	// From the start of a job until it is reset.
+	bool active() const { return mxActive; }
+	// Everything planned and taken, or cancelled.
+	bool finished() const;
+	// Bearings of the job, layouts know it once they are grouped.
+	size_t total() const { return miTotal; }
+	size_t taken() const { return miTaken; }
+
+	// Stops the planning and drops the bearings that were not taken yet.
+	void cancel();
+	bool cancelled() const { return mxCancelled; }
+	// Waits for the worker and ends the job.
+	void reset();
+
+private:
+	BearingJobQueue(const BearingJobQueue &) = delete;
+	BearingJobQueue &operator=(const BearingJobQueue &) = delete;
+
+	void begin(size_t total, const std::function<void()> &ready);
+	void push(PlannedBearing &&bearing);
+	void finishPlanning();
+
+	std::thread mWorker;
+	mutable std::mutex mMutex;
+	std::deque<PlannedBearing> mReady;
+	std::function<void()> mReadyCallback;
+	std::atomic<bool> mxActive;
+	std::atomic<bool> mxPlanned;
+	std::atomic<bool> mxCancelled;
+	std::atomic<size_t> miTotal;
+	std::atomic<size_t> miTaken;
+};
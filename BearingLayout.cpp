@@ -0,0 +1,132 @@
+#include "BearingLayout.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+#include "BearingGeometry.h"
+
+bool readBearingLayout(const std::string &path, std::vector<LayoutEntry> *entries, std::string *error)
+{
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	if (!file) {
+		if (error)
+			*error = "Cannot open " + path;
+		return false;
+	}
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	return parseBearingLayoutCsv(buffer.str(), entries, error);
+}
+
+bool parseBearingLayoutCsv(const std::string &text, std::vector<LayoutEntry> *entries, std::string *error)
+{
+	std::istringstream stream(text);
+	std::string strLine;
+	int iLine = 0;
+	while (std::getline(stream, strLine)) {
+		++iLine;
+
+		// Treat ';', tabs and spaces like commas.
+		for (char &c : strLine) {
+			if (c == ';' || c == '\t' || c == '\r')
+				c = ',';
+		}
+
+		size_t iFirst = strLine.find_first_not_of(", ");
+		if (iFirst == std::string::npos || strLine[iFirst] == '#')
+			continue;
+
+		double dValues[9];
+		int iCount = 0;
+		const char *pCursor = strLine.c_str() + iFirst;
+		while (iCount < 9 && *pCursor) {
+			char *pEnd = nullptr;
+			double dValue = std::strtod(pCursor, &pEnd);
+			if (pEnd == pCursor)
+				break;
+			dValues[iCount++] = dValue;
+			pCursor = pEnd;
+			while (*pCursor == ',' || *pCursor == ' ')
+				++pCursor;
+		}
+
+		if (iCount == 0 && entries->empty())
+			continue; // header
+		if (iCount != 6 && iCount != 9) {
+			if (error)
+				*error = "Line " + std::to_string(iLine) + ": expected inner, outer, thickness, x, y, z and optionally the axis";
+			return false;
+		}
+		// strtod also reads "nan" and "inf".
+		for (int i = 0; i < iCount; ++i) {
+			if (!std::isfinite(dValues[i])) {
+				if (error)
+					*error = "Line " + std::to_string(iLine) + ": the values must be finite numbers";
+				return false;
+			}
+		}
+
+		LayoutEntry entry;
+		entry.spec = { dValues[0], dValues[1], dValues[2] };
+		for (int i = 0; i < 3; ++i) {
+			entry.position[i] = dValues[3 + i];
+			entry.axis[i] = iCount == 9 ? dValues[6 + i] : (i == 2 ? 1.0 : 0.0);
+		}
+		entries->push_back(entry);
+	}
+	return true;
+}
+
+void groupBearingLayout(const std::vector<LayoutEntry> &entries, std::vector<LayoutGroup> *groups)
+{
+	groups->clear();
+	std::unordered_map<std::string, size_t> groupIndex;
+	for (size_t i = 0; i < entries.size(); ++i) {
+		const BearingSpec &spec = entries[i].spec;
+		std::string strKey = bearingCacheKey(spec.dInnerDiameter, spec.dOuterDiameter, spec.dThickness, "");
+		std::unordered_map<std::string, size_t>::iterator it = groupIndex.find(strKey);
+		if (it == groupIndex.end()) {
+			it = groupIndex.emplace(strKey, groups->size()).first;
+			groups->push_back({ spec, std::vector<size_t>() });
+		}
+		(*groups)[it->second].entries.push_back(i);
+	}
+}
+
+bool layoutTransform(const LayoutEntry &entry, double scale, double matrix[16])
+{
+	double dLength = std::sqrt(entry.axis[0] * entry.axis[0] + entry.axis[1] * entry.axis[1] + entry.axis[2] * entry.axis[2]);
+	if (!(dLength > 0.0))
+		return false;
+	double z[3] = { entry.axis[0] / dLength, entry.axis[1] / dLength, entry.axis[2] / dLength };
+
+	// The new X axis is the world X, or the world Z for shafts close to X, made
+	// perpendicular to the shaft. A shaft along Z gives the identity rotation.
+	double x[3] = { 1.0, 0.0, 0.0 };
+	if (std::fabs(z[0]) > 0.9) {
+		x[0] = 0.0;
+		x[2] = 1.0;
+	}
+	double dDot = x[0] * z[0] + x[1] * z[1] + x[2] * z[2];
+	for (int i = 0; i < 3; ++i)
+		x[i] -= dDot * z[i];
+	double dXLength = std::sqrt(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]);
+	for (int i = 0; i < 3; ++i)
+		x[i] /= dXLength;
+	double y[3] = { z[1] * x[2] - z[2] * x[1], z[2] * x[0] - z[0] * x[2], z[0] * x[1] - z[1] * x[0] };
+
+	for (int i = 0; i < 3; ++i) {
+		matrix[i * 4 + 0] = x[i];
+		matrix[i * 4 + 1] = y[i];
+		matrix[i * 4 + 2] = z[i];
+		matrix[i * 4 + 3] = entry.position[i] * scale;
+	}
+	matrix[12] = 0.0;
+	matrix[13] = 0.0;
+	matrix[14] = 0.0;
+	matrix[15] = 1.0;
+	return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "BearingBatch.h"
+
+// One bearing of an assembly layout: its sizes and where it sits on its shaft.
+struct LayoutEntry
+{
+	BearingSpec spec;
+	// Centre of the bearing.
+	double position[3];
+	// Direction of the shaft, the bearing axis is turned onto it. Need not be of unit length.
+	double axis[3];
+};
+
+// Entries of the same size. The bearing is built once and placed at every entry.
+struct LayoutGroup
+{
+	BearingSpec spec;
+	// Indices into the layout, in file order.
+	std::vector<size_t> entries;
+};
+
+// Reads a layout from a CSV file with one
+// "inner,outer,thickness,x,y,z[,axisX,axisY,axisZ]" row per bearing. Without
+// the axis columns the shaft runs along Z. Header and '#' comment lines are
+// skipped like in bearing lists. Returns false and sets the error if the file
+// cannot be read or a row is incomplete.
+bool readBearingLayout(const std::string &path, std::vector<LayoutEntry> *entries, std::string *error);
+
+bool parseBearingLayoutCsv(const std::string &text, std::vector<LayoutEntry> *entries, std::string *error);
+
+// Groups the entries by their sizes, quantized like the cache key of a built
+// bearing, so sizes that only differ by rounding share one build. Groups are in
+// the order their first entry appears in the layout.
+void groupBearingLayout(const std::vector<LayoutEntry> &entries, std::vector<LayoutGroup> *groups);
+
+// Row major 4x4 transform that moves a bearing built around the Z axis at the
+// origin to the entry. The position is multiplied by the scale, the sizes are
+// not touched. Returns false if the axis has no length.
+bool layoutTransform(const LayoutEntry &entry, double scale, double matrix[16]);
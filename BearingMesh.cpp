@@ -0,0 +1,1065 @@
+#include "BearingMesh.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include "BearingPlacement.h"
+#include "BearingTrig.h"
+
+// Size of the stdio buffer used by the writers.
+static const size_t kWriteBufferSize = 1 << 20;
+
+MeshLod meshLodPreset(int level)
+{
+	static const MeshLod presets[] = {
+		{ 16, 4, 8 },
+		{ 48, 8, 12 },
+		{ 96, 12, 16 },
+		{ 256, 24, 32 }
+	};
+	if (level < 0)
+		level = 0;
+	if (level > 3)
+		level = 3;
+	return presets[level];
+}
+
+void TriangleMesh::clear()
+{
+	x.clear();
+	y.clear();
+	z.clear();
+	normalX.clear();
+	normalY.clear();
+	normalZ.clear();
+	indices.clear();
+}
+
+uint32_t TriangleMesh::addVertices(size_t count)
+{
+	size_t iFirst = x.size();
+	x.resize(iFirst + count);
+	y.resize(iFirst + count);
+	z.resize(iFirst + count);
+	normalX.resize(iFirst + count);
+	normalY.resize(iFirst + count);
+	normalZ.resize(iFirst + count);
+	return (uint32_t)iFirst;
+}
+
+// Sine and cosine of count evenly spaced angles from start to start + sweep * (count - 1) / count.
+static void computeAngleTable(double start, double sweep, int count, std::vector<float> *sines, std::vector<float> *cosines)
+{
+	std::vector<float> angles(count);
+	for (int i = 0; i < count; ++i)
+		angles[i] = (float)(start + sweep * i / count);
+	sines->resize(count);
+	cosines->resize(count);
+	computeSinCos(angles.data(), count, sines->data(), cosines->data());
+}
+
+static void addProfileEdge(double r0, double z0, double r1, double z1, std::vector<ProfileVertex> *profile)
+{
+	// The profile runs with the material on its left, so the outward normal is on the right.
+	double dLength = sqrt((r1 - r0) * (r1 - r0) + (z1 - z0) * (z1 - z0));
+	if (dLength <= 0.0)
+		return;
+	double dNormalR = (z1 - z0) / dLength;
+	double dNormalZ = -(r1 - r0) / dLength;
+	profile->push_back({ r0, z0, dNormalR, dNormalZ });
+	profile->push_back({ r1, z1, dNormalR, dNormalZ });
+}
+
+static void addProfileArc(const RacewayCircle &circle, double startAngle, double sweep, int segments, std::vector<ProfileVertex> *profile)
+{
+	// The material is outside of the raceway circle, the normals point to its centre.
+	for (int i = 0; i < segments; ++i) {
+		double dAngle0 = startAngle + sweep * i / segments;
+		double dAngle1 = startAngle + sweep * (i + 1) / segments;
+		profile->push_back({ circle.dCenterRadius + circle.dRadius * cos(dAngle0), circle.dCenterHeight + circle.dRadius * sin(dAngle0), -cos(dAngle0), -sin(dAngle0) });
+		profile->push_back({ circle.dCenterRadius + circle.dRadius * cos(dAngle1), circle.dCenterHeight + circle.dRadius * sin(dAngle1), -cos(dAngle1), -sin(dAngle1) });
+	}
+}
+
+// Outline of the ring cross section with the material on the left, starting at
+// the corner nearest to the axis and the lower face. A counterbore replaces the
+// corner it covers by a step.
+static void ringOutline(const RingProfile &ring, const RingProfile &counterbore, std::vector<double> *outlineR, std::vector<double> *outlineZ)
+{
+	double dLow = ring.dCenterHeight - ring.dHalfThickness;
+	double dHigh = ring.dCenterHeight + ring.dHalfThickness;
+	double cornersR[4] = { ring.dRadiusMin, ring.dRadiusMax, ring.dRadiusMax, ring.dRadiusMin };
+	double cornersZ[4] = { dLow, dLow, dHigh, dHigh };
+
+	outlineR->clear();
+	outlineZ->clear();
+	double dCutLow = counterbore.dCenterHeight - counterbore.dHalfThickness;
+	double dCutHigh = counterbore.dCenterHeight + counterbore.dHalfThickness;
+	for (int i = 0; i < 4; ++i) {
+		double dR = cornersR[i];
+		double dZ = cornersZ[i];
+		bool xCovered = hasCounterbore(counterbore) &&
+			dR >= counterbore.dRadiusMin - 1.0e-12 && dR <= counterbore.dRadiusMax + 1.0e-12 &&
+			dZ >= dCutLow - 1.0e-12 && dZ <= dCutHigh + 1.0e-12;
+		if (!xCovered) {
+			outlineR->push_back(dR);
+			outlineZ->push_back(dZ);
+			continue;
+		}
+		// The corner of the counterbore opposite to the covered one.
+		double dStepR = fabs(dR - counterbore.dRadiusMin) < fabs(dR - counterbore.dRadiusMax) ? counterbore.dRadiusMax : counterbore.dRadiusMin;
+		double dStepZ = fabs(dZ - dCutLow) < fabs(dZ - dCutHigh) ? dCutHigh : dCutLow;
+		// Odd corners are reached along a face, even ones along a side.
+		if (i % 2 == 1) {
+			outlineR->insert(outlineR->end(), { dStepR, dStepR, dR });
+			outlineZ->insert(outlineZ->end(), { dZ, dStepZ, dStepZ });
+		}
+		else {
+			outlineR->insert(outlineR->end(), { dR, dStepR, dStepR });
+			outlineZ->insert(outlineZ->end(), { dStepZ, dStepZ, dZ });
+		}
+	}
+}
+
+// Shape removed from a ring: a raceway circle or the convex cross section of a roller.
+struct ProfileCutter
+{
+	bool xCircle;
+	RacewayCircle circle;
+	// Counter clockwise corners of the polygon.
+	double cornersR[4];
+	double cornersZ[4];
+};
+
+static ProfileCutter circleCutter(const RacewayCircle &circle)
+{
+	ProfileCutter cutter;
+	cutter.xCircle = true;
+	cutter.circle = circle;
+	return cutter;
+}
+
+static ProfileCutter rollerCutter(const RollerProfile &roller)
+{
+	ProfileCutter cutter;
+	cutter.xCircle = false;
+	rollerCorners(roller, cutter.cornersR, cutter.cornersZ);
+	return cutter;
+}
+
+static bool insideCutter(const ProfileCutter &cutter, double r, double z)
+{
+	if (cutter.xCircle) {
+		double dR = r - cutter.circle.dCenterRadius;
+		double dZ = z - cutter.circle.dCenterHeight;
+		return dR * dR + dZ * dZ < cutter.circle.dRadius * cutter.circle.dRadius;
+	}
+	for (int i = 0; i < 4; ++i) {
+		int j = (i + 1) % 4;
+		double dCross = (cutter.cornersR[j] - cutter.cornersR[i]) * (z - cutter.cornersZ[i]) - (cutter.cornersZ[j] - cutter.cornersZ[i]) * (r - cutter.cornersR[i]);
+		if (dCross <= 0.0)
+			return false;
+	}
+	return true;
+}
+
+// Part [enter, leave] of the edge from (r0, z0) along (deltaR, deltaZ) that lies
+// inside the cutter, with the polygon sides it crosses. False if it misses.
+static bool clipEdge(const ProfileCutter &cutter, double r0, double z0, double deltaR, double deltaZ,
+	double *enter, double *leave, int *enterSide, int *leaveSide)
+{
+	*enterSide = *leaveSide = -1;
+	if (cutter.xCircle) {
+		const RacewayCircle &circle = cutter.circle;
+		double dA = deltaR * deltaR + deltaZ * deltaZ;
+		double dB = 2.0 * (deltaR * (r0 - circle.dCenterRadius) + deltaZ * (z0 - circle.dCenterHeight));
+		double dC = (r0 - circle.dCenterRadius) * (r0 - circle.dCenterRadius) + (z0 - circle.dCenterHeight) * (z0 - circle.dCenterHeight) - circle.dRadius * circle.dRadius;
+		double dDiscriminant = dB * dB - 4.0 * dA * dC;
+		if (dA <= 0.0 || dDiscriminant <= 0.0)
+			return false;
+		*enter = (-dB - sqrt(dDiscriminant)) / (2.0 * dA);
+		*leave = (-dB + sqrt(dDiscriminant)) / (2.0 * dA);
+		return true;
+	}
+
+	// Cyrus-Beck against the sides of the polygon.
+	*enter = -1.0e300;
+	*leave = 1.0e300;
+	for (int i = 0; i < 4; ++i) {
+		int j = (i + 1) % 4;
+		double dOutR = cutter.cornersZ[j] - cutter.cornersZ[i];
+		double dOutZ = -(cutter.cornersR[j] - cutter.cornersR[i]);
+		double dDistance = (cutter.cornersR[i] - r0) * dOutR + (cutter.cornersZ[i] - z0) * dOutZ;
+		double dSpeed = deltaR * dOutR + deltaZ * dOutZ;
+		if (dSpeed == 0.0) {
+			if (dDistance <= 0.0)
+				return false;
+			continue;
+		}
+		double dT = dDistance / dSpeed;
+		if (dSpeed < 0.0 && dT > *enter) {
+			*enter = dT;
+			*enterSide = i;
+		}
+		else if (dSpeed > 0.0 && dT < *leave) {
+			*leave = dT;
+			*leaveSide = i;
+		}
+	}
+	return *enter < *leave;
+}
+
+static void addOutlineEdge(double r0, double z0, double r1, double z1, std::vector<ProfileSegment> *outline)
+{
+	if (r0 == r1 && z0 == z1)
+		return;
+	outline->push_back({ r0, z0, r1, z1, RacewayCircle{ 0.0, 0.0, 0.0 } });
+}
+
+// Boundary of the cutter from where the outline enters it to where it leaves,
+// around the material, which is clockwise around the cutter.
+static void addCutterPath(const ProfileCutter &cutter, double r0, double z0, int enterSide, double r1, double z1, int leaveSide,
+	std::vector<ProfileSegment> *outline)
+{
+	if (cutter.xCircle) {
+		outline->push_back({ r0, z0, r1, z1, cutter.circle });
+		return;
+	}
+
+	// Backwards along the sides, unless both points are on the same side in that order.
+	int iSide = enterSide;
+	if (iSide == leaveSide) {
+		double dSideR = cutter.cornersR[(iSide + 1) % 4] - cutter.cornersR[iSide];
+		double dSideZ = cutter.cornersZ[(iSide + 1) % 4] - cutter.cornersZ[iSide];
+		if ((r1 - r0) * dSideR + (z1 - z0) * dSideZ <= 0.0) {
+			addOutlineEdge(r0, z0, r1, z1, outline);
+			return;
+		}
+	}
+	double dR = r0;
+	double dZ = z0;
+	do {
+		addOutlineEdge(dR, dZ, cutter.cornersR[iSide], cutter.cornersZ[iSide], outline);
+		dR = cutter.cornersR[iSide];
+		dZ = cutter.cornersZ[iSide];
+		iSide = (iSide + 3) % 4;
+	} while (iSide != leaveSide);
+	addOutlineEdge(dR, dZ, r1, z1, outline);
+}
+
+static void buildCutOutline(const RingProfile &ring, const RingProfile &counterbore, const std::vector<ProfileCutter> &cutters,
+	std::vector<ProfileSegment> *outline)
+{
+	outline->clear();
+
+	std::vector<double> outlineR, outlineZ;
+	ringOutline(ring, counterbore, &outlineR, &outlineZ);
+	size_t iCorners = outlineR.size();
+
+	// Start at a corner that no cutter removes.
+	size_t iStart = 0;
+	for (; iStart < iCorners; ++iStart) {
+		bool xInside = false;
+		for (const ProfileCutter &cutter : cutters)
+			xInside = xInside || insideCutter(cutter, outlineR[iStart], outlineZ[iStart]);
+		if (!xInside)
+			break;
+	}
+	if (iStart == iCorners)
+		return;
+
+	// Walk the outline and replace the parts inside a cutter by its boundary.
+	// The cutters do not overlap, so a part that enters one leaves it again.
+	int iInside = -1;
+	int iEnterSide = -1;
+	double dEntryR = 0.0;
+	double dEntryZ = 0.0;
+	for (size_t k = 0; k < iCorners; ++k) {
+		size_t i0 = (iStart + k) % iCorners;
+		size_t i1 = (i0 + 1) % iCorners;
+		double dR0 = outlineR[i0];
+		double dZ0 = outlineZ[i0];
+		double dDeltaR = outlineR[i1] - dR0;
+		double dDeltaZ = outlineZ[i1] - dZ0;
+
+		// Parts of the edge inside each cutter, in the order they are passed.
+		struct Crossing { double dEnter; double dLeave; int iCutter; int iEnterSide; int iLeaveSide; };
+		std::vector<Crossing> crossings;
+		for (size_t j = 0; j < cutters.size(); ++j) {
+			Crossing crossing;
+			if (!clipEdge(cutters[j], dR0, dZ0, dDeltaR, dDeltaZ, &crossing.dEnter, &crossing.dLeave, &crossing.iEnterSide, &crossing.iLeaveSide))
+				continue;
+			crossing.dEnter = std::max(crossing.dEnter, 0.0);
+			crossing.dLeave = std::min(crossing.dLeave, 1.0);
+			crossing.iCutter = (int)j;
+			if (crossing.dEnter < crossing.dLeave)
+				crossings.push_back(crossing);
+		}
+		std::sort(crossings.begin(), crossings.end(), [](const Crossing &a, const Crossing &b) { return a.dEnter < b.dEnter; });
+
+		double dT = 0.0;
+		for (const Crossing &crossing : crossings) {
+			if (iInside < 0) {
+				addOutlineEdge(dR0 + dDeltaR * dT, dZ0 + dDeltaZ * dT, dR0 + dDeltaR * crossing.dEnter, dZ0 + dDeltaZ * crossing.dEnter, outline);
+				iInside = crossing.iCutter;
+				iEnterSide = crossing.iEnterSide;
+				dEntryR = dR0 + dDeltaR * crossing.dEnter;
+				dEntryZ = dZ0 + dDeltaZ * crossing.dEnter;
+			}
+			dT = crossing.dLeave;
+			if (crossing.dLeave < 1.0) {
+				addCutterPath(cutters[iInside], dEntryR, dEntryZ, iEnterSide, dR0 + dDeltaR * dT, dZ0 + dDeltaZ * dT, crossing.iLeaveSide, outline);
+				iInside = -1;
+			}
+		}
+		if (iInside < 0)
+			addOutlineEdge(dR0 + dDeltaR * dT, dZ0 + dDeltaZ * dT, outlineR[i1], outlineZ[i1], outline);
+	}
+}
+
+// Splits the arcs of an outline into the given number of segments.
+static void tessellateOutline(const std::vector<ProfileSegment> &outline, int racewaySegments, std::vector<ProfileVertex> *profile)
+{
+	profile->clear();
+	for (const ProfileSegment &segment : outline) {
+		if (!isProfileArc(segment)) {
+			addProfileEdge(segment.dR0, segment.dZ0, segment.dR1, segment.dZ1, profile);
+			continue;
+		}
+		const RacewayCircle &circle = segment.circle;
+		double dStart = atan2(segment.dZ0 - circle.dCenterHeight, segment.dR0 - circle.dCenterRadius);
+		double dSweep = atan2(segment.dZ1 - circle.dCenterHeight, segment.dR1 - circle.dCenterRadius) - dStart;
+		while (dSweep > 0.0)
+			dSweep -= 2.0 * M_PI;
+		while (dSweep <= -2.0 * M_PI)
+			dSweep += 2.0 * M_PI;
+		addProfileArc(circle, dStart, dSweep, racewaySegments, profile);
+	}
+}
+
+void buildRingOutline(const RingProfile &ring, const RingProfile &counterbore, const RacewayCircle *raceways, int racewayCount,
+	std::vector<ProfileSegment> *outline)
+{
+	std::vector<ProfileCutter> cutters;
+	for (int i = 0; i < racewayCount; ++i)
+		cutters.push_back(circleCutter(raceways[i]));
+	buildCutOutline(ring, counterbore, cutters, outline);
+}
+
+void buildRingOutline(const RingProfile &ring, const RollerProfile &roller, std::vector<ProfileSegment> *outline)
+{
+	RingProfile none = { 0.0, 0.0, 0.0, 0.0 };
+	buildCutOutline(ring, none, std::vector<ProfileCutter>(1, rollerCutter(roller)), outline);
+}
+
+void buildRingOutline(const BearingGeometry &geometry, bool outer, std::vector<ProfileSegment> *outline)
+{
+	if (geometry.eElement != BallElement) {
+		buildRingOutline(outer ? geometry.outerRing : geometry.innerRing, geometry.roller, outline);
+		return;
+	}
+	RacewayCircle raceways[kMaxBallRows];
+	for (int i = 0; i < geometry.iRowCount; ++i)
+		raceways[i] = rowRaceway(geometry, i);
+	if (outer)
+		buildRingOutline(geometry.outerRing, geometry.outerCounterbore, raceways, geometry.iRowCount, outline);
+	else
+		buildRingOutline(geometry.innerRing, geometry.innerCounterbore, raceways, geometry.iRowCount, outline);
+}
+
+void buildRingProfile(const RingProfile &ring, const RingProfile &counterbore, const RacewayCircle *raceways, int racewayCount,
+	int racewaySegments, std::vector<ProfileVertex> *profile)
+{
+	std::vector<ProfileSegment> outline;
+	buildRingOutline(ring, counterbore, raceways, racewayCount, &outline);
+	tessellateOutline(outline, racewaySegments, profile);
+}
+
+void buildRingProfile(const RingProfile &ring, const RollerProfile &roller, std::vector<ProfileVertex> *profile)
+{
+	std::vector<ProfileSegment> outline;
+	buildRingOutline(ring, roller, &outline);
+	tessellateOutline(outline, 1, profile);
+}
+
+void buildRingProfile(const RingProfile &ring, const RacewayCircle &raceway, int racewaySegments, std::vector<ProfileVertex> *profile)
+{
+	RingProfile none = { 0.0, 0.0, 0.0, 0.0 };
+	buildRingProfile(ring, none, &raceway, 1, racewaySegments, profile);
+}
+
+void buildRingProfile(const BearingGeometry &geometry, bool outer, int racewaySegments, std::vector<ProfileVertex> *profile)
+{
+	std::vector<ProfileSegment> outline;
+	buildRingOutline(geometry, outer, &outline);
+	tessellateOutline(outline, racewaySegments, profile);
+}
+
+// Appends the balls or rollers of all rows.
+static void tessellateRollingElements(const BearingGeometry &geometry, const MeshLod &lod, double offsetX, double offsetY, TriangleMesh *mesh)
+{
+	BallPlacement placement;
+	for (int iRow = 0; iRow < geometry.iRowCount; ++iRow) {
+		if (!placeRollingElements(geometry, iRow, &placement))
+			return;
+		for (int i = 0; i < placement.iCount; ++i) {
+			if (geometry.eElement != BallElement)
+				tessellateRoller(geometry.roller, placement.dAngleStep * i, offsetX, offsetY, lod.iBallSegments, mesh);
+			else
+				tessellateSphere(offsetX + placement.centersX[i], offsetY + placement.centersY[i], placement.dHeight, placement.dBallRadius, lod.iBallSegments, mesh);
+		}
+	}
+}
+
+void tessellateRevolve(const std::vector<ProfileVertex> &profile, int segments, double offsetX, double offsetY, TriangleMesh *mesh)
+{
+	std::vector<float> sines, cosines;
+	computeAngleTable(0.0, 2.0 * M_PI, segments, &sines, &cosines);
+	const float *pSin = sines.data();
+	const float *pCos = cosines.data();
+
+	size_t iProfileCount = profile.size();
+	uint32_t iBase = mesh->addVertices(iProfileCount * segments);
+	float fOffsetX = (float)offsetX;
+	float fOffsetY = (float)offsetY;
+
+	// One ring of vertices per profile point, the inner loops vectorize. The
+	// profile height runs along -Z like in the build, the ring turns the other
+	// way around the axis so that the triangles keep facing out.
+	for (size_t k = 0; k < iProfileCount; ++k) {
+		const ProfileVertex &vertex = profile[k];
+		float fR = (float)vertex.dR;
+		float fZ = (float)modelHeight(vertex.dZ);
+		float fNormalR = (float)vertex.dNormalR;
+		float fNormalZ = (float)modelHeight(vertex.dNormalZ);
+
+		size_t iFirst = iBase + k * segments;
+		float *pX = mesh->x.data() + iFirst;
+		float *pY = mesh->y.data() + iFirst;
+		float *pZ = mesh->z.data() + iFirst;
+		float *pNormalX = mesh->normalX.data() + iFirst;
+		float *pNormalY = mesh->normalY.data() + iFirst;
+		float *pNormalZ = mesh->normalZ.data() + iFirst;
+		for (int j = 0; j < segments; ++j) {
+			pX[j] = fOffsetX + fR * pCos[j];
+			pY[j] = fOffsetY - fR * pSin[j];
+			pZ[j] = fZ;
+			pNormalX[j] = fNormalR * pCos[j];
+			pNormalY[j] = -fNormalR * pSin[j];
+			pNormalZ[j] = fNormalZ;
+		}
+	}
+
+	mesh->indices.reserve(mesh->indices.size() + iProfileCount / 2 * segments * 6);
+	for (size_t k = 0; k + 1 < iProfileCount; k += 2) {
+		uint32_t iStart = iBase + (uint32_t)(k * segments);
+		uint32_t iEnd = iStart + (uint32_t)segments;
+		for (int j = 0; j < segments; ++j) {
+			uint32_t iNext = (uint32_t)((j + 1) % segments);
+			mesh->indices.push_back(iStart + j);
+			mesh->indices.push_back(iStart + iNext);
+			mesh->indices.push_back(iEnd + iNext);
+			mesh->indices.push_back(iStart + j);
+			mesh->indices.push_back(iEnd + iNext);
+			mesh->indices.push_back(iEnd + j);
+		}
+	}
+}
+
+void tessellateSphere(double centerX, double centerY, double centerZ, double radius, int segments, TriangleMesh *mesh)
+{
+	int iStacks = segments / 2 < 2 ? 2 : segments / 2;
+
+	std::vector<float> azimuthSines, azimuthCosines, polarSines, polarCosines;
+	computeAngleTable(0.0, 2.0 * M_PI, segments, &azimuthSines, &azimuthCosines);
+	computeAngleTable(0.0, M_PI, iStacks, &polarSines, &polarCosines);
+
+	// Poles first, then one ring of vertices per latitude.
+	uint32_t iTop = mesh->addVertices(2 + (size_t)(iStacks - 1) * segments);
+	uint32_t iBottom = iTop + 1;
+	float fX = (float)centerX;
+	float fY = (float)centerY;
+	float fZ = (float)centerZ;
+	float fRadius = (float)radius;
+
+	mesh->x[iTop] = mesh->x[iBottom] = fX;
+	mesh->y[iTop] = mesh->y[iBottom] = fY;
+	mesh->z[iTop] = fZ + fRadius;
+	mesh->z[iBottom] = fZ - fRadius;
+	mesh->normalX[iTop] = mesh->normalX[iBottom] = 0.0f;
+	mesh->normalY[iTop] = mesh->normalY[iBottom] = 0.0f;
+	mesh->normalZ[iTop] = 1.0f;
+	mesh->normalZ[iBottom] = -1.0f;
+
+	const float *pSin = azimuthSines.data();
+	const float *pCos = azimuthCosines.data();
+	for (int i = 1; i < iStacks; ++i) {
+		float fRing = polarSines[i];
+		float fHeight = polarCosines[i];
+		size_t iFirst = iTop + 2 + (size_t)(i - 1) * segments;
+		float *pX = mesh->x.data() + iFirst;
+		float *pY = mesh->y.data() + iFirst;
+		float *pZ = mesh->z.data() + iFirst;
+		float *pNormalX = mesh->normalX.data() + iFirst;
+		float *pNormalY = mesh->normalY.data() + iFirst;
+		float *pNormalZ = mesh->normalZ.data() + iFirst;
+		for (int j = 0; j < segments; ++j) {
+			pNormalX[j] = fRing * pCos[j];
+			pNormalY[j] = fRing * pSin[j];
+			pNormalZ[j] = fHeight;
+			pX[j] = fX + fRadius * pNormalX[j];
+			pY[j] = fY + fRadius * pNormalY[j];
+			pZ[j] = fZ + fRadius * fHeight;
+		}
+	}
+
+	auto ringVertex = [&](int ring, int j) {
+		return iTop + 2 + (uint32_t)((ring - 1) * segments + (j % segments));
+	};
+
+	mesh->indices.reserve(mesh->indices.size() + (size_t)iStacks * segments * 6);
+	for (int j = 0; j < segments; ++j) {
+		mesh->indices.push_back(iTop);
+		mesh->indices.push_back(ringVertex(1, j));
+		mesh->indices.push_back(ringVertex(1, j + 1));
+	}
+	for (int i = 1; i + 1 < iStacks; ++i) {
+		for (int j = 0; j < segments; ++j) {
+			mesh->indices.push_back(ringVertex(i, j));
+			mesh->indices.push_back(ringVertex(i + 1, j));
+			mesh->indices.push_back(ringVertex(i + 1, j + 1));
+			mesh->indices.push_back(ringVertex(i, j));
+			mesh->indices.push_back(ringVertex(i + 1, j + 1));
+			mesh->indices.push_back(ringVertex(i, j + 1));
+		}
+	}
+	for (int j = 0; j < segments; ++j) {
+		mesh->indices.push_back(ringVertex(iStacks - 1, j));
+		mesh->indices.push_back(iBottom);
+		mesh->indices.push_back(ringVertex(iStacks - 1, j + 1));
+	}
+}
+
+void tessellateRoller(const RollerProfile &roller, double angle, double offsetX, double offsetY, int segments, TriangleMesh *mesh)
+{
+	std::vector<float> sines, cosines;
+	computeAngleTable(0.0, 2.0 * M_PI, segments, &sines, &cosines);
+
+	// Frame of the roller in model coordinates: its axis towards the small end
+	// and two directions across it, the first one away from the bearing axis.
+	// The heights run along -Z like in the build, the second direction turns
+	// with them so that the frame stays right handed.
+	double dCosAngle = cos(angle);
+	double dSinAngle = sin(angle);
+	double dCosTilt = cos(roller.dAxisAngle);
+	double dSinTilt = sin(roller.dAxisAngle);
+	double axis[3] = { -dSinTilt * dCosAngle, -dSinTilt * dSinAngle, modelHeight(dCosTilt) };
+	double across[3] = { dCosTilt * dCosAngle, dCosTilt * dSinAngle, modelHeight(dSinTilt) };
+	double side[3] = { dSinAngle, -dCosAngle, 0.0 };
+
+	double endsR[2], endsZ[2], radii[2];
+	rollerEnds(roller, endsR, endsZ, radii);
+	double ends[2][3];
+	for (int e = 0; e < 2; ++e) {
+		ends[e][0] = offsetX + endsR[e] * dCosAngle;
+		ends[e][1] = offsetY + endsR[e] * dSinAngle;
+		ends[e][2] = modelHeight(endsZ[e]);
+	}
+
+	// The mantle has smooth normals, tilted towards the small end by the taper,
+	// each end face has its own vertices with the axis as normal.
+	double dCosTaper = cos(roller.dTaperAngle);
+	double dSinTaper = sin(roller.dTaperAngle);
+	uint32_t iFirst = mesh->addVertices((size_t)segments * 4 + 2);
+	uint32_t iMantle = iFirst;
+	uint32_t iFaces = iFirst + (uint32_t)segments * 2;
+	uint32_t iCenters = iFirst + (uint32_t)segments * 4;
+	for (int j = 0; j < segments; ++j) {
+		double dDirection[3];
+		for (int c = 0; c < 3; ++c)
+			dDirection[c] = cosines[j] * across[c] + sines[j] * side[c];
+		for (int e = 0; e < 2; ++e) {
+			uint32_t iMantleVertex = iMantle + (uint32_t)(e * segments + j);
+			uint32_t iFaceVertex = iFaces + (uint32_t)(e * segments + j);
+			double dPoint[3];
+			for (int c = 0; c < 3; ++c)
+				dPoint[c] = ends[e][c] + radii[e] * dDirection[c];
+			mesh->x[iMantleVertex] = mesh->x[iFaceVertex] = (float)dPoint[0];
+			mesh->y[iMantleVertex] = mesh->y[iFaceVertex] = (float)dPoint[1];
+			mesh->z[iMantleVertex] = mesh->z[iFaceVertex] = (float)dPoint[2];
+			mesh->normalX[iMantleVertex] = (float)(dCosTaper * dDirection[0] + dSinTaper * axis[0]);
+			mesh->normalY[iMantleVertex] = (float)(dCosTaper * dDirection[1] + dSinTaper * axis[1]);
+			mesh->normalZ[iMantleVertex] = (float)(dCosTaper * dDirection[2] + dSinTaper * axis[2]);
+			float fSign = e == 0 ? -1.0f : 1.0f;
+			mesh->normalX[iFaceVertex] = fSign * (float)axis[0];
+			mesh->normalY[iFaceVertex] = fSign * (float)axis[1];
+			mesh->normalZ[iFaceVertex] = fSign * (float)axis[2];
+		}
+	}
+	for (int e = 0; e < 2; ++e) {
+		float fSign = e == 0 ? -1.0f : 1.0f;
+		mesh->x[iCenters + e] = (float)ends[e][0];
+		mesh->y[iCenters + e] = (float)ends[e][1];
+		mesh->z[iCenters + e] = (float)ends[e][2];
+		mesh->normalX[iCenters + e] = fSign * (float)axis[0];
+		mesh->normalY[iCenters + e] = fSign * (float)axis[1];
+		mesh->normalZ[iCenters + e] = fSign * (float)axis[2];
+	}
+
+	mesh->indices.reserve(mesh->indices.size() + (size_t)segments * 12);
+	for (int j = 0; j < segments; ++j) {
+		uint32_t iNext = (uint32_t)((j + 1) % segments);
+		uint32_t iLarge = iMantle, iSmall = iMantle + (uint32_t)segments;
+		mesh->indices.insert(mesh->indices.end(), { iSmall + j, iLarge + j, iLarge + iNext, iSmall + j, iLarge + iNext, iSmall + iNext });
+		uint32_t iLargeFace = iFaces, iSmallFace = iFaces + (uint32_t)segments;
+		mesh->indices.insert(mesh->indices.end(), { iLargeFace + j, iCenters, iLargeFace + iNext });
+		mesh->indices.insert(mesh->indices.end(), { iCenters + 1, iSmallFace + j, iSmallFace + iNext });
+	}
+}
+
+StlMeshWriter::StlMeshWriter()
+	: mpFile(nullptr), miTriangles(0)
+{
+}
+
+StlMeshWriter::~StlMeshWriter()
+{
+	if (mpFile)
+		close();
+}
+
+bool StlMeshWriter::open(const std::string &path)
+{
+	mpFile = std::fopen(path.c_str(), "wb");
+	if (!mpFile)
+		return false;
+	std::setvbuf(mpFile, nullptr, _IOFBF, kWriteBufferSize);
+
+	char header[80];
+	std::memset(header, 0, sizeof(header));
+	std::strncpy(header, "BallBearing mesh", sizeof(header) - 1);
+	miTriangles = 0;
+	return std::fwrite(header, sizeof(header), 1, mpFile) == 1
+		&& std::fwrite(&miTriangles, sizeof(miTriangles), 1, mpFile) == 1;
+}
+
+bool StlMeshWriter::write(const TriangleMesh &mesh)
+{
+	if (!mpFile)
+		return false;
+
+	size_t iTriangles = mesh.triangleCount();
+	for (size_t i = 0; i < iTriangles; ++i) {
+		uint32_t iA = mesh.indices[3 * i];
+		uint32_t iB = mesh.indices[3 * i + 1];
+		uint32_t iC = mesh.indices[3 * i + 2];
+		float a[3] = { mesh.x[iA], mesh.y[iA], mesh.z[iA] };
+		float b[3] = { mesh.x[iB], mesh.y[iB], mesh.z[iB] };
+		float c[3] = { mesh.x[iC], mesh.y[iC], mesh.z[iC] };
+
+		float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		float normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+		float fLength = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (fLength > 0.0f) {
+			normal[0] /= fLength;
+			normal[1] /= fLength;
+			normal[2] /= fLength;
+		}
+
+		// 50 bytes per facet: normal, three corners and an unused attribute.
+		unsigned char record[50];
+		std::memcpy(record, normal, 12);
+		std::memcpy(record + 12, a, 12);
+		std::memcpy(record + 24, b, 12);
+		std::memcpy(record + 36, c, 12);
+		record[48] = record[49] = 0;
+		if (std::fwrite(record, sizeof(record), 1, mpFile) != 1)
+			return false;
+	}
+	miTriangles += (uint32_t)iTriangles;
+	return true;
+}
+
+bool StlMeshWriter::close()
+{
+	if (!mpFile)
+		return false;
+
+	bool xResult = std::fseek(mpFile, 80, SEEK_SET) == 0
+		&& std::fwrite(&miTriangles, sizeof(miTriangles), 1, mpFile) == 1;
+	xResult = (std::fclose(mpFile) == 0) && xResult;
+	mpFile = nullptr;
+	return xResult;
+}
+
+PlyMeshWriter::PlyMeshWriter()
+	: mpFile(nullptr), mpFaces(nullptr), miVertices(0), miFaces(0), miVertexCountPos(0), miFaceCountPos(0)
+{
+}
+
+PlyMeshWriter::~PlyMeshWriter()
+{
+	if (mpFile)
+		close();
+}
+
+bool PlyMeshWriter::open(const std::string &path)
+{
+	mpFile = std::fopen(path.c_str(), "wb");
+	if (!mpFile)
+		return false;
+	mpFaces = std::tmpfile();
+	if (!mpFaces) {
+		std::fclose(mpFile);
+		mpFile = nullptr;
+		return false;
+	}
+	std::setvbuf(mpFile, nullptr, _IOFBF, kWriteBufferSize);
+	std::setvbuf(mpFaces, nullptr, _IOFBF, kWriteBufferSize);
+
+	miVertices = 0;
+	miFaces = 0;
+
+	// The counts are written with a fixed width so that they can be patched on close.
+	std::fputs("ply\nformat binary_little_endian 1.0\ncomment BallBearing mesh\nelement vertex ", mpFile);
+	miVertexCountPos = std::ftell(mpFile);
+	std::fputs("0000000000\nproperty float x\nproperty float y\nproperty float z\n"
+		"property float nx\nproperty float ny\nproperty float nz\nelement face ", mpFile);
+	miFaceCountPos = std::ftell(mpFile);
+	std::fputs("0000000000\nproperty list uchar uint vertex_indices\nend_header\n", mpFile);
+	return !std::ferror(mpFile);
+}
+
+bool PlyMeshWriter::write(const TriangleMesh &mesh)
+{
+	if (!mpFile)
+		return false;
+
+	size_t iVertices = mesh.vertexCount();
+	for (size_t i = 0; i < iVertices; ++i) {
+		float record[6] = { mesh.x[i], mesh.y[i], mesh.z[i], mesh.normalX[i], mesh.normalY[i], mesh.normalZ[i] };
+		if (std::fwrite(record, sizeof(record), 1, mpFile) != 1)
+			return false;
+	}
+
+	size_t iTriangles = mesh.triangleCount();
+	for (size_t i = 0; i < iTriangles; ++i) {
+		unsigned char record[13];
+		record[0] = 3;
+		for (int k = 0; k < 3; ++k) {
+			uint32_t iIndex = miVertices + mesh.indices[3 * i + k];
+			std::memcpy(record + 1 + 4 * k, &iIndex, 4);
+		}
+		if (std::fwrite(record, sizeof(record), 1, mpFaces) != 1)
+			return false;
+	}
+
+	miVertices += (uint32_t)iVertices;
+	miFaces += (uint32_t)iTriangles;
+	return true;
+}
+
+bool PlyMeshWriter::close()
+{
+	if (!mpFile)
+		return false;
+
+	bool xResult = std::fflush(mpFaces) == 0 && std::fseek(mpFaces, 0, SEEK_SET) == 0;
+	char buffer[1 << 16];
+	size_t iRead;
+	while (xResult && (iRead = std::fread(buffer, 1, sizeof(buffer), mpFaces)) > 0)
+		xResult = std::fwrite(buffer, 1, iRead, mpFile) == iRead;
+
+	char count[11];
+	std::snprintf(count, sizeof(count), "%010u", miVertices);
+	xResult = xResult && std::fseek(mpFile, miVertexCountPos, SEEK_SET) == 0 && std::fwrite(count, 10, 1, mpFile) == 1;
+	std::snprintf(count, sizeof(count), "%010u", miFaces);
+	xResult = xResult && std::fseek(mpFile, miFaceCountPos, SEEK_SET) == 0 && std::fwrite(count, 10, 1, mpFile) == 1;
+
+	std::fclose(mpFaces);
+	xResult = (std::fclose(mpFile) == 0) && xResult;
+	mpFaces = nullptr;
+	mpFile = nullptr;
+	return xResult;
+}
+
+static uint32_t updateCrc32(uint32_t crc, const void *data, size_t size)
+{
+	static const std::vector<uint32_t> table = [] {
+		std::vector<uint32_t> values(256);
+		for (uint32_t i = 0; i < 256; ++i) {
+			uint32_t iValue = i;
+			for (int k = 0; k < 8; ++k)
+				iValue = (iValue & 1) ? 0xedb88320u ^ (iValue >> 1) : iValue >> 1;
+			values[i] = iValue;
+		}
+		return values;
+	}();
+
+	const unsigned char *pData = (const unsigned char *)data;
+	crc = ~crc;
+	for (size_t i = 0; i < size; ++i)
+		crc = table[(crc ^ pData[i]) & 0xff] ^ (crc >> 8);
+	return ~crc;
+}
+
+// Appends a little endian value of the given number of bytes.
+static void appendLittleEndian(std::string *buffer, uint32_t value, int bytes)
+{
+	for (int i = 0; i < bytes; ++i)
+		buffer->push_back((char)((value >> (8 * i)) & 0xff));
+}
+
+// Stored zip entries carry no timestamp of their own, 1980-01-01 is the earliest DOS date.
+static const uint32_t kZipDate = (1 << 5) | 1;
+
+static const char kContentTypes[] =
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	"<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">"
+	"<Default Extension=\"rels\" ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>"
+	"<Default Extension=\"model\" ContentType=\"application/vnd.ms-package.3dmanufacturing-3dmodel+xml\"/>"
+	"</Types>\n";
+
+static const char kRelationships[] =
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	"<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+	"<Relationship Target=\"/3D/3dmodel.model\" Id=\"rel0\" Type=\"http://schemas.microsoft.com/3dmanufacturing/2013/01/3dmodel\"/>"
+	"</Relationships>\n";
+
+ThreeMfMeshWriter::ThreeMfMeshWriter(const std::string &unit)
+	: mstrUnit(unit), mpFile(nullptr), miEntrySize(0), miObjects(0)
+{
+}
+
+ThreeMfMeshWriter::~ThreeMfMeshWriter()
+{
+	if (mpFile)
+		close();
+}
+
+bool ThreeMfMeshWriter::open(const std::string &path)
+{
+	mpFile = std::fopen(path.c_str(), "wb");
+	if (!mpFile)
+		return false;
+	std::setvbuf(mpFile, nullptr, _IOFBF, kWriteBufferSize);
+	mEntries.clear();
+	miObjects = 0;
+
+	std::string strModel = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<model unit=\"" + mstrUnit +
+		"\" xml:lang=\"en-US\" xmlns=\"http://schemas.microsoft.com/3dmanufacturing/core/2015/02\">\n<resources>\n";
+	return beginEntry("[Content_Types].xml") && writeEntry(kContentTypes, sizeof(kContentTypes) - 1) && endEntry()
+		&& beginEntry("_rels/.rels") && writeEntry(kRelationships, sizeof(kRelationships) - 1) && endEntry()
+		&& beginEntry("3D/3dmodel.model") && writeEntry(strModel.data(), strModel.size());
+}
+
+bool ThreeMfMeshWriter::write(const TriangleMesh &mesh)
+{
+	if (!mpFile)
+		return false;
+
+	// Merge the vertices that the tessellation splits for sharp normals. Adding
+	// zero turns -0 into 0, so both end up as the same vertex.
+	struct Position
+	{
+		float x, y, z;
+		bool operator==(const Position &other) const { return x == other.x && y == other.y && z == other.z; }
+	};
+	struct PositionHash
+	{
+		size_t operator()(const Position &position) const
+		{
+			uint32_t bits[3];
+			std::memcpy(bits, &position, sizeof(bits));
+			return (size_t)bits[0] * 73856093u ^ (size_t)bits[1] * 19349663u ^ (size_t)bits[2] * 83492791u;
+		}
+	};
+	std::unordered_map<Position, uint32_t, PositionHash> merged;
+	merged.reserve(mesh.vertexCount());
+	std::vector<uint32_t> remap(mesh.vertexCount());
+	std::vector<Position> positions;
+	for (size_t i = 0; i < mesh.vertexCount(); ++i) {
+		Position position = { mesh.x[i] + 0.0f, mesh.y[i] + 0.0f, mesh.z[i] + 0.0f };
+		auto inserted = merged.emplace(position, (uint32_t)positions.size());
+		if (inserted.second)
+			positions.push_back(position);
+		remap[i] = inserted.first->second;
+	}
+
+	// Triangles that collapse to an edge, like the ones at the poles of a sphere, are dropped.
+	std::vector<uint32_t> triangles;
+	triangles.reserve(mesh.indices.size());
+	for (size_t i = 0; i < mesh.triangleCount(); ++i) {
+		uint32_t iA = remap[mesh.indices[3 * i]];
+		uint32_t iB = remap[mesh.indices[3 * i + 1]];
+		uint32_t iC = remap[mesh.indices[3 * i + 2]];
+		if (iA != iB && iB != iC && iC != iA)
+			triangles.insert(triangles.end(), { iA, iB, iC });
+	}
+	if (triangles.empty())
+		return true;
+
+	// The object is written in chunks as it is formatted.
+	std::string strChunk = "<object id=\"" + std::to_string(++miObjects) + "\" type=\"model\"><mesh><vertices>\n";
+	char line[128];
+	for (const Position &position : positions) {
+		std::snprintf(line, sizeof(line), "<vertex x=\"%.9g\" y=\"%.9g\" z=\"%.9g\"/>\n", position.x, position.y, position.z);
+		strChunk += line;
+		if (strChunk.size() >= kWriteBufferSize / 4) {
+			if (!writeEntry(strChunk.data(), strChunk.size()))
+				return false;
+			strChunk.clear();
+		}
+	}
+	strChunk += "</vertices><triangles>\n";
+	for (size_t i = 0; i < triangles.size(); i += 3) {
+		std::snprintf(line, sizeof(line), "<triangle v1=\"%u\" v2=\"%u\" v3=\"%u\"/>\n", triangles[i], triangles[i + 1], triangles[i + 2]);
+		strChunk += line;
+		if (strChunk.size() >= kWriteBufferSize / 4) {
+			if (!writeEntry(strChunk.data(), strChunk.size()))
+				return false;
+			strChunk.clear();
+		}
+	}
+	strChunk += "</triangles></mesh></object>\n";
+	return writeEntry(strChunk.data(), strChunk.size());
+}
+
+bool ThreeMfMeshWriter::close()
+{
+	if (!mpFile)
+		return false;
+
+	std::string strBuild = "</resources>\n<build>\n";
+	for (uint32_t i = 1; i <= miObjects; ++i)
+		strBuild += "<item objectid=\"" + std::to_string(i) + "\"/>\n";
+	strBuild += "</build>\n</model>\n";
+	bool xResult = writeEntry(strBuild.data(), strBuild.size()) && endEntry();
+
+	// Central directory and its end record.
+	long iDirectoryOffset = std::ftell(mpFile);
+	std::string strDirectory;
+	for (const ZipEntry &entry : mEntries) {
+		appendLittleEndian(&strDirectory, 0x02014b50, 4);
+		appendLittleEndian(&strDirectory, 20, 2);
+		appendLittleEndian(&strDirectory, 20, 2);
+		appendLittleEndian(&strDirectory, 0, 2);
+		appendLittleEndian(&strDirectory, 0, 2);
+		appendLittleEndian(&strDirectory, 0, 2);
+		appendLittleEndian(&strDirectory, kZipDate, 2);
+		appendLittleEndian(&strDirectory, entry.iCrc, 4);
+		appendLittleEndian(&strDirectory, entry.iSize, 4);
+		appendLittleEndian(&strDirectory, entry.iSize, 4);
+		appendLittleEndian(&strDirectory, (uint32_t)entry.strName.size(), 2);
+		appendLittleEndian(&strDirectory, 0, 2);
+		appendLittleEndian(&strDirectory, 0, 2);
+		appendLittleEndian(&strDirectory, 0, 2);
+		appendLittleEndian(&strDirectory, 0, 2);
+		appendLittleEndian(&strDirectory, 0, 4);
+		appendLittleEndian(&strDirectory, entry.iOffset, 4);
+		strDirectory += entry.strName;
+	}
+	uint32_t iDirectorySize = (uint32_t)strDirectory.size();
+	appendLittleEndian(&strDirectory, 0x06054b50, 4);
+	appendLittleEndian(&strDirectory, 0, 2);
+	appendLittleEndian(&strDirectory, 0, 2);
+	appendLittleEndian(&strDirectory, (uint32_t)mEntries.size(), 2);
+	appendLittleEndian(&strDirectory, (uint32_t)mEntries.size(), 2);
+	appendLittleEndian(&strDirectory, iDirectorySize, 4);
+	appendLittleEndian(&strDirectory, (uint32_t)iDirectoryOffset, 4);
+	appendLittleEndian(&strDirectory, 0, 2);
+	xResult = xResult && iDirectoryOffset >= 0 && (unsigned long)iDirectoryOffset <= 0xffffffffu
+		&& std::fwrite(strDirectory.data(), 1, strDirectory.size(), mpFile) == strDirectory.size();
+
+	xResult = (std::fclose(mpFile) == 0) && xResult;
+	mpFile = nullptr;
+	return xResult;
+}
+
+bool ThreeMfMeshWriter::beginEntry(const char *name)
+{
+	long iOffset = std::ftell(mpFile);
+	if (iOffset < 0 || (unsigned long)iOffset > 0xffffffffu)
+		return false;
+	mEntries.push_back({ name, 0, 0, (uint32_t)iOffset });
+	miEntrySize = 0;
+
+	std::string strHeader;
+	appendLittleEndian(&strHeader, 0x04034b50, 4);
+	appendLittleEndian(&strHeader, 20, 2);
+	appendLittleEndian(&strHeader, 0, 2);
+	appendLittleEndian(&strHeader, 0, 2);
+	appendLittleEndian(&strHeader, 0, 2);
+	appendLittleEndian(&strHeader, kZipDate, 2);
+	// Checksum and sizes, filled in by endEntry.
+	appendLittleEndian(&strHeader, 0, 4);
+	appendLittleEndian(&strHeader, 0, 4);
+	appendLittleEndian(&strHeader, 0, 4);
+	appendLittleEndian(&strHeader, (uint32_t)std::strlen(name), 2);
+	appendLittleEndian(&strHeader, 0, 2);
+	strHeader += name;
+	return std::fwrite(strHeader.data(), 1, strHeader.size(), mpFile) == strHeader.size();
+}
+
+bool ThreeMfMeshWriter::writeEntry(const char *data, size_t size)
+{
+	ZipEntry &entry = mEntries.back();
+	entry.iCrc = updateCrc32(entry.iCrc, data, size);
+	miEntrySize += size;
+	return std::fwrite(data, 1, size, mpFile) == size;
+}
+
+bool ThreeMfMeshWriter::endEntry()
+{
+	// Stored entries without zip64 are limited to 4 GB.
+	if (miEntrySize > 0xffffffffu)
+		return false;
+	ZipEntry &entry = mEntries.back();
+	entry.iSize = (uint32_t)miEntrySize;
+
+	std::string strSizes;
+	appendLittleEndian(&strSizes, entry.iCrc, 4);
+	appendLittleEndian(&strSizes, entry.iSize, 4);
+	appendLittleEndian(&strSizes, entry.iSize, 4);
+	long iEnd = std::ftell(mpFile);
+	return iEnd >= 0 && std::fseek(mpFile, (long)entry.iOffset + 14, SEEK_SET) == 0
+		&& std::fwrite(strSizes.data(), 1, strSizes.size(), mpFile) == strSizes.size()
+		&& std::fseek(mpFile, iEnd, SEEK_SET) == 0;
+}
+
+void tessellateBearing(const BearingGeometry &geometry, const MeshLod &lod, TriangleMesh *mesh)
+{
+	std::vector<ProfileVertex> profile;
+	buildRingProfile(geometry, false, lod.iRacewaySegments, &profile);
+	tessellateRevolve(profile, lod.iRingSegments, 0.0, 0.0, mesh);
+	buildRingProfile(geometry, true, lod.iRacewaySegments, &profile);
+	tessellateRevolve(profile, lod.iRingSegments, 0.0, 0.0, mesh);
+	tessellateRollingElements(geometry, lod, 0.0, 0.0, mesh);
+}
+
+bool writeBearingMesh(const BearingGeometry &geometry, const MeshLod &lod, double offsetX, double offsetY, MeshWriter *writer)
+{
+	// Only one part is kept in memory at a time.
+	TriangleMesh mesh;
+	std::vector<ProfileVertex> profile;
+
+	buildRingProfile(geometry, false, lod.iRacewaySegments, &profile);
+	tessellateRevolve(profile, lod.iRingSegments, offsetX, offsetY, &mesh);
+	if (!writer->write(mesh))
+		return false;
+
+	mesh.clear();
+	buildRingProfile(geometry, true, lod.iRacewaySegments, &profile);
+	tessellateRevolve(profile, lod.iRingSegments, offsetX, offsetY, &mesh);
+	if (!writer->write(mesh))
+		return false;
+
+	mesh.clear();
+	tessellateRollingElements(geometry, lod, offsetX, offsetY, &mesh);
+	return mesh.vertexCount() == 0 || writer->write(mesh);
+}
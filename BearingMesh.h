@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "BearingGeometry.h"
+
+// Level of detail used when a bearing is tessellated.
+struct MeshLod
+{
+	// Segments around the bearing axis for the rings.
+	int iRingSegments;
+	// Segments of the raceway arc in the ring cross section.
+	int iRacewaySegments;
+	// Segments around one ball, the ball has half as many latitude bands.
+	int iBallSegments;
+};
+
+// Predefined levels of detail, 0 is the coarsest.
+MeshLod meshLodPreset(int level);
+
+// Point of a ring cross section with its outward normal, x is radial and y axial.
+struct ProfileVertex
+{
+	double dR;
+	double dZ;
+	double dNormalR;
+	double dNormalZ;
+};
+
+// Triangle mesh with per vertex normals. The vertex data is kept as separate
+// arrays per coordinate so that the tessellation loops run over contiguous floats.
+struct TriangleMesh
+{
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+	std::vector<float> normalX;
+	std::vector<float> normalY;
+	std::vector<float> normalZ;
+	std::vector<uint32_t> indices;
+
+	void clear();
+	// Grows all vertex arrays by count and returns the index of the first new vertex.
+	uint32_t addVertices(size_t count);
+	size_t vertexCount() const { return x.size(); }
+	size_t triangleCount() const { return indices.size() / 3; }
+};
+
+// Exact edge of a ring cross section, running with the material on its left.
+// Arcs run clockwise around their raceway circle, lines have a circle of radius 0.
+struct ProfileSegment
+{
+	double dR0;
+	double dZ0;
+	double dR1;
+	double dZ1;
+	RacewayCircle circle;
+};
+
+inline bool isProfileArc(const ProfileSegment &segment) { return segment.circle.dRadius > 0.0; }
+
+// Closed outline of a ring cross section after the raceway cut, in the same
+// order as the profile below. Exporters of exact geometry start from here.
+void buildRingOutline(const RingProfile &ring, const RingProfile &counterbore, const RacewayCircle *raceways, int racewayCount,
+	std::vector<ProfileSegment> *outline);
+void buildRingOutline(const RingProfile &ring, const RollerProfile &roller, std::vector<ProfileSegment> *outline);
+void buildRingOutline(const BearingGeometry &geometry, bool outer, std::vector<ProfileSegment> *outline);
+
+// Builds the cross section of a ring after the raceway cut. Every edge of the
+// profile is stored as a separate pair of vertices so that corners stay sharp.
+void buildRingProfile(const RingProfile &ring, const RacewayCircle &raceway, int racewaySegments, std::vector<ProfileVertex> *profile);
+// The same with several raceways, which must not overlap, and a counterbore that
+// covers one corner of the ring (zero size for none).
+void buildRingProfile(const RingProfile &ring, const RingProfile &counterbore, const RacewayCircle *raceways, int racewayCount,
+	int racewaySegments, std::vector<ProfileVertex> *profile);
+// The same with the groove of a roller.
+void buildRingProfile(const RingProfile &ring, const RollerProfile &roller, std::vector<ProfileVertex> *profile);
+// Cross section of the inner or outer ring of a bearing with the raceways of all rows or the roller groove.
+void buildRingProfile(const BearingGeometry &geometry, bool outer, int racewaySegments, std::vector<ProfileVertex> *profile);
+
+// Appends the surface of revolution of a profile around the Z axis, the height
+// of the profile runs along -Z like in the build (see modelHeight).
+void tessellateRevolve(const std::vector<ProfileVertex> &profile, int segments, double offsetX, double offsetY, TriangleMesh *mesh);
+
+// Appends a UV sphere.
+void tessellateSphere(double centerX, double centerY, double centerZ, double radius, int segments, TriangleMesh *mesh);
+
+// Appends a roller turned by the angle around the bearing axis, with its end faces.
+void tessellateRoller(const RollerProfile &roller, double angle, double offsetX, double offsetY, int segments, TriangleMesh *mesh);
+
+// Receives meshes one after the other and streams them to a file.
+class MeshWriter
+{
+public:
+	virtual ~MeshWriter() {}
+
+	virtual bool open(const std::string &path) = 0;
+	virtual bool write(const TriangleMesh &mesh) = 0;
+	virtual bool close() = 0;
+};
+
+// Binary STL, the triangle count in the header is filled in on close.
+class StlMeshWriter : public MeshWriter
+{
+public:
+	StlMeshWriter();
+	~StlMeshWriter();
+
+	bool open(const std::string &path) override;
+	bool write(const TriangleMesh &mesh) override;
+	bool close() override;
+
+private:
+	FILE *mpFile;
+	uint32_t miTriangles;
+};
+
+// Binary little endian PLY with normals. The faces are kept in a temporary
+// file until close because PLY stores all vertices before the faces.
+class PlyMeshWriter : public MeshWriter
+{
+public:
+	PlyMeshWriter();
+	~PlyMeshWriter();
+
+	bool open(const std::string &path) override;
+	bool write(const TriangleMesh &mesh) override;
+	bool close() override;
+
+private:
+	FILE *mpFile;
+	FILE *mpFaces;
+	uint32_t miVertices;
+	uint32_t miFaces;
+	long miVertexCountPos;
+	long miFaceCountPos;
+};
+
+// 3MF package with one object per written mesh, all placed by the build. The
+// model is streamed uncompressed into the zip container and its size and
+// checksum are patched into the entry header on close. Vertices at the same
+// position are merged, so every closed surface of the tessellation is a
+// closed 3MF mesh; the normals are dropped as 3MF has none.
+class ThreeMfMeshWriter : public MeshWriter
+{
+public:
+	// Unit of the model, one of the 3MF names like "millimeter" or "inch".
+	explicit ThreeMfMeshWriter(const std::string &unit = "millimeter");
+	~ThreeMfMeshWriter();
+
+	bool open(const std::string &path) override;
+	bool write(const TriangleMesh &mesh) override;
+	bool close() override;
+
+private:
+	// Starts a stored zip entry, its sizes and checksum are written by endEntry.
+	bool beginEntry(const char *name);
+	bool writeEntry(const char *data, size_t size);
+	bool endEntry();
+
+	struct ZipEntry
+	{
+		std::string strName;
+		uint32_t iCrc;
+		uint32_t iSize;
+		uint32_t iOffset;
+	};
+
+	std::string mstrUnit;
+	FILE *mpFile;
+	std::vector<ZipEntry> mEntries;
+	uint64_t miEntrySize;
+	uint32_t miObjects;
+};
+
+// Appends both rings and all balls of a bearing to one mesh, for previews that
+// are drawn in one go.
+void tessellateBearing(const BearingGeometry &geometry, const MeshLod &lod, TriangleMesh *mesh);
+
+// Tessellates both rings and all balls of a bearing and passes them to the writer.
+// The bearing is moved by the offset in the XY plane.
+bool writeBearingMesh(const BearingGeometry &geometry, const MeshLod &lod, double offsetX, double offsetY, MeshWriter *writer);
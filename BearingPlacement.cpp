@@ -0,0 +1,69 @@
+#include "BearingPlacement.h"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+int computeBallCountWithClearance(double pitchRadius, double ballRadius, double clearance)
+{
+	if (!(isfinite(pitchRadius) && isfinite(ballRadius) && isfinite(clearance) &&
+		pitchRadius > 0.0 && ballRadius > 0.0 && clearance >= 0.0))
+		return 0;
+
+	// Neighbouring centres are a chord 2 * R * sin(PI / n) apart.
+	double dChord = 2.0 * ballRadius + clearance;
+	if (dChord >= 2.0 * pitchRadius)
+		return 0;
+
+	double dCount = floor(M_PI / asin(dChord / (2.0 * pitchRadius)) + 1.0e-9);
+	if (!(dCount >= 2.0 && dCount < 2147483647.0))
+		return 0;
+	return (int)dCount;
+}
+
+bool placeBalls(double pitchRadius, double ballRadius, double height, int count, BallPlacement *placement)
+{
+	if (!placement || count <= 0)
+		return false;
+
+	placement->iCount = count;
+	placement->dPitchRadius = pitchRadius;
+	placement->dBallRadius = ballRadius;
+	placement->dHeight = height;
+	placement->dAngleStep = 2.0 * M_PI / count;
+	placement->centersX.resize(count);
+	placement->centersY.resize(count);
+	for (int i = 0; i < count; ++i) {
+		double dAngle = placement->dAngleStep * i;
+		placement->centersX[i] = pitchRadius * cos(dAngle);
+		placement->centersY[i] = pitchRadius * sin(dAngle);
+	}
+	return true;
+}
+
+bool placeRollingElements(const BearingGeometry &geometry, int row, BallPlacement *placement)
+{
+	if (row < 0 || row >= geometry.iRowCount)
+		return false;
+	if (geometry.eElement != BallElement)
+		return placeBalls(geometry.roller.dCenterRadius, geometry.roller.dRadius, modelHeight(geometry.roller.dCenterHeight), geometry.iBallCount, placement);
+	return placeBalls(geometry.dPitchRadius, geometry.dBallRadius, modelHeight(geometry.rowHeights[row]), geometry.iBallCount, placement);
+}
+
+void rollingElementTransform(const BallPlacement &placement, double axisAngle, int index, double matrix[16])
+{
+	double dCos = cos(placement.dAngleStep * index);
+	double dSin = sin(placement.dAngleStep * index);
+	double dAxisCos = cos(axisAngle);
+	double dAxisSin = sin(axisAngle);
+
+	// Rotation about Z times a turn of pi + axis angle about Y, which turns Z into
+	// (-sin, 0, -cos) like the roller axis of the XZ sketches, see modelHeight.
+	double cells[16] = {
+		-dCos * dAxisCos, -dSin, -dCos * dAxisSin, placement.centersX[index],
+		-dSin * dAxisCos, dCos, -dSin * dAxisSin, placement.centersY[index],
+		dAxisSin, 0.0, -dAxisCos, placement.dHeight,
+		0.0, 0.0, 0.0, 1.0
+	};
+	for (int i = 0; i < 16; ++i)
+		matrix[i] = cells[i];
+}
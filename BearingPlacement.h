@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+
+#include "BearingGeometry.h"
+
+// Positions of the rolling elements on the pitch circle of a bearing in model
+// coordinates. The bearing axis is Z, centres are stored as separate coordinate arrays.
+struct BallPlacement
+{
+	int iCount;
+	double dPitchRadius;
+	// Radius of the balls or of the rollers in their middle.
+	double dBallRadius;
+	double dHeight;
+	// Angle between two neighbouring balls in radians.
+	double dAngleStep;
+	std::vector<double> centersX;
+	std::vector<double> centersY;
+};
+
+// Largest number of balls on the pitch circle that keeps at least the given
+// clearance between neighbouring balls. Returns 0 if not even two balls fit.
+int computeBallCountWithClearance(double pitchRadius, double ballRadius, double clearance);
+
+// Spaces the balls evenly on the pitch circle, the first one is on the X axis.
+bool placeBalls(double pitchRadius, double ballRadius, double height, int count, BallPlacement *placement);
+
+// Places the rolling elements of one row of a bearing, balls or rollers alike.
+// The count is the one of the geometry, the element with index i sits at the
+// angle i * dAngleStep around the axis and at the model height of its row, see
+// modelHeight. The build, the single body, the mesh and the preview all take
+// their positions from here.
+bool placeRollingElements(const BearingGeometry &geometry, int row, BallPlacement *placement);
+
+// Row major 4x4 transform that moves an element modelled at the origin, with its
+// axis along Z towards the small end, to the element with the index: turned so
+// that its axis runs like the roller axis of the XZ sketches, whose height is
+// -Z, moved to its centre and turned to its angle around Z. Balls use an axis
+// angle of 0 and end up upside down, which does not show.
+void rollingElementTransform(const BallPlacement &placement, double axisAngle, int index, double matrix[16]);
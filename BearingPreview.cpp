@@ -0,0 +1,49 @@
+#include "BearingPreview.h"
+
+PreviewCache::PreviewCache(size_t capacity)
+	: miCapacity(capacity > 0 ? capacity : 1), miHits(0), miMisses(0)
+{
+}
+
+std::shared_ptr<const TriangleMesh> PreviewCache::mesh(const BearingGeometry &geometry, int lod)
+{
+	// The ball count covers the ball clearance, everything else follows from the family and the main sizes.
+	std::string strKey = bearingCacheKey(geometry.dInnerDiameter, geometry.dOuterDiameter, geometry.dThickness,
+		std::string("family=") + bearingFamilyName(geometry.eFamily) + ";balls=" + std::to_string(geometry.iBallCount) + ";lod=" + std::to_string(lod));
+
+	for (std::list<Entry>::iterator it = mEntries.begin(); it != mEntries.end(); ++it) {
+		if (it->first != strKey)
+			continue;
+		++miHits;
+		mEntries.splice(mEntries.begin(), mEntries, it);
+		return mEntries.front().second;
+	}
+
+	++miMisses;
+	std::shared_ptr<TriangleMesh> ptrMesh = std::make_shared<TriangleMesh>();
+	tessellateBearing(geometry, meshLodPreset(lod), ptrMesh.get());
+	mEntries.emplace_front(strKey, ptrMesh);
+	if (mEntries.size() > miCapacity)
+		mEntries.pop_back();
+	return ptrMesh;
+}
+
+void PreviewCache::clear()
+{
+	mEntries.clear();
+	miHits = 0;
+	miMisses = 0;
+}
+
+PreviewThrottle::PreviewThrottle(double settleSeconds, int coarseLod, int fineLod)
+	: mdSettleSeconds(settleSeconds), miCoarseLod(coarseLod), miFineLod(fineLod), mxStarted(false)
+{
+}
+
+int PreviewThrottle::lod(Clock::time_point now)
+{
+	bool xSettled = !mxStarted || std::chrono::duration<double>(now - mtLast).count() >= mdSettleSeconds;
+	mxStarted = true;
+	mtLast = now;
+	return xSettled ? miFineLod : miCoarseLod;
+}
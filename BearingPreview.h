@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "BearingGeometry.h"
+#include "BearingMesh.h"
+
+// Meshes shown while the command dialog is open. The most recently used ones
+// are kept, so going back to sizes that were previewed before costs nothing.
+class PreviewCache
+{
+public:
+	explicit PreviewCache(size_t capacity = 16);
+
+	// Returns the mesh of the bearing at the level of detail, tessellating it
+	// only if it is not cached yet.
+	std::shared_ptr<const TriangleMesh> mesh(const BearingGeometry &geometry, int lod);
+
+	void clear();
+	size_t size() const { return mEntries.size(); }
+	long long hitCount() const { return miHits; }
+	long long missCount() const { return miMisses; }
+
+private:
+	typedef std::pair<std::string, std::shared_ptr<const TriangleMesh>> Entry;
+
+	size_t miCapacity;
+	// Most recently used first.
+	std::list<Entry> mEntries;
+	long long miHits;
+	long long miMisses;
+};
+
+// Picks the level of detail of a preview from how fast the values change.
+// While the user types or scrubs, the previews come in quicker than the settle
+// time and get the coarse mesh; the first preview after a pause gets the fine one.
+class PreviewThrottle
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	PreviewThrottle(double settleSeconds = 0.3, int coarseLod = 0, int fineLod = 2);
+
+	int lod(Clock::time_point now);
+	// The next preview is drawn in full detail, like after opening the dialog.
+	void reset() { mxStarted = false; }
+
+private:
+	double mdSettleSeconds;
+	int miCoarseLod;
+	int miFineLod;
+	bool mxStarted;
+	Clock::time_point mtLast;
+};
@@ -0,0 +1,175 @@
+#include "BearingProperties.h"
+
+#include <algorithm>
+#include <vector>
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include "BearingMesh.h"
+
+// Segments of the raceway arcs in the ring cross sections. The error of the
+// chords in the volume is below one part in ten thousand.
+static const int kProfileSegments = 96;
+
+// Factor of a table of the standards at gamma = Dw cos(alpha) / Dpw, linear
+// between the rows and held at the first and last one.
+struct FactorRow
+{
+	double dGamma;
+	double dFactor;
+};
+
+template <size_t N>
+static double tableFactor(const FactorRow (&table)[N], double gamma)
+{
+	if (gamma <= table[0].dGamma)
+		return table[0].dFactor;
+	for (size_t i = 1; i < N; ++i) {
+		if (gamma <= table[i].dGamma) {
+			double t = (gamma - table[i - 1].dGamma) / (table[i].dGamma - table[i - 1].dGamma);
+			return table[i - 1].dFactor + t * (table[i].dFactor - table[i - 1].dFactor);
+		}
+	}
+	return table[N - 1].dFactor;
+}
+
+// ISO 281 fc of single row radial and angular contact ball bearings.
+static const FactorRow kRadialBallFc[] = {
+	{ 0.01, 29.1 }, { 0.02, 35.8 }, { 0.03, 40.3 }, { 0.04, 43.8 }, { 0.05, 46.7 }, { 0.06, 49.1 }, { 0.07, 51.1 },
+	{ 0.08, 52.8 }, { 0.09, 54.3 }, { 0.10, 55.5 }, { 0.12, 57.5 }, { 0.14, 58.8 }, { 0.16, 59.6 }, { 0.18, 59.9 },
+	{ 0.20, 59.9 }, { 0.22, 59.6 }, { 0.24, 59.0 }, { 0.26, 58.2 }, { 0.28, 57.1 }, { 0.30, 56.0 }, { 0.32, 54.6 },
+	{ 0.34, 53.2 }, { 0.36, 51.7 }, { 0.38, 50.0 }, { 0.40, 48.4 }
+};
+
+// ISO 281 fc of thrust ball bearings with a contact angle of 90 degrees, gamma = Dw / Dpw.
+static const FactorRow kThrustBallFc[] = {
+	{ 0.01, 36.7 }, { 0.02, 45.2 }, { 0.03, 51.1 }, { 0.04, 55.7 }, { 0.05, 59.5 }, { 0.06, 62.9 }, { 0.07, 65.8 },
+	{ 0.08, 68.5 }, { 0.09, 71.0 }, { 0.10, 73.3 }, { 0.12, 77.4 }, { 0.14, 81.1 }, { 0.16, 84.4 }, { 0.18, 87.4 },
+	{ 0.20, 90.2 }, { 0.22, 92.8 }, { 0.24, 95.3 }, { 0.26, 97.6 }, { 0.28, 99.8 }, { 0.30, 101.9 }, { 0.34, 105.8 }
+};
+
+// ISO 281 fc of radial roller bearings.
+static const FactorRow kRadialRollerFc[] = {
+	{ 0.01, 52.1 }, { 0.02, 60.8 }, { 0.03, 66.5 }, { 0.04, 70.7 }, { 0.05, 74.1 }, { 0.06, 76.9 }, { 0.07, 79.2 },
+	{ 0.08, 81.2 }, { 0.09, 82.8 }, { 0.10, 84.2 }, { 0.12, 86.4 }, { 0.14, 87.7 }, { 0.16, 88.5 }, { 0.18, 88.8 },
+	{ 0.20, 88.7 }, { 0.22, 88.2 }, { 0.24, 87.5 }, { 0.26, 86.4 }, { 0.28, 85.2 }, { 0.30, 83.8 }, { 0.32, 82.3 },
+	{ 0.34, 80.8 }, { 0.36, 79.2 }, { 0.38, 77.4 }, { 0.40, 75.7 }
+};
+
+// ISO 76 f0 of radial deep groove and angular contact ball bearings.
+static const FactorRow kRadialBallF0[] = {
+	{ 0.00, 14.7 }, { 0.02, 15.1 }, { 0.04, 15.5 }, { 0.06, 15.9 }, { 0.08, 16.3 }, { 0.10, 16.4 }, { 0.12, 16.1 },
+	{ 0.14, 15.9 }, { 0.16, 15.6 }, { 0.18, 15.4 }, { 0.20, 15.2 }, { 0.24, 14.7 }, { 0.28, 14.2 }, { 0.32, 13.7 },
+	{ 0.36, 13.2 }, { 0.40, 12.8 }
+};
+
+double unitsToMillimetres(const std::string &units)
+{
+	if (units == "mm")
+		return 1.0;
+	if (units == "cm")
+		return 10.0;
+	if (units == "m")
+		return 1000.0;
+	if (units == "in")
+		return 25.4;
+	if (units == "ft")
+		return 304.8;
+	return 0.0;
+}
+
+// Volume and moment of inertia per density of the solid of revolution of a
+// profile around the Z axis. By Green's theorem the integrals of r and r^3 over
+// the cross section are sums over its edges.
+static void revolvedProfile(const std::vector<ProfileVertex> &profile, double *volume, double *inertia)
+{
+	double dR2 = 0.0;
+	double dR4 = 0.0;
+	for (size_t i = 0; i + 1 < profile.size(); i += 2) {
+		double r0 = profile[i].dR;
+		double r1 = profile[i + 1].dR;
+		double dZ = profile[i + 1].dZ - profile[i].dZ;
+		dR2 += dZ * (r0 * r0 + r0 * r1 + r1 * r1) / 3.0;
+		dR4 += dZ * (r0 * r0 * r0 * r0 + r0 * r0 * r0 * r1 + r0 * r0 * r1 * r1 + r0 * r1 * r1 * r1 + r1 * r1 * r1 * r1) / 5.0;
+	}
+	// 2 pi times the integral of r dA, and of r^3 dA for the inertia.
+	*volume = fabs(M_PI * dR2);
+	*inertia = fabs(M_PI * 0.5 * dR4);
+}
+
+bool computeBearingProperties(const BearingGeometry &geometry, double millimetresPerUnit, double density, BearingProperties *properties)
+{
+	if (!properties || millimetresPerUnit <= 0.0 || geometry.iBallCount <= 0)
+		return false;
+
+	double dScale = millimetresPerUnit;
+	double dVolume = 0.0;
+	double dInertia = 0.0;
+	for (int iOuter = 0; iOuter < 2; ++iOuter) {
+		std::vector<ProfileVertex> profile;
+		buildRingProfile(geometry, iOuter != 0, kProfileSegments, &profile);
+		double dRingVolume, dRingInertia;
+		revolvedProfile(profile, &dRingVolume, &dRingInertia);
+		dVolume += dRingVolume;
+		dInertia += dRingInertia;
+	}
+	dVolume *= dScale * dScale * dScale;
+	dInertia *= dScale * dScale * dScale * dScale * dScale;
+
+	int iElements = geometry.iBallCount * geometry.iRowCount;
+	double dPitchRadius = geometry.dPitchRadius * dScale;
+	double dRadius = geometry.dBallRadius * dScale;
+	double dElementVolume, dElementInertia;
+	if (geometry.eElement == BallElement) {
+		dElementVolume = 4.0 / 3.0 * M_PI * dRadius * dRadius * dRadius;
+		dElementInertia = 0.4 * dElementVolume * dRadius * dRadius + dElementVolume * dPitchRadius * dPitchRadius;
+	}
+	else {
+		// Frustum of the roller, its inertia is taken as that of a cylinder of the middle radius.
+		dPitchRadius = geometry.roller.dCenterRadius * dScale;
+		double dLength = geometry.roller.dLength * dScale;
+		double dTaper = dLength * 0.5 * tan(geometry.roller.dTaperAngle);
+		double dLarge = dRadius + dTaper;
+		double dSmall = dRadius - dTaper;
+		dElementVolume = M_PI * dLength / 3.0 * (dLarge * dLarge + dLarge * dSmall + dSmall * dSmall);
+		double dAxial = 0.5 * dElementVolume * dRadius * dRadius;
+		double dTransverse = dElementVolume * (3.0 * dRadius * dRadius + dLength * dLength) / 12.0;
+		double dCos = cos(geometry.roller.dAxisAngle);
+		double dSin = sin(geometry.roller.dAxisAngle);
+		dElementInertia = dAxial * dCos * dCos + dTransverse * dSin * dSin + dElementVolume * dPitchRadius * dPitchRadius;
+	}
+	dVolume += iElements * dElementVolume;
+	dInertia += iElements * dElementInertia;
+
+	properties->dMass = dVolume * density;
+	properties->dInertia = dInertia * density;
+	properties->dPitchDiameter = 2.0 * dPitchRadius;
+	properties->iElementCount = iElements;
+
+	double dDiameter = 2.0 * dRadius;
+	double dCos = cos(geometry.dContactAngle);
+	double dRows = geometry.iRowCount;
+	double dCount = geometry.iBallCount;
+	double dGamma = dDiameter * dCos / properties->dPitchDiameter;
+	if (geometry.eElement != BallElement) {
+		// Radial roller bearings, bm = 1.1.
+		double dLength = geometry.roller.dLength * dScale;
+		properties->dDynamicLoadRating = 1.1 * tableFactor(kRadialRollerFc, dGamma) * pow(dRows * dLength * dCos, 7.0 / 9.0) *
+			pow(dCount, 0.75) * pow(dDiameter, 29.0 / 27.0);
+		properties->dStaticLoadRating = 44.0 * (1.0 - dGamma) * dRows * dCount * dLength * dDiameter * dCos;
+		return true;
+	}
+
+	// ISO 281 switches the ball diameter exponent above one inch, bm = 1.3 for ball bearings.
+	double dDiameterTerm = dDiameter <= 25.4 ? pow(dDiameter, 1.8) : 3.647 * pow(dDiameter, 1.4);
+	if (geometry.eFamily == ThrustBearing) {
+		dGamma = dDiameter / properties->dPitchDiameter;
+		properties->dDynamicLoadRating = 1.3 * tableFactor(kThrustBallFc, dGamma) * pow(dCount, 2.0 / 3.0) * dDiameterTerm;
+		properties->dStaticLoadRating = 61.6 * dCount * dDiameter * dDiameter;
+		return true;
+	}
+	properties->dDynamicLoadRating = 1.3 * tableFactor(kRadialBallFc, dGamma) * pow(dRows * dCos, 0.7) * pow(dCount, 2.0 / 3.0) * dDiameterTerm;
+	properties->dStaticLoadRating = tableFactor(kRadialBallF0, dGamma) * dRows * dCount * dDiameter * dDiameter * dCos;
+	return true;
+}
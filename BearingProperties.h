@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+
+#include "BearingGeometry.h"
+
+// Mass properties and basic load ratings of a bearing, computed in closed form
+// from its geometry instead of from the bodies of the model. Lengths are given
+// in millimetres, like the load rating formulas of ISO 281 and ISO 76 expect.
+struct BearingProperties
+{
+	// Rings and rolling elements in kg, the cage is left out.
+	double dMass;
+	// Moment of inertia about the bearing axis in kg mm^2.
+	double dInertia;
+	// Diameter of the circle through the centres of the rolling elements in mm.
+	double dPitchDiameter;
+	// Rolling elements of all rows.
+	int iElementCount;
+	// Basic dynamic and static load ratings C and C0 in N, radial for radial
+	// bearings and axial for thrust bearings.
+	double dDynamicLoadRating;
+	double dStaticLoadRating;
+};
+
+// Density of bearing steel in kg/mm^3.
+const double kBearingSteelDensity = 7.85e-6;
+
+// Millimetres per length unit for "mm", "cm", "m", "in" and "ft", 0 for other units.
+double unitsToMillimetres(const std::string &units);
+
+// The rings are integrated over their cross sections with the raceways cut,
+// the rolling elements are exact solids. The load ratings follow ISO 281 and
+// ISO 76 with the factors of the standard tables, so they are estimates for
+// bearings of usual proportions rather than catalogue values.
+bool computeBearingProperties(const BearingGeometry &geometry, double millimetresPerUnit, double density, BearingProperties *properties);
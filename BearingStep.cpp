@@ -0,0 +1,398 @@
+#include "BearingStep.h"
+
+#include <cmath>
+#include <ctime>
+
+#include "BearingPlacement.h"
+
+// Size of the stdio buffer of the writer.
+static const size_t kStepBufferSize = 1 << 20;
+
+// STEP reals need a decimal point, also in front of an exponent.
+static std::string real(double value)
+{
+	char buffer[32];
+	std::snprintf(buffer, sizeof(buffer), "%.15G", value);
+	std::string strValue = buffer;
+	size_t iExponent = strValue.find('E');
+	if (strValue.find('.') == std::string::npos)
+		strValue.insert(iExponent == std::string::npos ? strValue.size() : iExponent, ".");
+	return strValue;
+}
+
+static std::string ref(int id)
+{
+	return "#" + std::to_string(id);
+}
+
+static std::string text(const std::string &value)
+{
+	std::string strText = "'";
+	for (char c : value) {
+		if (c == '\'' || c == '\\')
+			strText += c;
+		strText += c;
+	}
+	return strText + "'";
+}
+
+static std::string triple(const double values[3])
+{
+	return "(" + real(values[0]) + "," + real(values[1]) + "," + real(values[2]) + ")";
+}
+
+static std::string list(const std::vector<int> &ids)
+{
+	std::string strList = "(";
+	for (size_t i = 0; i < ids.size(); ++i)
+		strList += (i > 0 ? "," : "") + ref(ids[i]);
+	return strList + ")";
+}
+
+// origin + r * reference + z * axis
+static void planePoint(const double origin[3], const double axis[3], const double reference[3], double r, double z, double point[3])
+{
+	for (int c = 0; c < 3; ++c)
+		point[c] = origin[c] + r * reference[c] + z * axis[c];
+}
+
+StepWriter::StepWriter()
+	: mpFile(nullptr), miNextId(1), miContext(0), miProductContext(0), miDefinitionContext(0)
+{
+}
+
+StepWriter::~StepWriter()
+{
+	if (mpFile)
+		close();
+}
+
+bool StepWriter::open(const std::string &path, const std::string &units)
+{
+	std::string strLengthUnit;
+	if (units == "mm")
+		strLengthUnit = "(LENGTH_UNIT()NAMED_UNIT(*)SI_UNIT(.MILLI.,.METRE.))";
+	else if (units == "cm")
+		strLengthUnit = "(LENGTH_UNIT()NAMED_UNIT(*)SI_UNIT(.CENTI.,.METRE.))";
+	else if (units == "m")
+		strLengthUnit = "(LENGTH_UNIT()NAMED_UNIT(*)SI_UNIT($,.METRE.))";
+	else if (units != "in")
+		return false;
+
+	mpFile = std::fopen(path.c_str(), "wb");
+	if (!mpFile)
+		return false;
+	std::setvbuf(mpFile, nullptr, _IOFBF, kStepBufferSize);
+	miNextId = 1;
+
+	char timeStamp[32];
+	std::time_t tNow = std::time(nullptr);
+	std::strftime(timeStamp, sizeof(timeStamp), "%Y-%m-%dT%H:%M:%S", std::gmtime(&tNow));
+	size_t iSlash = path.find_last_of("/\\");
+	std::string strName = iSlash == std::string::npos ? path : path.substr(iSlash + 1);
+
+	std::fputs("ISO-10303-21;\nHEADER;\nFILE_DESCRIPTION(('BallBearing solids'),'2;1');\n", mpFile);
+	std::fprintf(mpFile, "FILE_NAME(%s,'%s',(''),(''),'BallBearing','BallBearing','');\n", text(strName).c_str(), timeStamp);
+	std::fputs("FILE_SCHEMA(('AUTOMOTIVE_DESIGN { 1 0 10303 214 1 1 1 1 }'));\nENDSEC;\nDATA;\n", mpFile);
+
+	int iApplication = entity("APPLICATION_CONTEXT('automotive design')");
+	entity("APPLICATION_PROTOCOL_DEFINITION('international standard','automotive_design',2000," + ref(iApplication) + ")");
+	miProductContext = entity("PRODUCT_CONTEXT(''," + ref(iApplication) + ",'mechanical')");
+	miDefinitionContext = entity("PRODUCT_DEFINITION_CONTEXT('part definition'," + ref(iApplication) + ",'design')");
+
+	int iLength;
+	if (units == "in") {
+		int iMillimetre = entity("(LENGTH_UNIT()NAMED_UNIT(*)SI_UNIT(.MILLI.,.METRE.))");
+		int iFactor = entity("LENGTH_MEASURE_WITH_UNIT(LENGTH_MEASURE(25.4)," + ref(iMillimetre) + ")");
+		int iExponents = entity("DIMENSIONAL_EXPONENTS(1.,0.,0.,0.,0.,0.,0.)");
+		iLength = entity("(CONVERSION_BASED_UNIT('INCH'," + ref(iFactor) + ")LENGTH_UNIT()NAMED_UNIT(" + ref(iExponents) + "))");
+	}
+	else {
+		iLength = entity(strLengthUnit);
+	}
+	int iAngle = entity("(NAMED_UNIT(*)PLANE_ANGLE_UNIT()SI_UNIT($,.RADIAN.))");
+	int iSolidAngle = entity("(NAMED_UNIT(*)SI_UNIT($,.STERADIAN.)SOLID_ANGLE_UNIT())");
+	int iUncertainty = entity("UNCERTAINTY_MEASURE_WITH_UNIT(LENGTH_MEASURE(1.E-07)," + ref(iLength) + ",'distance_accuracy_value','confusion accuracy')");
+	miContext = entity("(GEOMETRIC_REPRESENTATION_CONTEXT(3)GLOBAL_UNCERTAINTY_ASSIGNED_CONTEXT((" + ref(iUncertainty) +
+		"))GLOBAL_UNIT_ASSIGNED_CONTEXT((" + ref(iLength) + "," + ref(iAngle) + "," + ref(iSolidAngle) + "))REPRESENTATION_CONTEXT('',''))");
+	return !std::ferror(mpFile);
+}
+
+bool StepWriter::write(const BearingGeometry &geometry, const std::string &name, double offsetX, double offsetY)
+{
+	if (!mpFile)
+		return false;
+
+	const double origin[3] = { offsetX, offsetY, 0.0 };
+	const double axisZ[3] = { 0.0, 0.0, 1.0 };
+	const double axisX[3] = { 1.0, 0.0, 0.0 };
+	// The outline height runs along -Z like in the build, see modelHeight.
+	const double outlineAxis[3] = { 0.0, 0.0, modelHeight(1.0) };
+
+	std::vector<int> items;
+	items.push_back(placement(origin, axisZ, axisX));
+
+	std::vector<ProfileSegment> outline;
+	for (int iRing = 0; iRing < 2; ++iRing) {
+		buildRingOutline(geometry, iRing == 1, &outline);
+		if (outline.size() < 3)
+			return false;
+		items.push_back(revolvedSolid(outline, origin, outlineAxis, axisX));
+	}
+
+	BallPlacement ballPlacement;
+	for (int iRow = 0; iRow < geometry.iRowCount; ++iRow) {
+		if (!placeRollingElements(geometry, iRow, &ballPlacement))
+			return false;
+		for (int i = 0; i < ballPlacement.iCount; ++i) {
+			if (geometry.eElement != BallElement) {
+				items.push_back(rollerSolid(geometry.roller, ballPlacement.dAngleStep * i, offsetX, offsetY));
+				continue;
+			}
+			double center[3] = { offsetX + ballPlacement.centersX[i], offsetY + ballPlacement.centersY[i], ballPlacement.dHeight };
+			items.push_back(sphereSolid(center, ballPlacement.dBallRadius));
+		}
+	}
+
+	int iRepresentation = entity("ADVANCED_BREP_SHAPE_REPRESENTATION(" + text(name) + "," + list(items) + "," + ref(miContext) + ")");
+	int iProduct = entity("PRODUCT(" + text(name) + "," + text(name) + ",''," + "(" + ref(miProductContext) + "))");
+	entity("PRODUCT_RELATED_PRODUCT_CATEGORY('part',$,(" + ref(iProduct) + "))");
+	int iFormation = entity("PRODUCT_DEFINITION_FORMATION('',''," + ref(iProduct) + ")");
+	int iDefinition = entity("PRODUCT_DEFINITION('design',''," + ref(iFormation) + "," + ref(miDefinitionContext) + ")");
+	int iShape = entity("PRODUCT_DEFINITION_SHAPE(''," + text(name) + "," + ref(iDefinition) + ")");
+	entity("SHAPE_DEFINITION_REPRESENTATION(" + ref(iShape) + "," + ref(iRepresentation) + ")");
+	return !std::ferror(mpFile);
+}
+
+bool StepWriter::close()
+{
+	if (!mpFile)
+		return false;
+
+	std::fputs("ENDSEC;\nEND-ISO-10303-21;\n", mpFile);
+	bool xResult = !std::ferror(mpFile);
+	xResult = (std::fclose(mpFile) == 0) && xResult;
+	mpFile = nullptr;
+	return xResult;
+}
+
+int StepWriter::entity(const std::string &text)
+{
+	std::fprintf(mpFile, "#%d=%s;\n", miNextId, text.c_str());
+	return miNextId++;
+}
+
+int StepWriter::point(const double position[3])
+{
+	return entity("CARTESIAN_POINT(''," + triple(position) + ")");
+}
+
+int StepWriter::direction(const double vector[3])
+{
+	return entity("DIRECTION(''," + triple(vector) + ")");
+}
+
+int StepWriter::placement(const double origin[3], const double axis[3], const double reference[3])
+{
+	int iOrigin = point(origin);
+	int iAxis = direction(axis);
+	int iReference = direction(reference);
+	return entity("AXIS2_PLACEMENT_3D(''," + ref(iOrigin) + "," + ref(iAxis) + "," + ref(iReference) + ")");
+}
+
+int StepWriter::vertex(const double position[3])
+{
+	int iPoint = point(position);
+	return entity("VERTEX_POINT(''," + ref(iPoint) + ")");
+}
+
+int StepWriter::circleEdge(const double origin[3], const double axis[3], const double reference[3], double radius, int *vertexId)
+{
+	double start[3];
+	planePoint(origin, axis, reference, radius, 0.0, start);
+	*vertexId = vertex(start);
+	int iCircle = entity("CIRCLE(''," + ref(placement(origin, axis, reference)) + "," + real(radius) + ")");
+	return entity("EDGE_CURVE(''," + ref(*vertexId) + "," + ref(*vertexId) + "," + ref(iCircle) + ",.T.)");
+}
+
+int StepWriter::loop(const std::vector<int> &edges, const std::vector<bool> &forward)
+{
+	std::vector<int> oriented(edges.size());
+	for (size_t i = 0; i < edges.size(); ++i)
+		oriented[i] = entity("ORIENTED_EDGE('',*,*," + ref(edges[i]) + (forward[i] ? ",.T.)" : ",.F.)"));
+	return entity("EDGE_LOOP(''," + list(oriented) + ")");
+}
+
+int StepWriter::face(const std::vector<int> &bounds, int surface, bool sameSense)
+{
+	return entity("ADVANCED_FACE(''," + list(bounds) + "," + ref(surface) + (sameSense ? ",.T.)" : ",.F.)"));
+}
+
+int StepWriter::revolvedSolid(const std::vector<ProfileSegment> &outline, const double origin[3], const double axis[3], const double reference[3])
+{
+	size_t iCount = outline.size();
+	double dSize = 0.0;
+	for (const ProfileSegment &segment : outline)
+		dSize = std::fmax(dSize, std::fmax(std::fabs(segment.dR0), std::fabs(segment.dZ0)));
+	double dTolerance = dSize * 1.0e-12;
+
+	// Every outline point off the axis turns into a circle with a vertex where
+	// it crosses the plane of the outline. Points on the axis only get a vertex
+	// if an edge ends there.
+	std::vector<int> circles(iCount, 0);
+	std::vector<int> vertices(iCount, 0);
+	for (size_t i = 0; i < iCount; ++i) {
+		if (outline[i].dR0 <= dTolerance)
+			continue;
+		double center[3];
+		planePoint(origin, axis, reference, 0.0, outline[i].dZ0, center);
+		circles[i] = circleEdge(center, axis, reference, outline[i].dR0, &vertices[i]);
+	}
+	auto outlineVertex = [&](size_t i) {
+		if (vertices[i] == 0) {
+			double position[3];
+			planePoint(origin, axis, reference, outline[i].dR0, outline[i].dZ0, position);
+			vertices[i] = vertex(position);
+		}
+		return vertices[i];
+	};
+
+	// The faces are parametrized by the angle around the axis and the way along
+	// the outline, which makes the outline direction the seam of each face and
+	// the normal of that parametrization the outward one.
+	std::vector<int> faces;
+	for (size_t i = 0; i < iCount; ++i) {
+		const ProfileSegment &segment = outline[i];
+		size_t j = (i + 1) % iCount;
+		double dDeltaR = segment.dR1 - segment.dR0;
+		double dDeltaZ = segment.dZ1 - segment.dZ0;
+		if (circles[i] == 0 && circles[j] == 0)
+			continue;
+
+		double start[3];
+		planePoint(origin, axis, reference, segment.dR0, segment.dZ0, start);
+
+		// Sides normal to the axis are annular planes bounded by their two circles.
+		if (!isProfileArc(segment) && std::fabs(dDeltaZ) <= dTolerance) {
+			std::vector<int> bounds;
+			int iOuter = segment.dR0 > segment.dR1 ? (int)i : (int)j;
+			for (size_t k : { i, j }) {
+				if (circles[k] == 0)
+					continue;
+				int iLoop = loop({ circles[k] }, { k == i });
+				bounds.push_back(entity(std::string((int)k == iOuter ? "FACE_OUTER_BOUND" : "FACE_BOUND") + "(''," + ref(iLoop) + ",.T.)"));
+			}
+			int iPlane = entity("PLANE(''," + ref(placement(start, axis, reference)) + ")");
+			faces.push_back(face(bounds, iPlane, dDeltaR < 0.0));
+			continue;
+		}
+
+		int iCurve;
+		int iSurface;
+		bool xSameSense;
+		if (isProfileArc(segment)) {
+			// Clockwise in the outline plane is counter clockwise around axis x reference.
+			double center[3], arcAxis[3], surfaceOrigin[3];
+			planePoint(origin, axis, reference, segment.circle.dCenterRadius, segment.circle.dCenterHeight, center);
+			arcAxis[0] = axis[1] * reference[2] - axis[2] * reference[1];
+			arcAxis[1] = axis[2] * reference[0] - axis[0] * reference[2];
+			arcAxis[2] = axis[0] * reference[1] - axis[1] * reference[0];
+			iCurve = entity("CIRCLE(''," + ref(placement(center, arcAxis, reference)) + "," + real(segment.circle.dRadius) + ")");
+			planePoint(origin, axis, reference, 0.0, segment.circle.dCenterHeight, surfaceOrigin);
+			iSurface = entity("TOROIDAL_SURFACE(''," + ref(placement(surfaceOrigin, axis, reference)) + "," +
+				real(segment.circle.dCenterRadius) + "," + real(segment.circle.dRadius) + ")");
+			// The material is outside of the raceway circle.
+			xSameSense = false;
+		}
+		else {
+			double dLength = std::sqrt(dDeltaR * dDeltaR + dDeltaZ * dDeltaZ);
+			double lineDirection[3];
+			for (int c = 0; c < 3; ++c)
+				lineDirection[c] = (dDeltaR * reference[c] + dDeltaZ * axis[c]) / dLength;
+			int iVector = entity("VECTOR(''," + ref(direction(lineDirection)) + "," + real(dLength) + ")");
+			iCurve = entity("LINE(''," + ref(point(start)) + "," + ref(iVector) + ")");
+			if (std::fabs(dDeltaR) <= dTolerance) {
+				iSurface = entity("CYLINDRICAL_SURFACE(''," + ref(placement(origin, axis, reference)) + "," + real(segment.dR0) + ")");
+			}
+			else {
+				// The cone axis points the way the radius grows.
+				double coneOrigin[3], coneAxis[3];
+				planePoint(origin, axis, reference, 0.0, segment.dZ0, coneOrigin);
+				double dSign = dDeltaR * dDeltaZ > 0.0 ? 1.0 : -1.0;
+				for (int c = 0; c < 3; ++c)
+					coneAxis[c] = dSign * axis[c];
+				iSurface = entity("CONICAL_SURFACE(''," + ref(placement(coneOrigin, coneAxis, reference)) + "," + real(segment.dR0) + "," +
+					real(std::atan(std::fabs(dDeltaR) / std::fabs(dDeltaZ))) + ")");
+			}
+			xSameSense = dDeltaZ > 0.0;
+		}
+
+		int iSeam = entity("EDGE_CURVE(''," + ref(outlineVertex(i)) + "," + ref(outlineVertex(j)) + "," + ref(iCurve) + ",.T.)");
+		std::vector<int> edges;
+		std::vector<bool> forward;
+		if (circles[i] != 0) {
+			edges.push_back(circles[i]);
+			forward.push_back(true);
+		}
+		edges.push_back(iSeam);
+		forward.push_back(true);
+		if (circles[j] != 0) {
+			edges.push_back(circles[j]);
+			forward.push_back(false);
+		}
+		edges.push_back(iSeam);
+		forward.push_back(false);
+		int iLoop = loop(edges, forward);
+		int iBound = entity("FACE_OUTER_BOUND(''," + ref(iLoop) + ",.T.)");
+		faces.push_back(face(std::vector<int>(1, iBound), iSurface, xSameSense));
+	}
+
+	int iShell = entity("CLOSED_SHELL(''," + list(faces) + ")");
+	return entity("MANIFOLD_SOLID_BREP(''," + ref(iShell) + ")");
+}
+
+int StepWriter::sphereSolid(const double center[3], double radius)
+{
+	// Two hemispheres on one spherical surface, split at the equator.
+	const double axisZ[3] = { 0.0, 0.0, 1.0 };
+	const double axisX[3] = { 1.0, 0.0, 0.0 };
+	int iSurface = entity("SPHERICAL_SURFACE(''," + ref(placement(center, axisZ, axisX)) + "," + real(radius) + ")");
+	int iVertex;
+	int iEquator = circleEdge(center, axisZ, axisX, radius, &iVertex);
+
+	std::vector<int> faces;
+	for (bool xUpper : { true, false }) {
+		int iLoop = loop({ iEquator }, { xUpper });
+		int iBound = entity("FACE_OUTER_BOUND(''," + ref(iLoop) + ",.T.)");
+		faces.push_back(face(std::vector<int>(1, iBound), iSurface, true));
+	}
+	int iShell = entity("CLOSED_SHELL(''," + list(faces) + ")");
+	return entity("MANIFOLD_SOLID_BREP(''," + ref(iShell) + ")");
+}
+
+int StepWriter::rollerSolid(const RollerProfile &roller, double angle, double offsetX, double offsetY)
+{
+	// Frame of the roller as in tessellateRoller: its axis towards the small
+	// end and the direction across it away from the bearing axis.
+	double dCosAngle = std::cos(angle);
+	double dSinAngle = std::sin(angle);
+	double dCosTilt = std::cos(roller.dAxisAngle);
+	double dSinTilt = std::sin(roller.dAxisAngle);
+	double axis[3] = { -dSinTilt * dCosAngle, -dSinTilt * dSinAngle, modelHeight(dCosTilt) };
+	double across[3] = { dCosTilt * dCosAngle, dCosTilt * dSinAngle, modelHeight(dSinTilt) };
+
+	double endsR[2], endsZ[2], radii[2];
+	rollerEnds(roller, endsR, endsZ, radii);
+	double origin[3] = { offsetX + endsR[0] * dCosAngle, offsetY + endsR[0] * dSinAngle, modelHeight(endsZ[0]) };
+	double dLength = std::sqrt((endsR[1] - endsR[0]) * (endsR[1] - endsR[0]) + (endsZ[1] - endsZ[0]) * (endsZ[1] - endsZ[0]));
+
+	// Large end face, mantle and small end face, closed along the roller axis.
+	RacewayCircle line = { 0.0, 0.0, 0.0 };
+	std::vector<ProfileSegment> outline = {
+		{ 0.0, 0.0, radii[0], 0.0, line },
+		{ radii[0], 0.0, radii[1], dLength, line },
+		{ radii[1], dLength, 0.0, dLength, line },
+		{ 0.0, dLength, 0.0, 0.0, line }
+	};
+	return revolvedSolid(outline, origin, axis, across);
+}
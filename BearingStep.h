@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "BearingGeometry.h"
+#include "BearingMesh.h"
+
+// Writes bearings as exact solids to a STEP AP214 file, without Fusion and
+// without a modelling kernel. The rings are revolved from their cross section
+// outline, so the raceways become tori, the bores and shoulders cylinders and
+// cones and the sides planes. Balls are spheres and rollers revolved frustums.
+// Fillets and the cage are left out, like in the meshes.
+//
+// Every entity is written as soon as it is known, through a large stdio
+// buffer, so the memory use does not grow with the number of bearings. Each
+// bearing is a product of its own with one solid per ring and rolling element,
+// so a whole catalog can go into one multi part file.
+class StepWriter
+{
+public:
+	StepWriter();
+	~StepWriter();
+
+	// Units of all lengths: mm, cm, m or in.
+	bool open(const std::string &path, const std::string &units = "mm");
+	// Appends the bearing as a product with the name, moved by the offset in the XY plane.
+	bool write(const BearingGeometry &geometry, const std::string &name, double offsetX, double offsetY);
+	bool close();
+
+private:
+	StepWriter(const StepWriter &) = delete;
+	StepWriter &operator=(const StepWriter &) = delete;
+
+	// Writes "#id=text;" and returns the id.
+	int entity(const std::string &text);
+	int point(const double position[3]);
+	int direction(const double vector[3]);
+	int placement(const double origin[3], const double axis[3], const double reference[3]);
+	int vertex(const double position[3]);
+	// Closed edge around a circle of the radius in the plane of the placement.
+	int circleEdge(const double origin[3], const double axis[3], const double reference[3], double radius, int *vertexId);
+	// Edge loop through the edges, each one used along or against its curve.
+	int loop(const std::vector<int> &edges, const std::vector<bool> &forward);
+	int face(const std::vector<int> &bounds, int surface, bool sameSense);
+
+	// Solid of revolution of a closed outline in the plane of the reference
+	// direction and the axis, r along the reference direction and z along the axis.
+	int revolvedSolid(const std::vector<ProfileSegment> &outline, const double origin[3], const double axis[3], const double reference[3]);
+	int sphereSolid(const double center[3], double radius);
+	int rollerSolid(const RollerProfile &roller, double angle, double offsetX, double offsetY);
+
+	FILE *mpFile;
+	int miNextId;
+	int miContext;
+	int miProductContext;
+	int miDefinitionContext;
+};
@@ -0,0 +1,208 @@
+#include "BearingSweep.h"
+
+#include <algorithm>
+#include <chrono>
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include "BearingPlacement.h"
+#include "BearingProperties.h"
+#include "BearingThreadPool.h"
+
+SweepRanges defaultSweepRanges()
+{
+	SweepRanges ranges;
+	ranges.iBallRadiusSteps = 64;
+	ranges.iRingWidthSteps = 32;
+	ranges.iClearanceSteps = 8;
+	ranges.iBallCountSteps = 16;
+	ranges.dMaxClearance = 0.08;
+	ranges.dMinBallGap = 0.0;
+	ranges.dDensity = kBearingSteelDensity;
+	return ranges;
+}
+
+// Volume that a raceway circle removes from a ring when it cuts past the ring side.
+// distance is between the circle centre and the ring side, pitchRadius is the
+// radius of the circle centre and the sign tells on which side the ring is.
+static double racewayGrooveVolume(double racewayRadius, double distance, double pitchRadius, double side)
+{
+	if (distance >= racewayRadius)
+		return 0.0;
+	double dHalfChord = sqrt(racewayRadius * racewayRadius - distance * distance);
+	double dArea = racewayRadius * racewayRadius * acos(distance / racewayRadius) - distance * dHalfChord;
+	double dCentroid = 2.0 * dHalfChord * dHalfChord * dHalfChord / (3.0 * dArea);
+	return 2.0 * M_PI * (pitchRadius + side * dCentroid) * dArea;
+}
+
+bool evaluateSweepCandidate(double innerDiameter, double outerDiameter, double thickness, double density,
+	const SweepCandidate &candidate, SweepScore *score)
+{
+	double dInnerRadius = innerDiameter * 0.5;
+	double dOuterRadius = outerDiameter * 0.5;
+	double dPitchRadius = (dInnerRadius + dOuterRadius) * 0.5;
+	double dBallRadius = candidate.dBallRadius;
+	double dRacewayRadius = dBallRadius * (1.0 + candidate.dRacewayClearance);
+	double dInnerRingMax = dInnerRadius + candidate.dRingWidth;
+	double dOuterRingMin = dOuterRadius - candidate.dRingWidth;
+
+	// The balls have to stay within the width and the rings must not touch.
+	if (dBallRadius <= 0.0 || 2.0 * dBallRadius >= thickness || dInnerRingMax >= dOuterRingMin)
+		return false;
+	// Both raceways need to be cut into the rings without breaking through the sides.
+	double dDistance = dPitchRadius - dInnerRingMax;
+	if (dDistance >= dRacewayRadius || dRacewayRadius * dRacewayRadius - dDistance * dDistance >= thickness * thickness * 0.25)
+		return false;
+
+	double dMinWall = std::min(dPitchRadius - dRacewayRadius - dInnerRadius, dOuterRadius - dPitchRadius - dRacewayRadius);
+	if (dMinWall <= 0.0)
+		return false;
+
+	// Neighbouring balls may not overlap.
+	if (candidate.iBallCount < 3 || 2.0 * dPitchRadius * sin(M_PI / candidate.iBallCount) <= 2.0 * dBallRadius)
+		return false;
+
+	double dRings = M_PI * thickness * (dInnerRingMax * dInnerRingMax - dInnerRadius * dInnerRadius
+		+ dOuterRadius * dOuterRadius - dOuterRingMin * dOuterRingMin);
+	dRings -= racewayGrooveVolume(dRacewayRadius, dPitchRadius - dInnerRingMax, dPitchRadius, -1.0);
+	dRings -= racewayGrooveVolume(dRacewayRadius, dOuterRingMin - dPitchRadius, dPitchRadius, 1.0);
+	double dBalls = candidate.iBallCount * 4.0 / 3.0 * M_PI * dBallRadius * dBallRadius * dBallRadius;
+
+	// ISO 281 switches the ball diameter exponent above one inch.
+	double dBallDiameter = 2.0 * dBallRadius;
+	double dDiameterTerm = dBallDiameter <= 25.4 ? pow(dBallDiameter, 1.8) : 3.647 * pow(dBallDiameter, 1.4);
+
+	score->dLoadRating = pow((double)candidate.iBallCount, 2.0 / 3.0) * dDiameterTerm;
+	score->dMass = (dRings + dBalls) * density;
+	score->dMinWall = dMinWall;
+	return true;
+}
+
+bool dominates(const SweepScore &a, const SweepScore &b)
+{
+	if (a.dLoadRating < b.dLoadRating || a.dMass > b.dMass || a.dMinWall < b.dMinWall)
+		return false;
+	return a.dLoadRating > b.dLoadRating || a.dMass < b.dMass || a.dMinWall > b.dMinWall;
+}
+
+void extractParetoFront(std::vector<SweepResult> *results)
+{
+	// After sorting by falling load rating a result can only be dominated by one
+	// before it, that is by one with no more mass and at least the same wall.
+	// A Fenwick tree over the mass ranks keeps the best wall seen so far.
+	std::sort(results->begin(), results->end(), [](const SweepResult &a, const SweepResult &b) {
+		if (a.score.dLoadRating != b.score.dLoadRating)
+			return a.score.dLoadRating > b.score.dLoadRating;
+		if (a.score.dMass != b.score.dMass)
+			return a.score.dMass < b.score.dMass;
+		return a.score.dMinWall > b.score.dMinWall;
+	});
+
+	std::vector<double> masses;
+	masses.reserve(results->size());
+	for (const SweepResult &result : *results)
+		masses.push_back(result.score.dMass);
+	std::sort(masses.begin(), masses.end());
+	masses.erase(std::unique(masses.begin(), masses.end()), masses.end());
+
+	std::vector<double> bestWall(masses.size() + 1, -HUGE_VAL);
+	size_t iKept = 0;
+	for (size_t i = 0; i < results->size(); ++i) {
+		const SweepScore &score = (*results)[i].score;
+		size_t iRank = (std::lower_bound(masses.begin(), masses.end(), score.dMass) - masses.begin()) + 1;
+
+		double dWall = -HUGE_VAL;
+		for (size_t k = iRank; k > 0; k -= k & (~k + 1))
+			dWall = std::max(dWall, bestWall[k]);
+		if (dWall >= score.dMinWall)
+			continue;
+
+		for (size_t k = iRank; k < bestWall.size(); k += k & (~k + 1))
+			bestWall[k] = std::max(bestWall[k], score.dMinWall);
+		(*results)[iKept++] = (*results)[i];
+	}
+	results->resize(iKept);
+}
+
+bool sweepBearing(double innerDiameter, double outerDiameter, double thickness, const SweepRanges &ranges, int threads,
+	std::vector<SweepResult> *front, SweepStats *stats)
+{
+	if (innerDiameter < 0.0 || innerDiameter >= outerDiameter || thickness <= 0.0)
+		return false;
+	if (ranges.iBallRadiusSteps < 1 || ranges.iRingWidthSteps < 1 || ranges.iClearanceSteps < 1 || ranges.iBallCountSteps < 1)
+		return false;
+
+	std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+
+	double dGap = (outerDiameter - innerDiameter) * 0.5;
+	double dPitchRadius = (outerDiameter + innerDiameter) * 0.25;
+	double dMaxBallRadius = std::min(dGap, thickness) * 0.5;
+
+	WorkStealingPool pool(threads);
+	std::vector<std::vector<SweepResult>> localResults(pool.threadCount());
+	std::vector<long long> localEvaluated(pool.threadCount(), 0);
+	std::vector<long long> localFeasible(pool.threadCount(), 0);
+
+	// One task per ball radius and ring width, the clearances and counts are looped inside.
+	size_t iTasks = (size_t)ranges.iBallRadiusSteps * ranges.iRingWidthSteps;
+	pool.run(iTasks, [&](size_t task, int worker) {
+		int iBallRadiusStep = (int)(task / ranges.iRingWidthSteps);
+		int iRingWidthStep = (int)(task % ranges.iRingWidthSteps);
+
+		SweepCandidate candidate;
+		candidate.dBallRadius = dMaxBallRadius * (iBallRadiusStep + 1) / (ranges.iBallRadiusSteps + 1);
+		candidate.dRingWidth = dGap * 0.5 * (iRingWidthStep + 1) / (ranges.iRingWidthSteps + 1);
+
+		int iMaxCount = computeBallCountWithClearance(dPitchRadius, candidate.dBallRadius, ranges.dMinBallGap);
+		if (iMaxCount < 3)
+			return;
+		int iMinCount = std::max(3, iMaxCount / 2);
+		int iCountSpan = iMaxCount - iMinCount;
+
+		std::vector<SweepResult> &feasible = localResults[worker];
+		long long iEvaluated = 0;
+		long long iFeasible = 0;
+		for (int c = 0; c < ranges.iClearanceSteps; ++c) {
+			candidate.dRacewayClearance = ranges.iClearanceSteps == 1 ? 0.0 : ranges.dMaxClearance * c / (ranges.iClearanceSteps - 1);
+			int iLastCount = -1;
+			for (int n = 0; n < ranges.iBallCountSteps; ++n) {
+				candidate.iBallCount = iMaxCount - (ranges.iBallCountSteps == 1 ? 0 : iCountSpan * n / (ranges.iBallCountSteps - 1));
+				if (candidate.iBallCount == iLastCount)
+					continue;
+				iLastCount = candidate.iBallCount;
+
+				++iEvaluated;
+				SweepResult result;
+				result.candidate = candidate;
+				if (!evaluateSweepCandidate(innerDiameter, outerDiameter, thickness, ranges.dDensity, candidate, &result.score))
+					continue;
+				++iFeasible;
+				feasible.push_back(result);
+			}
+		}
+		localEvaluated[worker] += iEvaluated;
+		localFeasible[worker] += iFeasible;
+
+		// Thin out the worker's results now and then to bound the memory.
+		if (feasible.size() > (1u << 20))
+			extractParetoFront(&feasible);
+	});
+
+	front->clear();
+	long long iEvaluated = 0;
+	long long iFeasible = 0;
+	for (int w = 0; w < pool.threadCount(); ++w) {
+		front->insert(front->end(), localResults[w].begin(), localResults[w].end());
+		iEvaluated += localEvaluated[w];
+		iFeasible += localFeasible[w];
+	}
+	extractParetoFront(front);
+
+	if (stats) {
+		stats->iEvaluated = iEvaluated;
+		stats->iFeasible = iFeasible;
+		stats->dSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+	}
+	return true;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+
+// Design variables of one bearing candidate within a fixed envelope.
+struct SweepCandidate
+{
+	double dBallRadius;
+	double dRingWidth;
+	// Raceway radius is the ball radius times (1 + clearance).
+	double dRacewayClearance;
+	int iBallCount;
+};
+
+// Figures of merit of a candidate. Load rating and wall thickness are to be
+// maximized, the mass minimized.
+struct SweepScore
+{
+	// Basic dynamic load rating proxy after ISO 281, Z^(2/3) * Dw^1.8 with Dw in mm.
+	double dLoadRating;
+	double dMass;
+	double dMinWall;
+};
+
+struct SweepResult
+{
+	SweepCandidate candidate;
+	SweepScore score;
+};
+
+// Grid explored by sweepBearing. Ball radius and ring width are spread over
+// fractions of the room available for them, the ball count runs down from the
+// largest count that keeps the minimum ball gap.
+struct SweepRanges
+{
+	int iBallRadiusSteps;
+	int iRingWidthSteps;
+	int iClearanceSteps;
+	int iBallCountSteps;
+	// Largest raceway clearance as a fraction of the ball radius.
+	double dMaxClearance;
+	// Smallest gap between neighbouring balls.
+	double dMinBallGap;
+	// Material density used for the mass, in mass per cubed length unit.
+	double dDensity;
+};
+
+struct SweepStats
+{
+	long long iEvaluated;
+	long long iFeasible;
+	double dSeconds;
+};
+
+SweepRanges defaultSweepRanges();
+
+// Scores one candidate. Returns false if the candidate cannot be built, for
+// example because the raceway does not reach a ring or the rings touch.
+bool evaluateSweepCandidate(double innerDiameter, double outerDiameter, double thickness, double density,
+	const SweepCandidate &candidate, SweepScore *score);
+
+// True if a is at least as good as b in every score and better in one.
+bool dominates(const SweepScore &a, const SweepScore &b);
+
+// Keeps only the results that no other result dominates, sorted by falling load
+// rating. Results with identical scores are kept once.
+void extractParetoFront(std::vector<SweepResult> *results);
+
+// Evaluates the whole grid on threads threads (0 for all cores) and returns the Pareto front.
+bool sweepBearing(double innerDiameter, double outerDiameter, double thickness, const SweepRanges &ranges, int threads,
+	std::vector<SweepResult> *front, SweepStats *stats);
@@ -0,0 +1,61 @@
+#include "BearingThreadPool.h"
+
+#include <thread>
+
+WorkStealingPool::WorkStealingPool(int threads)
+{
+	if (threads <= 0)
+		threads = (int)std::thread::hardware_concurrency();
+	miThreads = threads > 0 ? threads : 1;
+	mQueues = std::vector<WorkQueue>(miThreads);
+}
+
+bool WorkStealingPool::popLocal(int worker, size_t *task)
+{
+	WorkQueue &queue = mQueues[worker];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.tasks.empty())
+		return false;
+	*task = queue.tasks.back();
+	queue.tasks.pop_back();
+	return true;
+}
+
+bool WorkStealingPool::steal(int worker, size_t *task)
+{
+	for (int i = 1; i < miThreads; ++i) {
+		WorkQueue &queue = mQueues[(worker + i) % miThreads];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty()) {
+			*task = queue.tasks.front();
+			queue.tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void WorkStealingPool::run(size_t count, const std::function<void(size_t, int)> &task)
+{
+	// Deal the tasks out in contiguous blocks so that neighbouring tasks stay on one worker.
+	for (int w = 0; w < miThreads; ++w) {
+		size_t iBegin = count * w / miThreads;
+		size_t iEnd = count * (w + 1) / miThreads;
+		std::lock_guard<std::mutex> lock(mQueues[w].mutex);
+		for (size_t i = iEnd; i > iBegin; --i)
+			mQueues[w].tasks.push_back(i - 1);
+	}
+
+	auto work = [&](int worker) {
+		size_t iTask;
+		while (popLocal(worker, &iTask) || steal(worker, &iTask))
+			task(iTask, worker);
+	};
+
+	std::vector<std::thread> threads;
+	for (int w = 1; w < miThreads; ++w)
+		threads.emplace_back(work, w);
+	work(0);
+	for (std::thread &thread : threads)
+		thread.join();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Runs a batch of independent tasks on all cores. Every worker owns a deque of
+// task indices, takes work from the back of its own deque and steals from the
+// front of the others once it runs dry, so uneven tasks still keep all cores busy.
+class WorkStealingPool
+{
+public:
+	// 0 threads uses one per hardware thread.
+	explicit WorkStealingPool(int threads = 0);
+
+	int threadCount() const { return miThreads; }
+
+	// Calls task(index, worker) once for every index below count and returns
+	// when all calls have finished. Worker is in [0, threadCount()).
+	void run(size_t count, const std::function<void(size_t, int)> &task);
+
+private:
+	struct WorkQueue
+	{
+		std::mutex mutex;
+		std::deque<size_t> tasks;
+	};
+
+	bool popLocal(int worker, size_t *task);
+	bool steal(int worker, size_t *task);
+
+	int miThreads;
+	std::vector<WorkQueue> mQueues;
+};
@@ -0,0 +1,53 @@
+#include "BearingTrace.h"
+
+#include <cstdio>
+
+BuildTrace::BuildTrace()
+	: mtOrigin(Clock::now()), miThread(0)
+{
+}
+
+void BuildTrace::clear()
+{
+	mEvents.clear();
+	mtOrigin = Clock::now();
+	miThread = 0;
+}
+
+void BuildTrace::addEvent(const char *name, Clock::time_point start, Clock::time_point end)
+{
+	Event event;
+	event.strName = name;
+	event.iThread = miThread;
+	event.dStartUs = std::chrono::duration<double, std::micro>(start - mtOrigin).count();
+	event.dDurationUs = std::chrono::duration<double, std::micro>(end - start).count();
+	mEvents.push_back(event);
+}
+
+double BuildTrace::totalSeconds(const char *name) const
+{
+	double dTotalUs = 0.0;
+	for (const Event &event : mEvents) {
+		if (event.strName == name)
+			dTotalUs += event.dDurationUs;
+	}
+	return dTotalUs * 1.0e-6;
+}
+
+bool BuildTrace::writeChromeTrace(const std::string &path) const
+{
+	FILE *pFile = std::fopen(path.c_str(), "wb");
+	if (!pFile)
+		return false;
+
+	std::fprintf(pFile, "{\"traceEvents\":[");
+	for (size_t i = 0; i < mEvents.size(); ++i) {
+		const Event &event = mEvents[i];
+		// Stage names are fixed identifiers, they never need escaping.
+		std::fprintf(pFile, "%s\n{\"name\":\"%s\",\"cat\":\"bearing\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+			i == 0 ? "" : ",", event.strName.c_str(), event.iThread, event.dStartUs, event.dDurationUs);
+	}
+	std::fprintf(pFile, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	return std::fclose(pFile) == 0;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Collects timed build stages and writes them in the Chrome trace event
+// format, so a build can be inspected in chrome://tracing or Perfetto.
+class BuildTrace
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	BuildTrace();
+
+	void clear();
+	// Events recorded afterwards are shown on this row of the trace.
+	void setThread(int thread) { miThread = thread; }
+	void addEvent(const char *name, Clock::time_point start, Clock::time_point end);
+
+	// Total time spent in all events with the given name, in seconds.
+	double totalSeconds(const char *name) const;
+
+	bool writeChromeTrace(const std::string &path) const;
+
+private:
+	struct Event
+	{
+		std::string strName;
+		int iThread;
+		double dStartUs;
+		double dDurationUs;
+	};
+
+	Clock::time_point mtOrigin;
+	int miThread;
+	std::vector<Event> mEvents;
+};
+
+// Times the enclosing scope as one stage. Does nothing without a trace.
+class ScopedStage
+{
+public:
+	ScopedStage(BuildTrace *trace, const char *name)
+		: mpTrace(trace), mpName(name)
+	{
+		if (mpTrace)
+			mtStart = BuildTrace::Clock::now();
+	}
+	~ScopedStage()
+	{
+		if (mpTrace)
+			mpTrace->addEvent(mpName, mtStart, BuildTrace::Clock::now());
+	}
+
+private:
+	ScopedStage(const ScopedStage &) = delete;
+	ScopedStage &operator=(const ScopedStage &) = delete;
+
+	BuildTrace *mpTrace;
+	const char *mpName;
+	BuildTrace::Clock::time_point mtStart;
+};
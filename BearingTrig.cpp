@@ -0,0 +1,151 @@
+#include "BearingTrig.h"
+
+#include <cmath>
+
+#if !defined(BEARING_NO_SIMD) && defined(__AVX2__)
+#define BEARING_SINCOS_AVX2
+#include <immintrin.h>
+#elif !defined(BEARING_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__aarch64__)
+#define BEARING_SINCOS_NEON
+#include <arm_neon.h>
+#endif
+
+// The angle is reduced to r = x - q * PI / 2 with |r| <= PI / 4, PI / 2 is split in
+// three parts so that the reduction stays exact. Minimax polynomials (Cephes) then
+// give sin(r) and cos(r), and the quadrant q selects and signs the result.
+static const float kTwoOverPi = 0.636619772367581f;
+static const float kHalfPi1 = 1.5703125f;
+static const float kHalfPi2 = 4.837512969970703125e-4f;
+static const float kHalfPi3 = 7.54978995489188216e-8f;
+static const float kSin1 = -1.6666654611e-1f;
+static const float kSin2 = 8.3321608736e-3f;
+static const float kSin3 = -1.9515295891e-4f;
+static const float kCos1 = 4.166664568298827e-2f;
+static const float kCos2 = -1.388731625493765e-3f;
+static const float kCos3 = 2.443315711809948e-5f;
+
+static inline void sinCosScalar(float angle, float *sine, float *cosine)
+{
+	float q = std::nearbyint(angle * kTwoOverPi);
+	float r = ((angle - q * kHalfPi1) - q * kHalfPi2) - q * kHalfPi3;
+	float r2 = r * r;
+	float s = r + r * r2 * (kSin1 + r2 * (kSin2 + r2 * kSin3));
+	float c = 1.0f - 0.5f * r2 + r2 * r2 * (kCos1 + r2 * (kCos2 + r2 * kCos3));
+
+	int iQuadrant = (int)q & 3;
+	float dSin = (iQuadrant & 1) ? c : s;
+	float dCos = (iQuadrant & 1) ? s : c;
+	*sine = (iQuadrant & 2) ? -dSin : dSin;
+	*cosine = ((iQuadrant + 1) & 2) ? -dCos : dCos;
+}
+
+void computeSinCosScalar(const float *angles, size_t count, float *sines, float *cosines)
+{
+	for (size_t i = 0; i < count; ++i)
+		sinCosScalar(angles[i], sines + i, cosines + i);
+}
+
+#if defined(BEARING_SINCOS_AVX2)
+
+void computeSinCos(const float *angles, size_t count, float *sines, float *cosines)
+{
+	const __m256 vTwoOverPi = _mm256_set1_ps(kTwoOverPi);
+	const __m256 vHalfPi1 = _mm256_set1_ps(kHalfPi1);
+	const __m256 vHalfPi2 = _mm256_set1_ps(kHalfPi2);
+	const __m256 vHalfPi3 = _mm256_set1_ps(kHalfPi3);
+	const __m256 vOne = _mm256_set1_ps(1.0f);
+	const __m256 vHalf = _mm256_set1_ps(0.5f);
+	const __m256 vSignMask = _mm256_set1_ps(-0.0f);
+	const __m256i vOneI = _mm256_set1_epi32(1);
+	const __m256i vTwoI = _mm256_set1_epi32(2);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256 x = _mm256_loadu_ps(angles + i);
+		__m256 q = _mm256_round_ps(_mm256_mul_ps(x, vTwoOverPi), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+		__m256 r = _mm256_sub_ps(x, _mm256_mul_ps(q, vHalfPi1));
+		r = _mm256_sub_ps(r, _mm256_mul_ps(q, vHalfPi2));
+		r = _mm256_sub_ps(r, _mm256_mul_ps(q, vHalfPi3));
+		__m256 r2 = _mm256_mul_ps(r, r);
+
+		__m256 s = _mm256_add_ps(_mm256_set1_ps(kSin2), _mm256_mul_ps(r2, _mm256_set1_ps(kSin3)));
+		s = _mm256_add_ps(_mm256_set1_ps(kSin1), _mm256_mul_ps(r2, s));
+		s = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, r2), s));
+
+		__m256 c = _mm256_add_ps(_mm256_set1_ps(kCos2), _mm256_mul_ps(r2, _mm256_set1_ps(kCos3)));
+		c = _mm256_add_ps(_mm256_set1_ps(kCos1), _mm256_mul_ps(r2, c));
+		c = _mm256_add_ps(_mm256_sub_ps(vOne, _mm256_mul_ps(vHalf, r2)), _mm256_mul_ps(_mm256_mul_ps(r2, r2), c));
+
+		__m256i iQuadrant = _mm256_cvtps_epi32(q);
+		__m256 xSwap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(iQuadrant, vOneI), vOneI));
+		__m256 vSin = _mm256_blendv_ps(s, c, xSwap);
+		__m256 vCos = _mm256_blendv_ps(c, s, xSwap);
+		__m256 vSinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(iQuadrant, vTwoI), 30));
+		__m256 vCosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(iQuadrant, vOneI), vTwoI), 30));
+		_mm256_storeu_ps(sines + i, _mm256_xor_ps(vSin, _mm256_and_ps(vSinSign, vSignMask)));
+		_mm256_storeu_ps(cosines + i, _mm256_xor_ps(vCos, _mm256_and_ps(vCosSign, vSignMask)));
+	}
+	computeSinCosScalar(angles + i, count - i, sines + i, cosines + i);
+}
+
+const char *sinCosBackend()
+{
+	return "AVX2";
+}
+
+#elif defined(BEARING_SINCOS_NEON)
+
+void computeSinCos(const float *angles, size_t count, float *sines, float *cosines)
+{
+	const float32x4_t vHalf = vdupq_n_f32(0.5f);
+	const float32x4_t vOne = vdupq_n_f32(1.0f);
+	const int32x4_t vOneI = vdupq_n_s32(1);
+	const int32x4_t vTwoI = vdupq_n_s32(2);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		float32x4_t x = vld1q_f32(angles + i);
+		int32x4_t iQuadrant = vcvtnq_s32_f32(vmulq_n_f32(x, kTwoOverPi));
+		float32x4_t q = vcvtq_f32_s32(iQuadrant);
+		float32x4_t r = vsubq_f32(x, vmulq_n_f32(q, kHalfPi1));
+		r = vsubq_f32(r, vmulq_n_f32(q, kHalfPi2));
+		r = vsubq_f32(r, vmulq_n_f32(q, kHalfPi3));
+		float32x4_t r2 = vmulq_f32(r, r);
+
+		float32x4_t s = vaddq_f32(vdupq_n_f32(kSin2), vmulq_n_f32(r2, kSin3));
+		s = vaddq_f32(vdupq_n_f32(kSin1), vmulq_f32(r2, s));
+		s = vaddq_f32(r, vmulq_f32(vmulq_f32(r, r2), s));
+
+		float32x4_t c = vaddq_f32(vdupq_n_f32(kCos2), vmulq_n_f32(r2, kCos3));
+		c = vaddq_f32(vdupq_n_f32(kCos1), vmulq_f32(r2, c));
+		c = vaddq_f32(vsubq_f32(vOne, vmulq_f32(vHalf, r2)), vmulq_f32(vmulq_f32(r2, r2), c));
+
+		uint32x4_t xSwap = vceqq_s32(vandq_s32(iQuadrant, vOneI), vOneI);
+		float32x4_t vSin = vbslq_f32(xSwap, c, s);
+		float32x4_t vCos = vbslq_f32(xSwap, s, c);
+		uint32x4_t vSinSign = vshlq_n_u32(vreinterpretq_u32_s32(vandq_s32(iQuadrant, vTwoI)), 30);
+		uint32x4_t vCosSign = vshlq_n_u32(vreinterpretq_u32_s32(vandq_s32(vaddq_s32(iQuadrant, vOneI), vTwoI)), 30);
+		vst1q_f32(sines + i, vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vSin), vSinSign)));
+		vst1q_f32(cosines + i, vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vCos), vCosSign)));
+	}
+	computeSinCosScalar(angles + i, count - i, sines + i, cosines + i);
+}
+
+const char *sinCosBackend()
+{
+	return "NEON";
+}
+
+#else
+
+void computeSinCos(const float *angles, size_t count, float *sines, float *cosines)
+{
+	computeSinCosScalar(angles, count, sines, cosines);
+}
+
+const char *sinCosBackend()
+{
+	return "scalar";
+}
+
+#endif
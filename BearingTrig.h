@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+// Sine and cosine of many angles at once, used for the tessellation tables.
+// The angles are expected to be within a few turns of zero. The build picks
+// AVX2 or NEON when the compiler targets them, defining BEARING_NO_SIMD forces
+// the scalar code. All variants evaluate the same polynomials, so they agree
+// to within rounding of the individual operations.
+void computeSinCos(const float *angles, size_t count, float *sines, float *cosines);
+
+// Portable reference implementation of computeSinCos.
+void computeSinCosScalar(const float *angles, size_t count, float *sines, float *cosines);
+
+// Name of the instruction set used by computeSinCos.
+const char *sinCosBackend();
@@ -0,0 +1,302 @@
+#include "BearingValidation.h"
+
+#include <algorithm>
+#include <climits>
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+std::string BearingValidation::message() const
+{
+	std::string strMessage;
+	for (const std::string &error : errors)
+		strMessage += error + "\n";
+	for (const std::string &correction : corrections)
+		strMessage += correction + "\n";
+	if (!strMessage.empty())
+		strMessage.pop_back();
+	return strMessage;
+}
+
+static double ballGap(double pitchRadius, double ballRadius, int ballCount)
+{
+	if (ballCount < 2)
+		return 2.0 * pitchRadius;
+	return 2.0 * pitchRadius * sin(M_PI / ballCount) - 2.0 * ballRadius;
+}
+
+// Side of a ring that faces the balls, found from where the raceway centre lies.
+// Radial bearings cut their raceways into the cylindrical sides of the rings,
+// thrust bearings into the flat faces of the washers.
+struct RingSide
+{
+	bool xAxial;
+	// Distance of the raceway centre from the side, negative if it lies in the ring.
+	double dDistance;
+	// Ring material behind the side.
+	double dDepth;
+	// Extent of the side and the positions of the raceway centres along it.
+	double dLow;
+	double dHigh;
+	double dRaceways[kMaxBallRows];
+};
+
+static RingSide facingSide(const BearingGeometry &geometry, const RingProfile &ring)
+{
+	const RacewayCircle &raceway = geometry.raceway;
+	double dLowZ = ring.dCenterHeight - ring.dHalfThickness;
+	double dHighZ = ring.dCenterHeight + ring.dHalfThickness;
+
+	RingSide side;
+	side.xAxial = raceway.dCenterRadius >= ring.dRadiusMin && raceway.dCenterRadius <= ring.dRadiusMax &&
+		(raceway.dCenterHeight > dHighZ || raceway.dCenterHeight < dLowZ);
+	if (side.xAxial) {
+		side.dDistance = raceway.dCenterHeight > dHighZ ? raceway.dCenterHeight - dHighZ : dLowZ - raceway.dCenterHeight;
+		side.dDepth = ring.dHalfThickness * 2.0;
+		side.dLow = ring.dRadiusMin;
+		side.dHigh = ring.dRadiusMax;
+		for (int i = 0; i < geometry.iRowCount; ++i)
+			side.dRaceways[i] = raceway.dCenterRadius;
+	}
+	else {
+		bool xFacesOut = raceway.dCenterRadius > (ring.dRadiusMin + ring.dRadiusMax) * 0.5;
+		side.dDistance = xFacesOut ? raceway.dCenterRadius - ring.dRadiusMax : ring.dRadiusMin - raceway.dCenterRadius;
+		side.dDepth = ring.dRadiusMax - ring.dRadiusMin;
+		side.dLow = dLowZ;
+		side.dHigh = dHighZ;
+		for (int i = 0; i < geometry.iRowCount; ++i)
+			side.dRaceways[i] = rowRaceway(geometry, i).dCenterHeight;
+	}
+	return side;
+}
+
+// Smallest part of the ring side that is left next to the raceways. The end of
+// the side that a counterbore lowers is measured against the counterbore instead.
+static double racewayLand(const BearingGeometry &geometry, const RingProfile &ring, const RingProfile &counterbore, const RingSide &side, double cutHalf)
+{
+	bool xLowCut = false;
+	bool xHighCut = false;
+	double dLand = 1.0e300;
+	if (hasCounterbore(counterbore) && !side.xAxial) {
+		xHighCut = counterbore.dCenterHeight > ring.dCenterHeight;
+		xLowCut = !xHighCut;
+		// The raceway meets the remaining shoulder where the counterbore ends.
+		const RacewayCircle &raceway = geometry.raceway;
+		double dShoulder = counterbore.dRadiusMin > ring.dRadiusMin ? counterbore.dRadiusMin : counterbore.dRadiusMax;
+		double dDistance = fabs(dShoulder - raceway.dCenterRadius);
+		double dShoulderCut = dDistance < raceway.dRadius ? sqrt(raceway.dRadius * raceway.dRadius - dDistance * dDistance) : 0.0;
+		if (xHighCut)
+			dLand = side.dHigh - (side.dRaceways[geometry.iRowCount - 1] + dShoulderCut);
+		else
+			dLand = side.dRaceways[0] - dShoulderCut - side.dLow;
+	}
+	if (!xLowCut)
+		dLand = std::min(dLand, side.dRaceways[0] - cutHalf - side.dLow);
+	if (!xHighCut)
+		dLand = std::min(dLand, side.dHigh - (side.dRaceways[geometry.iRowCount - 1] + cutHalf));
+	for (int i = 1; i < geometry.iRowCount; ++i)
+		dLand = std::min(dLand, (side.dRaceways[i] - cutHalf) - (side.dRaceways[i - 1] + cutHalf));
+	return dLand;
+}
+
+// Wall under the groove of a roller and the rib left next to it, for the ring
+// on the given side of the roller. False if the roller does not reach the ring.
+static bool rollerGroove(const BearingGeometry &geometry, const RingProfile &ring, bool outer, double *wall, double *land)
+{
+	double cornersR[4], cornersZ[4];
+	rollerCorners(geometry.roller, cornersR, cornersZ);
+	double dDeepest = outer ? std::max(cornersR[1], cornersR[2]) : std::min(cornersR[0], cornersR[3]);
+	// The groove is not wider than the roller itself.
+	double dLow = std::min(std::min(cornersZ[0], cornersZ[1]), std::min(cornersZ[2], cornersZ[3]));
+	double dHigh = std::max(std::max(cornersZ[0], cornersZ[1]), std::max(cornersZ[2], cornersZ[3]));
+	*wall = outer ? ring.dRadiusMax - dDeepest : dDeepest - ring.dRadiusMin;
+	*land = std::min(dLow - (ring.dCenterHeight - ring.dHalfThickness), (ring.dCenterHeight + ring.dHalfThickness) - dHigh);
+	return outer ? dDeepest > ring.dRadiusMin : dDeepest < ring.dRadiusMax;
+}
+
+static void checkElementCount(BearingGeometry *geometry, bool correct, const char *elements, BearingValidation *validation)
+{
+	bool xBalls = geometry->eElement == BallElement;
+	// Rolling elements must not overlap, fewer always fit.
+	validation->dBallGap = ballGap(geometry->dPitchRadius, geometry->dBallRadius, geometry->iBallCount);
+	if (correct && geometry->iBallCount > 3 && validation->dBallGap < 0.0) {
+		int iCount = geometry->iBallCount;
+		while (iCount > 3 && ballGap(geometry->dPitchRadius, geometry->dBallRadius, iCount) < 0.0)
+			--iCount;
+		if (ballGap(geometry->dPitchRadius, geometry->dBallRadius, iCount) >= 0.0) {
+			validation->corrections.push_back(std::string(xBalls ? "Ball" : "Roller") + " count lowered from " + std::to_string(geometry->iBallCount) + " to " +
+				std::to_string(iCount) + " so that the " + elements + " do not overlap.");
+			geometry->iBallCount = iCount;
+			validation->dBallGap = ballGap(geometry->dPitchRadius, geometry->dBallRadius, iCount);
+		}
+	}
+	if (geometry->iBallCount < 3)
+		validation->errors.push_back(std::string("Less than three ") + elements + " fit on the pitch circle.");
+	else if (validation->dBallGap < 0.0)
+		validation->errors.push_back(std::string("The ") + elements + " overlap each other.");
+}
+
+// Width of the ring side that a counterbore leaves next to the one corner of that side it keeps.
+static double counterboreSide(const RingProfile &ring, const RingProfile &counterbore)
+{
+	if (!hasCounterbore(counterbore))
+		return 1.0e300;
+	return counterbore.dRadiusMin > ring.dRadiusMin ? counterbore.dRadiusMin - ring.dRadiusMin : ring.dRadiusMax - counterbore.dRadiusMax;
+}
+
+static void checkFillet(BearingGeometry *geometry, bool correct, BearingValidation *validation)
+{
+	// The fillet rounds the ring corners that are left after the cuts, it has to
+	// stay within the ring width and thickness, within the part of the ring side
+	// that the raceway leaves and within the side a counterbore leaves.
+	double dFilletLimit = std::min(geometry->dRingWidth * 0.5, std::max(validation->dRacewayLand, 0.0));
+	dFilletLimit = std::min(dFilletLimit, std::min(geometry->innerRing.dHalfThickness, geometry->outerRing.dHalfThickness));
+	dFilletLimit = std::min(dFilletLimit, std::min(counterboreSide(geometry->innerRing, geometry->innerCounterbore),
+		counterboreSide(geometry->outerRing, geometry->outerCounterbore)));
+	validation->xFilletFits = geometry->dFilletRadius < dFilletLimit;
+	if (!validation->xFilletFits) {
+		if (correct) {
+			double dRadius = dFilletLimit * 0.5;
+			if (dRadius < kMinFeatureSize)
+				dRadius = 0.0;
+			validation->corrections.push_back(dRadius > 0.0 ? "Fillet radius reduced to " + std::to_string(dRadius) + "." : "The rings are not filleted.");
+			geometry->dFilletRadius = dRadius;
+			validation->xFilletFits = true;
+		}
+		else {
+			validation->errors.push_back("The fillet radius is too large for the rings.");
+		}
+	}
+	else if (geometry->dFilletRadius > 0.0 && geometry->dFilletRadius < kMinFeatureSize) {
+		if (correct) {
+			validation->corrections.push_back("The fillet is too small to build, the rings are not filleted.");
+			geometry->dFilletRadius = 0.0;
+		}
+		else {
+			validation->errors.push_back("The fillet radius is too small.");
+		}
+	}
+}
+
+// Roller bearings have a groove of the roller cross section in each ring instead of a raceway.
+static bool validateRollerGeometry(BearingGeometry *geometry, bool correct, BearingValidation *validation)
+{
+	double dInnerWall, dInnerLand, dOuterWall, dOuterLand;
+	bool xInnerReached = rollerGroove(*geometry, geometry->innerRing, false, &dInnerWall, &dInnerLand);
+	bool xOuterReached = rollerGroove(*geometry, geometry->outerRing, true, &dOuterWall, &dOuterLand);
+
+	validation->dRingGap = geometry->outerRing.dRadiusMin - geometry->innerRing.dRadiusMax;
+	validation->dMinWall = std::min(dInnerWall, dOuterWall);
+	validation->dRacewayClearance = 0.0;
+	validation->dRacewayLand = std::min(dInnerLand, dOuterLand);
+
+	if (geometry->dRingWidth < kMinFeatureSize)
+		validation->errors.push_back("The rings are too narrow (" + std::to_string(geometry->dRingWidth) + ").");
+	if (validation->dRingGap <= 0.0)
+		validation->errors.push_back("The inner and the outer ring touch.");
+	if (validation->dMinWall < kMinFeatureSize)
+		validation->errors.push_back("The roller groove cuts through a ring, the wall left is " + std::to_string(validation->dMinWall) + ".");
+	if (geometry->roller.dRadius < kMinFeatureSize || geometry->roller.dLength < kMinFeatureSize)
+		validation->errors.push_back("The rollers are too small.");
+	if (!xInnerReached || !xOuterReached)
+		validation->errors.push_back("The rollers do not reach the rings, they would be loose.");
+	if (validation->dRacewayLand < kMinFeatureSize)
+		validation->errors.push_back("The rollers are longer than the rings are wide.");
+
+	checkElementCount(geometry, correct, "rollers", validation);
+	checkFillet(geometry, correct, validation);
+
+	validation->xValid = validation->errors.empty();
+	return validation->xValid;
+}
+
+static bool finiteRing(const RingProfile &ring)
+{
+	return isfinite(ring.dRadiusMin) && isfinite(ring.dRadiusMax) && isfinite(ring.dHalfThickness) && isfinite(ring.dCenterHeight);
+}
+
+// Sizes that are not numbers slip through every comparison below, so they are
+// turned down before anything else.
+static bool finiteGeometry(const BearingGeometry &geometry)
+{
+	bool xFinite = isfinite(geometry.dInnerDiameter) && isfinite(geometry.dOuterDiameter) && isfinite(geometry.dThickness) &&
+		isfinite(geometry.dBallRadius) && isfinite(geometry.dRingWidth) && isfinite(geometry.dPitchRadius) &&
+		isfinite(geometry.dFilletRadius) && isfinite(geometry.dContactAngle) &&
+		finiteRing(geometry.innerRing) && finiteRing(geometry.outerRing) &&
+		finiteRing(geometry.innerCounterbore) && finiteRing(geometry.outerCounterbore) && finiteRing(geometry.cage.band) &&
+		isfinite(geometry.cage.dPocketClearance) &&
+		isfinite(geometry.raceway.dCenterRadius) && isfinite(geometry.raceway.dCenterHeight) && isfinite(geometry.raceway.dRadius) &&
+		isfinite(geometry.roller.dCenterRadius) && isfinite(geometry.roller.dCenterHeight) && isfinite(geometry.roller.dLength) &&
+		isfinite(geometry.roller.dRadius) && isfinite(geometry.roller.dAxisAngle) && isfinite(geometry.roller.dTaperAngle);
+	for (int i = 0; i < geometry.iRowCount && xFinite; ++i)
+		xFinite = isfinite(geometry.rowHeights[i]);
+	return xFinite;
+}
+
+bool validateBearingGeometry(BearingGeometry *geometry, bool correct, BearingValidation *validation)
+{
+	validation->errors.clear();
+	validation->corrections.clear();
+
+	if (!finiteGeometry(*geometry) || geometry->iRowCount < 1 || geometry->iRowCount > kMaxBallRows ||
+		geometry->iBallCount < 0 || geometry->iBallCount == INT_MAX) {
+		validation->dMinWall = 0.0;
+		validation->dBallGap = 0.0;
+		validation->dRingGap = 0.0;
+		validation->dRacewayClearance = 0.0;
+		validation->dRacewayLand = 0.0;
+		validation->xFilletFits = false;
+		validation->errors.push_back("The sizes are not finite numbers, the bearing cannot be sized.");
+		validation->xValid = false;
+		return false;
+	}
+
+	if (geometry->eElement != BallElement)
+		return validateRollerGeometry(geometry, correct, validation);
+
+	const RacewayCircle &raceway = geometry->raceway;
+	RingSide innerSide = facingSide(*geometry, geometry->innerRing);
+	RingSide outerSide = facingSide(*geometry, geometry->outerRing);
+
+	validation->dRingGap = innerSide.xAxial ?
+		(geometry->outerRing.dCenterHeight - geometry->outerRing.dHalfThickness) - (geometry->innerRing.dCenterHeight + geometry->innerRing.dHalfThickness) :
+		geometry->outerRing.dRadiusMin - geometry->innerRing.dRadiusMax;
+	validation->dMinWall = std::min(
+		innerSide.dDepth - (raceway.dRadius - innerSide.dDistance),
+		outerSide.dDepth - (raceway.dRadius - outerSide.dDistance));
+	validation->dRacewayClearance = raceway.dRadius - geometry->dBallRadius;
+
+	if (geometry->dRingWidth < kMinFeatureSize)
+		validation->errors.push_back("The rings are too narrow (" + std::to_string(geometry->dRingWidth) + ").");
+	if (validation->dRingGap <= 0.0)
+		validation->errors.push_back("The inner and the outer ring touch.");
+	if (validation->dMinWall < kMinFeatureSize)
+		validation->errors.push_back("The raceway cuts through a ring, the wall left is " + std::to_string(validation->dMinWall) + ".");
+	if (validation->dRacewayClearance < 0.0)
+		validation->errors.push_back("The balls are larger than the raceway.");
+	if (geometry->dBallRadius < kMinFeatureSize)
+		validation->errors.push_back("The balls are too small.");
+	for (int i = 1; i < geometry->iRowCount; ++i) {
+		if (geometry->rowHeights[i] - geometry->rowHeights[i - 1] < 2.0 * geometry->dBallRadius)
+			validation->errors.push_back("The rows of balls overlap each other.");
+	}
+
+	// The raceway has to cut into both rings, but must leave some of the ring sides.
+	double dCutHalf = 0.0;
+	double dDistance = std::min(innerSide.dDistance, outerSide.dDistance);
+	if (dDistance >= raceway.dRadius)
+		validation->errors.push_back("The raceway does not reach the rings, the balls would be loose.");
+	else
+		dCutHalf = sqrt(raceway.dRadius * raceway.dRadius - dDistance * dDistance);
+	validation->dRacewayLand = std::min(
+		racewayLand(*geometry, geometry->innerRing, geometry->innerCounterbore, innerSide, dCutHalf),
+		racewayLand(*geometry, geometry->outerRing, geometry->outerCounterbore, outerSide, dCutHalf));
+	if (validation->dRacewayLand < kMinFeatureSize)
+		validation->errors.push_back("The raceway is wider than the rings.");
+
+	checkElementCount(geometry, correct, "balls", validation);
+	checkFillet(geometry, correct, validation);
+
+	validation->xValid = validation->errors.empty();
+	return validation->xValid;
+}
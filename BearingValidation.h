@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "BearingGeometry.h"
+
+// Smallest feature the validation lets through, in the units of the geometry.
+// Fusion models in cm, so this is one micrometre.
+const double kMinFeatureSize = 1.0e-4;
+
+// Analytic checks of a bearing before any Fusion feature is created.
+struct BearingValidation
+{
+	// Material left under the raceway, the thinner of both rings.
+	double dMinWall;
+	// Gap between neighbouring balls.
+	double dBallGap;
+	// Gap between the inner and the outer ring.
+	double dRingGap;
+	// Raceway radius minus ball radius, 0 for roller bearings.
+	double dRacewayClearance;
+	// Smallest part of a ring side that is left between the raceways and the faces.
+	double dRacewayLand;
+	bool xFilletFits;
+
+	// False if the bearing cannot be built, even after corrections.
+	bool xValid;
+	// Problems that prevent building.
+	std::vector<std::string> errors;
+	// Changes made to the geometry to make it buildable.
+	std::vector<std::string> corrections;
+
+	// All errors and corrections as one text.
+	std::string message() const;
+};
+
+// Checks the geometry. With correct set, a ball count that makes the balls
+// overlap is lowered and a fillet that does not fit is shrunk or dropped
+// (fillet radius 0) instead of being reported as an error.
+bool validateBearingGeometry(BearingGeometry *geometry, bool correct, BearingValidation *validation);
@@ -0,0 +1,569 @@
+// Benchmarks of the Fusion independent bearing code, works without Fusion.
+//
+//   BearingBench [--min-time <seconds>] [--out <results.json>] [--filter <text>]
+//   BearingBench --replay <trace.json> [--out <results.json>]
+//   BearingBench --verify [--max-ulp <n>] [--max-error <e>]
+//
+// The first form times sizing, validation, ball placement, the sine/cosine
+// kernel, tessellation, cached previews, the design sweep and a batch job with
+// and without the job queue for bearings from 5 mm to 2 m outer diameter, and
+// every bearing family at 100 mm, including writing it as a STEP file of its
+// own. The second form builds the bearings of a trace recorded in Fusion
+// ("Record build trace") again with the recording backend and compares the
+// time spent in every stage. Results are written in the JSON layout of Google
+// Benchmark, so its compare tooling can be used to spot regressions between
+// two runs. The third form checks the vector sine/cosine kernel against the
+// scalar code (2 ulp by default) and both against std::sin and std::cos
+// (2.5e-7 by default). It exits with 1 if a result is off or the build has no vector
+// kernel, so it has to be built with -mavx2 or for arm64.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../BearingBackend.h"
+#include "../BearingBuild.h"
+#include "../BearingGeometry.h"
+#include "../BearingJob.h"
+#include "../BearingMesh.h"
+#include "../BearingPlacement.h"
+#include "../BearingPreview.h"
+#include "../BearingProperties.h"
+#include "../BearingStep.h"
+#include "../BearingSweep.h"
+#include "../BearingTrig.h"
+#include "../BearingValidation.h"
+
+typedef std::chrono::steady_clock Clock;
+
+struct BenchResult
+{
+	std::string strName;
+	long long iIterations;
+	double dNanosecondsPerIteration;
+};
+
+// Keeps the compiler from dropping work whose result is not used.
+static volatile double gdSink;
+
+// Runs the body with a doubling number of iterations until one batch takes at least minTime.
+static BenchResult runBenchmark(const std::string &name, double minTime, const std::function<void(long long)> &body)
+{
+	long long iIterations = 1;
+	double dSeconds = 0.0;
+	for (;;) {
+		Clock::time_point tStart = Clock::now();
+		body(iIterations);
+		dSeconds = std::chrono::duration<double>(Clock::now() - tStart).count();
+		if (dSeconds >= minTime || iIterations >= (1ll << 40))
+			break;
+		// Aim a bit past the target so that the next batch usually ends the loop.
+		double dScale = dSeconds > 0.0 ? minTime * 1.4 / dSeconds : 10.0;
+		iIterations = (long long)(iIterations * (dScale < 2.0 ? 2.0 : (dScale > 100.0 ? 100.0 : dScale)));
+	}
+
+	BenchResult result;
+	result.strName = name;
+	result.iIterations = iIterations;
+	result.dNanosecondsPerIteration = dSeconds * 1.0e9 / iIterations;
+	std::printf("%-40s %14.1f ns %12lld iterations\n", name.c_str(), result.dNanosecondsPerIteration, iIterations);
+	std::fflush(stdout);
+	return result;
+}
+
+// Mesh writer that only counts, so that tessellation is timed without disk I/O.
+class CountingMeshWriter : public MeshWriter
+{
+public:
+	CountingMeshWriter() : miTriangles(0) {}
+
+	bool open(const std::string &) override { return true; }
+	bool write(const TriangleMesh &mesh) override
+	{
+		miTriangles += mesh.triangleCount();
+		return true;
+	}
+	bool close() override { return true; }
+
+	size_t miTriangles;
+};
+
+static bool writeResults(const std::string &path, const std::vector<BenchResult> &results)
+{
+	FILE *pFile = std::fopen(path.c_str(), "wb");
+	if (!pFile)
+		return false;
+	std::fprintf(pFile, "{\n  \"context\": {\"executable\": \"BearingBench\", \"sincos\": \"%s\"},\n  \"benchmarks\": [", sinCosBackend());
+	for (size_t i = 0; i < results.size(); ++i) {
+		const BenchResult &result = results[i];
+		std::fprintf(pFile, "%s\n    {\"name\": \"%s\", \"run_type\": \"iteration\", \"iterations\": %lld, "
+			"\"real_time\": %.3f, \"cpu_time\": %.3f, \"time_unit\": \"ns\"}",
+			i == 0 ? "" : ",", result.strName.c_str(), result.iIterations, result.dNanosecondsPerIteration, result.dNanosecondsPerIteration);
+	}
+	std::fprintf(pFile, "\n  ]\n}\n");
+	return std::fclose(pFile) == 0;
+}
+
+// Path of a scratch file in the temp folder.
+static std::string tempFilePath(const std::string &name)
+{
+	const char *pDir = std::getenv("TEMP");
+	if (!pDir)
+		pDir = std::getenv("TMPDIR");
+	std::string strDir = pDir ? pDir : "/tmp";
+	if (!strDir.empty() && strDir.back() != '/' && strDir.back() != '\\')
+		strDir += "/";
+	return strDir + name;
+}
+
+// Outer diameters from 5 mm to 2 m in mm, with a typical bore and width.
+static std::vector<BearingGeometry> benchmarkBearings()
+{
+	std::vector<BearingGeometry> bearings;
+	const int iSizes = 7;
+	for (int i = 0; i < iSizes; ++i) {
+		double dOuter = 5.0 * std::pow(400.0, (double)i / (iSizes - 1));
+		BearingGeometry geometry;
+		if (computeBearingGeometry(dOuter * 0.55, dOuter, dOuter * 0.2, &geometry))
+			bearings.push_back(geometry);
+	}
+	return bearings;
+}
+
+static void runSuite(double minTime, const std::string &filter, std::vector<BenchResult> *results)
+{
+	std::vector<BearingGeometry> bearings = benchmarkBearings();
+	auto wanted = [&](const std::string &name) { return filter.empty() || name.find(filter) != std::string::npos; };
+	auto add = [&](const std::string &name, const std::function<void(long long)> &body) {
+		if (wanted(name))
+			results->push_back(runBenchmark(name, minTime, body));
+	};
+
+	for (const BearingGeometry &bearing : bearings) {
+		std::string strSize = "/" + std::to_string((int)(bearing.dOuterDiameter + 0.5)) + "mm";
+
+		add("geometry" + strSize, [&](long long iterations) {
+			BearingGeometry geometry;
+			for (long long i = 0; i < iterations; ++i) {
+				computeBearingGeometry(bearing.dInnerDiameter, bearing.dOuterDiameter, bearing.dThickness, &geometry);
+				gdSink = geometry.dBallRadius;
+			}
+		});
+
+		add("validation" + strSize, [&](long long iterations) {
+			BearingValidation validation;
+			for (long long i = 0; i < iterations; ++i) {
+				BearingGeometry geometry = bearing;
+				validateBearingGeometry(&geometry, true, &validation);
+				gdSink = validation.dMinWall;
+			}
+		});
+
+		add("placement" + strSize, [&](long long iterations) {
+			BallPlacement placement;
+			for (long long i = 0; i < iterations; ++i) {
+				placeBalls(bearing.dPitchRadius, bearing.dBallRadius, 0.0, bearing.iBallCount, &placement);
+				gdSink = placement.centersX.back();
+			}
+		});
+
+		add("build/recording" + strSize, [&](long long iterations) {
+			BearingBuildOptions options;
+			options.eBallCreation = PatternBallCreation;
+			options.xReuseBearings = false;
+			options.xCage = false;
+			options.strUnits = "mm";
+			options.strDisplayUnits = "mm";
+			options.dDisplayScale = 1.0;
+			RecordingBackend recording;
+			for (long long i = 0; i < iterations; ++i) {
+				recording.clear();
+				buildBallBearing(&recording, bearing, options, nullptr);
+			}
+			gdSink = (double)recording.calls().size();
+		});
+
+		add("tessellation/lod1" + strSize, [&](long long iterations) {
+			CountingMeshWriter writer;
+			MeshLod lod = meshLodPreset(1);
+			for (long long i = 0; i < iterations; ++i)
+				writeBearingMesh(bearing, lod, 0.0, 0.0, &writer);
+			gdSink = (double)writer.miTriangles;
+		});
+
+		// Going back to sizes that were previewed before, as when scrubbing a value.
+		add("preview/cached" + strSize, [&](long long iterations) {
+			PreviewCache cache;
+			cache.mesh(bearing, 0);
+			for (long long i = 0; i < iterations; ++i)
+				gdSink = (double)cache.mesh(bearing, 0)->triangleCount();
+		});
+	}
+
+	// Every family at the size of the sweep, the deep groove one is the reference.
+	for (int iFamily = DeepGrooveBearing; iFamily <= TaperedRollerBearing; ++iFamily) {
+		BearingFamily eFamily = (BearingFamily)iFamily;
+		std::string strFamily = std::string("/") + bearingFamilyName(eFamily) + "/100mm";
+		BearingGeometry bearing;
+		BearingValidation validation;
+		computeBearingGeometry(eFamily, 55.0, 100.0, 20.0, &bearing);
+		validateBearingGeometry(&bearing, true, &validation);
+
+		add("geometry" + strFamily, [&](long long iterations) {
+			BearingGeometry geometry;
+			for (long long i = 0; i < iterations; ++i) {
+				computeBearingGeometry(eFamily, 55.0, 100.0, 20.0, &geometry);
+				gdSink = geometry.dBallRadius;
+			}
+		});
+
+		add("properties" + strFamily, [&](long long iterations) {
+			BearingProperties properties;
+			for (long long i = 0; i < iterations; ++i) {
+				computeBearingProperties(bearing, 1.0, kBearingSteelDensity, &properties);
+				gdSink = properties.dMass;
+			}
+		});
+
+		add("build/recording" + strFamily, [&](long long iterations) {
+			BearingBuildOptions options;
+			options.eBallCreation = PatternBallCreation;
+			options.xReuseBearings = false;
+			options.xCage = false;
+			options.strUnits = "mm";
+			options.strDisplayUnits = "mm";
+			options.dDisplayScale = 1.0;
+			RecordingBackend recording;
+			for (long long i = 0; i < iterations; ++i) {
+				recording.clear();
+				buildBallBearing(&recording, bearing, options, nullptr);
+			}
+			gdSink = (double)recording.calls().size();
+		});
+
+		add("tessellation/lod1" + strFamily, [&](long long iterations) {
+			CountingMeshWriter writer;
+			MeshLod lod = meshLodPreset(1);
+			for (long long i = 0; i < iterations; ++i)
+				writeBearingMesh(bearing, lod, 0.0, 0.0, &writer);
+			gdSink = (double)writer.miTriangles;
+		});
+
+		// One complete file per bearing, as for a supplier exchange.
+		add("step" + strFamily, [&](long long iterations) {
+			std::string strPath = tempFilePath("BearingBench.step");
+			for (long long i = 0; i < iterations; ++i) {
+				StepWriter writer;
+				gdSink = writer.open(strPath) && writer.write(bearing, "bench", 0.0, 0.0) && writer.close();
+			}
+			std::remove(strPath.c_str());
+		});
+	}
+
+	std::vector<float> angles(4096), sines(4096), cosines(4096);
+	for (size_t i = 0; i < angles.size(); ++i)
+		angles[i] = (float)(6.283185307179586 * i / angles.size());
+	add(std::string("sincos/4096/") + sinCosBackend(), [&](long long iterations) {
+		for (long long i = 0; i < iterations; ++i)
+			computeSinCos(angles.data(), angles.size(), sines.data(), cosines.data());
+		gdSink = sines[17];
+	});
+	add("sincos/4096/scalar-reference", [&](long long iterations) {
+		for (long long i = 0; i < iterations; ++i)
+			computeSinCosScalar(angles.data(), angles.size(), sines.data(), cosines.data());
+		gdSink = sines[17];
+	});
+
+	SweepRanges ranges = defaultSweepRanges();
+	ranges.iBallRadiusSteps = 16;
+	ranges.iRingWidthSteps = 16;
+	add("sweep/16x16x8x16/100mm", [&](long long iterations) {
+		std::vector<SweepResult> front;
+		for (long long i = 0; i < iterations; ++i)
+			sweepBearing(55.0, 100.0, 20.0, ranges, 0, &front, nullptr);
+		gdSink = (double)front.size();
+	});
+
+	// A batch job built with the recording backend, planned in turn with the
+	// builds and planned ahead on the worker of the job queue.
+	std::vector<BearingSpec> jobSpecs;
+	for (int i = 0; i < 256; ++i) {
+		const BearingGeometry &bearing = bearings[i % bearings.size()];
+		jobSpecs.push_back({ bearing.dInnerDiameter, bearing.dOuterDiameter, bearing.dThickness });
+	}
+	BearingJobSettings jobSettings = { DeepGrooveBearing, 0.0, 1.0, 1.0 };
+	BearingBuildOptions jobOptions;
+	jobOptions.eBallCreation = PatternBallCreation;
+	jobOptions.xReuseBearings = false;
+	jobOptions.xCage = false;
+	jobOptions.strUnits = "mm";
+	jobOptions.strDisplayUnits = "mm";
+	jobOptions.dDisplayScale = 1.0;
+	add("job/sequential/256-bearings", [&](long long iterations) {
+		RecordingBackend recording;
+		for (long long i = 0; i < iterations; ++i) {
+			recording.clear();
+			for (const BearingSpec &spec : jobSpecs) {
+				BearingGeometry geometry;
+				BearingValidation validation;
+				if (sizeBearing(jobSettings.eFamily, spec.dInnerDiameter, spec.dOuterDiameter, spec.dThickness, 0.0, &geometry, &validation))
+					buildBallBearing(&recording, geometry, jobOptions, nullptr);
+			}
+		}
+		gdSink = (double)recording.calls().size();
+	});
+	add("job/queued/256-bearings", [&](long long iterations) {
+		RecordingBackend recording;
+		BearingJobQueue queue;
+		PlannedBearing bearing;
+		for (long long i = 0; i < iterations; ++i) {
+			recording.clear();
+			queue.startBatch(jobSpecs, jobSettings, nullptr);
+			while (!queue.finished()) {
+				if (!queue.take(&bearing))
+					std::this_thread::yield();
+				else if (bearing.xValid)
+					buildBallBearing(&recording, bearing.geometry, jobOptions, nullptr);
+			}
+			queue.reset();
+		}
+		gdSink = (double)recording.calls().size();
+	});
+}
+
+struct TraceEvent
+{
+	std::string strName;
+	int iThread;
+	double dDurationUs;
+};
+
+static bool readTrace(const std::string &path, std::vector<TraceEvent> *events)
+{
+	FILE *pFile = std::fopen(path.c_str(), "rb");
+	if (!pFile)
+		return false;
+	// BuildTrace writes one event per line.
+	char line[512];
+	while (std::fgets(line, sizeof(line), pFile)) {
+		char name[128];
+		int iThread;
+		double dStart, dDuration;
+		if (std::sscanf(line, " {\"name\":\"%127[^\"]\",\"cat\":\"bearing\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lf,\"dur\":%lf",
+			name, &iThread, &dStart, &dDuration) == 4)
+			events->push_back({ name, iThread, dDuration });
+	}
+	std::fclose(pFile);
+	return true;
+}
+
+// Builds the bearings of a trace recorded in Fusion again with the recording
+// backend, so the cost of the build sequence itself can be compared with the
+// time Fusion spent in every stage.
+static bool runReplay(const std::string &path, double minTime, std::vector<BenchResult> *results)
+{
+	std::vector<TraceEvent> events;
+	if (!readTrace(path, &events) || events.empty()) {
+		std::fprintf(stderr, "No build trace events in %s\n", path.c_str());
+		return false;
+	}
+
+	std::map<std::string, double> recordedUs;
+	std::map<std::string, int> recordedCount;
+	for (const TraceEvent &event : events) {
+		recordedUs[event.strName] += event.dDurationUs;
+		recordedCount[event.strName] += 1;
+	}
+	int iBearings = recordedCount["drawBallBearing"];
+	if (iBearings == 0) {
+		std::fprintf(stderr, "The trace in %s holds no bearing builds\n", path.c_str());
+		return false;
+	}
+
+	// The sizes are not part of the trace, a 20 mm bearing in Fusion units (cm) stands in for all of them.
+	BearingGeometry geometry;
+	BearingValidation validation;
+	computeBearingGeometry(1.1, 2.0, 0.4, &geometry);
+	validateBearingGeometry(&geometry, true, &validation);
+	BearingBuildOptions options;
+	options.eBallCreation = PatternBallCreation;
+	options.xReuseBearings = false;
+	options.xCage = false;
+	options.strUnits = "cm";
+	options.strDisplayUnits = "mm";
+	options.dDisplayScale = 10.0;
+
+	auto buildAll = [&](RecordingBackend *backend, BuildTrace *trace) {
+		for (int i = 0; i < iBearings; ++i) {
+			ScopedStage stage(trace, "drawBallBearing");
+			buildBallBearing(backend, geometry, options, trace);
+		}
+	};
+
+	BuildTrace offline;
+	RecordingBackend recording;
+	buildAll(&recording, &offline);
+
+	std::printf("%-24s %8s %16s %16s\n", "stage", "calls", "recorded ms", "offline ms");
+	for (const auto &entry : recordedUs)
+		std::printf("%-24s %8d %16.3f %16.3f\n", entry.first.c_str(), recordedCount[entry.first], entry.second * 1.0e-3,
+			offline.totalSeconds(entry.first.c_str()) * 1.0e3);
+	std::printf("\n%s\n", recording.summary().c_str());
+
+	results->push_back(runBenchmark("replay/" + std::to_string(iBearings) + "-bearings", minTime, [&](long long iterations) {
+		for (long long i = 0; i < iterations; ++i) {
+			recording.clear();
+			buildAll(&recording, nullptr);
+		}
+		gdSink = (double)recording.calls().size();
+	}));
+	return true;
+}
+
+// Distance in units in the last place, through the bit patterns ordered like the floats.
+static long long ulpDistance(float a, float b)
+{
+	int32_t iA, iB;
+	std::memcpy(&iA, &a, sizeof(iA));
+	std::memcpy(&iB, &b, sizeof(iB));
+	long long iOrderedA = iA < 0 ? (long long)INT32_MIN - iA : iA;
+	long long iOrderedB = iB < 0 ? (long long)INT32_MIN - iB : iB;
+	return iOrderedA > iOrderedB ? iOrderedA - iOrderedB : iOrderedB - iOrderedA;
+}
+
+// Checks the vector sine/cosine kernel against the scalar code, element by
+// element, and both against std::sin and std::cos: a sweep over several turns
+// both ways, the quadrant boundaries and their neighbours, and every count up
+// to a few vectors from an unaligned start so that the scalar tail runs. False
+// if any result is more than maxUlp from the scalar one or more than maxError
+// from the exact value, and for builds without a vector kernel, which would
+// only compare the scalar code with itself.
+static bool verifySinCos(long long maxUlp, double maxError)
+{
+	if (std::strcmp(sinCosBackend(), "scalar") == 0) {
+		std::fprintf(stderr, "sincos: this build has no vector kernel to verify, build with -mavx2 or for arm64\n");
+		return false;
+	}
+
+	const double kPi = 3.141592653589793;
+	std::vector<float> angles;
+	for (int i = -4096; i <= 4096; ++i)
+		angles.push_back((float)(8.0 * kPi * i / 4096));
+	for (int i = -16; i <= 16; ++i) {
+		float dBoundary = (float)(0.5 * kPi * i);
+		angles.push_back(std::nextafter(dBoundary, -INFINITY));
+		angles.push_back(dBoundary);
+		angles.push_back(std::nextafter(dBoundary, INFINITY));
+		// Half way between two boundaries the reduction switches quadrant.
+		float dSwitch = (float)(0.5 * kPi * i + 0.25 * kPi);
+		angles.push_back(std::nextafter(dSwitch, -INFINITY));
+		angles.push_back(dSwitch);
+		angles.push_back(std::nextafter(dSwitch, INFINITY));
+	}
+
+	std::vector<float> sines(angles.size()), cosines(angles.size());
+	std::vector<float> refSines(angles.size()), refCosines(angles.size());
+	computeSinCosScalar(angles.data(), angles.size(), refSines.data(), refCosines.data());
+
+	double dWorstScalarError = 0.0;
+	size_t iFailures = 0;
+	for (size_t i = 0; i < angles.size(); ++i) {
+		double dError = std::max(std::fabs(refSines[i] - std::sin((double)angles[i])), std::fabs(refCosines[i] - std::cos((double)angles[i])));
+		dWorstScalarError = std::max(dWorstScalarError, dError);
+		if (!(dError <= maxError) && ++iFailures <= 10)
+			std::fprintf(stderr, "sincos(%.9g) scalar: %.9g %.9g, exact %.9g %.9g\n", angles[i], refSines[i], refCosines[i],
+				std::sin((double)angles[i]), std::cos((double)angles[i]));
+	}
+
+	long long iWorst = 0;
+	double dWorstError = 0.0;
+	auto check = [&](size_t offset, size_t count) {
+		std::fill(sines.begin(), sines.end(), NAN);
+		std::fill(cosines.begin(), cosines.end(), NAN);
+		computeSinCos(angles.data() + offset, count, sines.data() + offset, cosines.data() + offset);
+		for (size_t i = offset; i < offset + count; ++i) {
+			long long iSin = ulpDistance(sines[i], refSines[i]);
+			long long iCos = ulpDistance(cosines[i], refCosines[i]);
+			double dError = std::max(std::fabs(sines[i] - std::sin((double)angles[i])), std::fabs(cosines[i] - std::cos((double)angles[i])));
+			iWorst = std::max(iWorst, std::max(iSin, iCos));
+			dWorstError = std::max(dWorstError, dError);
+			if (iSin <= maxUlp && iCos <= maxUlp && dError <= maxError)
+				continue;
+			if (++iFailures <= 10)
+				std::fprintf(stderr, "sincos(%.9g) count %zu: %.9g %.9g, scalar %.9g %.9g\n", angles[i], count,
+					sines[i], cosines[i], refSines[i], refCosines[i]);
+		}
+	};
+	check(0, angles.size());
+	for (size_t iCount = 0; iCount <= 37; ++iCount)
+		for (size_t iOffset = 0; iOffset < 3; ++iOffset)
+			check(angles.size() / 2 + iOffset, iCount);
+
+	std::printf("sincos/%s: %zu angles, at most %lld ulp from the scalar code (limit %lld), error at most %.3g (scalar %.3g, limit %.3g)\n",
+		sinCosBackend(), angles.size(), iWorst, maxUlp, dWorstError, dWorstScalarError, maxError);
+	if (iFailures > 0) {
+		std::fprintf(stderr, "sincos/%s: %zu results out of the limits\n", sinCosBackend(), iFailures);
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	double dMinTime = 0.2;
+	std::string strOut;
+	std::string strFilter;
+	std::string strReplay;
+	bool xVerify = false;
+	long long iMaxUlp = 2;
+	double dMaxError = 2.5e-7;
+	for (int i = 1; i < argc; ++i) {
+		std::string strArg = argv[i];
+		bool xHasValue = i + 1 < argc;
+		if (strArg == "--min-time" && xHasValue)
+			dMinTime = std::atof(argv[++i]);
+		else if (strArg == "--out" && xHasValue)
+			strOut = argv[++i];
+		else if (strArg == "--filter" && xHasValue)
+			strFilter = argv[++i];
+		else if (strArg == "--replay" && xHasValue)
+			strReplay = argv[++i];
+		else if (strArg == "--verify")
+			xVerify = true;
+		else if (strArg == "--max-ulp" && xHasValue)
+			iMaxUlp = std::atoll(argv[++i]);
+		else if (strArg == "--max-error" && xHasValue)
+			dMaxError = std::atof(argv[++i]);
+		else {
+			std::fprintf(stderr, "Usage: %s [--min-time <seconds>] [--out <results.json>] [--filter <text>] [--replay <trace.json>] [--verify [--max-ulp <n>] [--max-error <e>]]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	if (xVerify)
+		return verifySinCos(iMaxUlp, dMaxError) ? 0 : 1;
+
+	std::vector<BenchResult> results;
+	if (!strReplay.empty()) {
+		if (!runReplay(strReplay, dMinTime, &results))
+			return 1;
+	}
+	else {
+		runSuite(dMinTime, strFilter, &results);
+	}
+
+	if (!strOut.empty() && !writeResults(strOut, results)) {
+		std::fprintf(stderr, "Cannot write %s\n", strOut.c_str());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,468 @@
+// Command line front end for the bearing geometry, works without Fusion.
+//
+//   BearingSizer [options] <innerDiameter> <outerDiameter> <thickness>
+//   BearingSizer [options] <file>   reads a CSV or JSON bearing list
+//   BearingSizer [options] -        reads "inner,outer,thickness" rows from stdin
+//   BearingSizer --lookup <catalog.bbcat> <innerDiameter> <outerDiameter> <thickness>
+//   BearingSizer --lookup <catalog.bbcat> --bore-range <min,max>
+//
+// Prints one CSV row with the derived geometry and its validation per bearing.
+// Bearings that cannot be built are reported on stderr and left out of meshes.
+//
+// Options:
+//   --family <name>           deep-groove (default), double-row, angular-contact, thrust,
+//                             cylindrical-roller or tapered-roller
+//   --stl <path>              write all bearings as one binary STL mesh
+//   --ply <path>              write all bearings as one binary PLY mesh
+//   --3mf <path>              write all bearings as one 3MF package, one object per ring and per row
+//   --step <path>             write all bearings as exact solids to one STEP AP214 file, one product each
+//   --step-dir <directory>    write every bearing to its own STEP file in the directory
+//   --units <units>           units of the sizes, also written to 3MF and STEP files: mm (default), cm, m or in.
+//                             Catalogs read as a bearing list are converted to them
+//   --lod <0-3>               mesh level of detail preset, default 1
+//   --ring-segments <n>       segments around the axis for the rings
+//   --raceway-segments <n>    segments of the raceway arc
+//   --ball-segments <n>       segments around each ball
+//   --spacing <distance>      gap between bearings placed side by side in a mesh
+//   --quiet                   do not print the geometry rows
+//   --properties              add mass (kg), inertia (kg mm^2), pitch diameter, rolling element count
+//                             and the load ratings C and C0 (N) to the rows, sizes in mm
+//   --sweep                   print the Pareto front of ball radius, ring width, raceway
+//                             clearance and ball count instead of the geometry (sizes in mm)
+//   --sweep-grid <r,w,c,n>    steps of the sweep for each of these variables
+//   --threads <n>             threads used by the sweep, default all cores
+//   --write-catalog <path>    write the valid bearings as a binary catalog (.bbcat)
+//   --catalog-units <units>   units of the written catalog, mm, cm, m, in or ft, default those of --units
+//   --lookup <path>           look the sizes up in a catalog instead of sizing them, in the units of the catalog
+//   --bore-range <min,max>    with --lookup, list the catalog bearings with a bore in the range
+//   --outer-range <min,max>   with --lookup, list the catalog bearings with an outer diameter in the range
+//   --width-range <min,max>   with --lookup, list the catalog bearings with a width in the range
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../BearingBatch.h"
+#include "../BearingCatalog.h"
+#include "../BearingGeometry.h"
+#include "../BearingMesh.h"
+#include "../BearingProperties.h"
+#include "../BearingStep.h"
+#include "../BearingSweep.h"
+#include "../BearingValidation.h"
+
+struct SizerOptions
+{
+	BearingFamily eFamily;
+	std::string strStlPath;
+	std::string strPlyPath;
+	std::string str3mfPath;
+	std::string strStepPath;
+	std::string strStepDirectory;
+	std::string strUnits;
+	MeshLod lod;
+	double dSpacing;
+	bool xQuiet;
+	bool xProperties;
+	bool xSweep;
+	SweepRanges sweepRanges;
+	int iThreads;
+	std::string strCatalogPath;
+	std::string strCatalogUnits;
+	std::string strLookupPath;
+	// Ranges of a catalog lookup, empty if the minimum is above the maximum.
+	double dBoreRange[2];
+	double dOuterRange[2];
+	double dWidthRange[2];
+	std::vector<std::string> positional;
+};
+
+static void printUsage(const char *program)
+{
+	std::fprintf(stderr,
+		"Usage: %s [options] <innerDiameter> <outerDiameter> <thickness>\n"
+		"       %s [options] <file.csv|file.json|->\n"
+		"Options: --family <name> --stl <path> --ply <path> --3mf <path> --step <path> --step-dir <directory> --units <units>\n"
+		"         --lod <0-3> --ring-segments <n> --raceway-segments <n>\n"
+		"         --ball-segments <n> --spacing <distance> --quiet --properties\n"
+		"         --sweep --sweep-grid <r,w,c,n> --threads <n>\n"
+		"         --write-catalog <path> --catalog-units <units>\n"
+		"         --lookup <catalog> [--bore-range <min,max>] [--outer-range <min,max>]\n"
+		"                            [--width-range <min,max>]\n", program, program);
+}
+
+// 3MF name of the units, empty if STEP and 3MF do not both know them.
+static std::string threeMfUnit(const std::string &units)
+{
+	if (units == "mm")
+		return "millimeter";
+	if (units == "cm")
+		return "centimeter";
+	if (units == "m")
+		return "meter";
+	if (units == "in")
+		return "inch";
+	return std::string();
+}
+
+static bool parseOptions(int argc, char **argv, SizerOptions *options)
+{
+	options->eFamily = DeepGrooveBearing;
+	options->lod = meshLodPreset(1);
+	options->dSpacing = 0.0;
+	options->xQuiet = false;
+	options->xProperties = false;
+	options->xSweep = false;
+	options->sweepRanges = defaultSweepRanges();
+	options->iThreads = 0;
+	options->strUnits = "mm";
+	options->dBoreRange[0] = options->dOuterRange[0] = options->dWidthRange[0] = 1.0;
+	options->dBoreRange[1] = options->dOuterRange[1] = options->dWidthRange[1] = 0.0;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string strArg = argv[i];
+		bool xHasValue = i + 1 < argc;
+		if (strArg == "--quiet")
+			options->xQuiet = true;
+		else if (strArg == "--properties")
+			options->xProperties = true;
+		else if (strArg == "--family" && xHasValue) {
+			if (!parseBearingFamily(argv[++i], &options->eFamily))
+				return false;
+		}
+		else if (strArg == "--stl" && xHasValue)
+			options->strStlPath = argv[++i];
+		else if (strArg == "--ply" && xHasValue)
+			options->strPlyPath = argv[++i];
+		else if (strArg == "--3mf" && xHasValue)
+			options->str3mfPath = argv[++i];
+		else if (strArg == "--step" && xHasValue)
+			options->strStepPath = argv[++i];
+		else if (strArg == "--step-dir" && xHasValue)
+			options->strStepDirectory = argv[++i];
+		else if (strArg == "--units" && xHasValue) {
+			options->strUnits = argv[++i];
+			if (threeMfUnit(options->strUnits).empty())
+				return false;
+		}
+		else if (strArg == "--lod" && xHasValue)
+			options->lod = meshLodPreset(std::atoi(argv[++i]));
+		else if (strArg == "--ring-segments" && xHasValue)
+			options->lod.iRingSegments = std::atoi(argv[++i]);
+		else if (strArg == "--raceway-segments" && xHasValue)
+			options->lod.iRacewaySegments = std::atoi(argv[++i]);
+		else if (strArg == "--ball-segments" && xHasValue)
+			options->lod.iBallSegments = std::atoi(argv[++i]);
+		else if (strArg == "--spacing" && xHasValue)
+			options->dSpacing = std::atof(argv[++i]);
+		else if (strArg == "--sweep")
+			options->xSweep = true;
+		else if (strArg == "--sweep-grid" && xHasValue) {
+			SweepRanges &ranges = options->sweepRanges;
+			if (std::sscanf(argv[++i], "%d,%d,%d,%d", &ranges.iBallRadiusSteps, &ranges.iRingWidthSteps,
+				&ranges.iClearanceSteps, &ranges.iBallCountSteps) != 4)
+				return false;
+		}
+		else if (strArg == "--threads" && xHasValue)
+			options->iThreads = std::atoi(argv[++i]);
+		else if (strArg == "--write-catalog" && xHasValue)
+			options->strCatalogPath = argv[++i];
+		else if (strArg == "--catalog-units" && xHasValue) {
+			options->strCatalogUnits = argv[++i];
+			if (unitsToMillimetres(options->strCatalogUnits) <= 0.0)
+				return false;
+		}
+		else if (strArg == "--lookup" && xHasValue)
+			options->strLookupPath = argv[++i];
+		else if (strArg == "--bore-range" && xHasValue) {
+			if (std::sscanf(argv[++i], "%lf,%lf", &options->dBoreRange[0], &options->dBoreRange[1]) != 2)
+				return false;
+		}
+		else if (strArg == "--outer-range" && xHasValue) {
+			if (std::sscanf(argv[++i], "%lf,%lf", &options->dOuterRange[0], &options->dOuterRange[1]) != 2)
+				return false;
+		}
+		else if (strArg == "--width-range" && xHasValue) {
+			if (std::sscanf(argv[++i], "%lf,%lf", &options->dWidthRange[0], &options->dWidthRange[1]) != 2)
+				return false;
+		}
+		else if (strArg.size() > 2 && strArg[0] == '-' && strArg[1] == '-')
+			return false;
+		else
+			options->positional.push_back(strArg);
+	}
+
+	if (options->strCatalogUnits.empty())
+		options->strCatalogUnits = options->strUnits;
+	if (options->lod.iRingSegments < 3 || options->lod.iRacewaySegments < 1 || options->lod.iBallSegments < 3)
+		return false;
+	bool xRangeLookup = options->dBoreRange[0] <= options->dBoreRange[1] || options->dOuterRange[0] <= options->dOuterRange[1] ||
+		options->dWidthRange[0] <= options->dWidthRange[1];
+	if (xRangeLookup && options->strLookupPath.empty())
+		return false;
+	if (xRangeLookup && options->positional.empty())
+		return true;
+	return options->positional.size() == 1 || options->positional.size() == 3;
+}
+
+static bool readSpecs(const SizerOptions &options, std::vector<BearingSpec> *specs)
+{
+	if (options.positional.size() == 3) {
+		specs->push_back({ std::atof(options.positional[0].c_str()), std::atof(options.positional[1].c_str()), std::atof(options.positional[2].c_str()) });
+		return true;
+	}
+
+	std::string strError;
+	bool xRead;
+	if (options.positional[0] == "-") {
+		std::stringstream input;
+		input << std::cin.rdbuf();
+		xRead = parseBearingSpecsCsv(input.str(), specs, &strError);
+	}
+	else {
+		xRead = readBearingSpecs(options.positional[0], options.strUnits, specs, &strError);
+	}
+	if (!xRead)
+		std::fprintf(stderr, "%s\n", strError.c_str());
+	return xRead;
+}
+
+static void printHeader(bool properties)
+{
+	std::printf("innerDiameter,outerDiameter,thickness,ballRadius,pitchRadius,ringWidth,filletRadius,ballCount,"
+		"innerRingMin,innerRingMax,outerRingMin,outerRingMax,racewayRadius,racewayCircleRadius,"
+		"valid,minWall,ballGap,ringGap,racewayLand%s\n",
+		properties ? ",mass,inertia,pitchDiameter,elementCount,dynamicLoadRating,staticLoadRating" : "");
+}
+
+static void printBearing(const BearingGeometry &geometry, const BearingValidation &validation, bool properties)
+{
+	std::printf("%g,%g,%g,%g,%g,%g,%g,%d,%g,%g,%g,%g,%g,%g,%d,%g,%g,%g,%g",
+		geometry.dInnerDiameter, geometry.dOuterDiameter, geometry.dThickness,
+		geometry.dBallRadius, geometry.dPitchRadius, geometry.dRingWidth, geometry.dFilletRadius, geometry.iBallCount,
+		geometry.innerRing.dRadiusMin, geometry.innerRing.dRadiusMax,
+		geometry.outerRing.dRadiusMin, geometry.outerRing.dRadiusMax,
+		geometry.raceway.dCenterRadius, geometry.raceway.dRadius,
+		validation.xValid ? 1 : 0, validation.dMinWall, validation.dBallGap, validation.dRingGap, validation.dRacewayLand);
+	BearingProperties bearingProperties;
+	if (properties && computeBearingProperties(geometry, 1.0, kBearingSteelDensity, &bearingProperties))
+		std::printf(",%g,%g,%g,%d,%g,%g", bearingProperties.dMass, bearingProperties.dInertia, bearingProperties.dPitchDiameter,
+			bearingProperties.iElementCount, bearingProperties.dDynamicLoadRating, bearingProperties.dStaticLoadRating);
+	else if (properties)
+		std::printf(",,,,,,");
+	std::printf("\n");
+}
+
+static void printCatalogRecord(const CatalogRecord &record)
+{
+	std::printf("%s,%g,%g,%g,%g,%g,%g,%g,%d\n", record.designation, record.dInnerDiameter, record.dOuterDiameter, record.dThickness,
+		record.dBallRadius, record.dPitchRadius, record.dRingWidth, record.dFilletRadius, record.iBallCount);
+}
+
+// Converts the lengths of a record to the units of the catalog, the ball count stays.
+static void scaleCatalogRecord(double scale, CatalogRecord *record)
+{
+	record->dInnerDiameter *= scale;
+	record->dOuterDiameter *= scale;
+	record->dThickness *= scale;
+	record->dBallRadius *= scale;
+	record->dRingWidth *= scale;
+	record->dPitchRadius *= scale;
+	record->dFilletRadius *= scale;
+}
+
+// Prints the catalog rows of the given sizes or of the ranges, the catalog is read in place.
+static bool lookupBearings(const SizerOptions &options, const std::vector<BearingSpec> &specs)
+{
+	BearingCatalog catalog;
+	std::string strError;
+	if (!catalog.open(options.strLookupPath, &strError)) {
+		std::fprintf(stderr, "%s\n", strError.c_str());
+		return false;
+	}
+
+	if (!options.xQuiet)
+		std::printf("designation,innerDiameter,outerDiameter,thickness,ballRadius,pitchRadius,ringWidth,filletRadius,ballCount\n");
+
+	std::vector<const CatalogRecord *> records;
+	if (options.dBoreRange[0] <= options.dBoreRange[1]) {
+		catalog.findByBore(options.dBoreRange[0], options.dBoreRange[1], &records);
+		for (const CatalogRecord *pRecord : records)
+			printCatalogRecord(*pRecord);
+	}
+	if (options.dOuterRange[0] <= options.dOuterRange[1]) {
+		catalog.findByOuterDiameter(options.dOuterRange[0], options.dOuterRange[1], &records);
+		for (const CatalogRecord *pRecord : records)
+			printCatalogRecord(*pRecord);
+	}
+	if (options.dWidthRange[0] <= options.dWidthRange[1]) {
+		catalog.findByThickness(options.dWidthRange[0], options.dWidthRange[1], &records);
+		for (const CatalogRecord *pRecord : records)
+			printCatalogRecord(*pRecord);
+	}
+
+	bool xResult = true;
+	for (const BearingSpec &spec : specs) {
+		const CatalogRecord *pRecord = catalog.find(spec.dInnerDiameter, spec.dOuterDiameter, spec.dThickness);
+		if (pRecord) {
+			printCatalogRecord(*pRecord);
+		}
+		else {
+			std::fprintf(stderr, "Not in %s: %g %g %g\n", options.strLookupPath.c_str(), spec.dInnerDiameter, spec.dOuterDiameter, spec.dThickness);
+			xResult = false;
+		}
+	}
+	return xResult;
+}
+
+static bool sweepBearings(const SizerOptions &options, const std::vector<BearingSpec> &specs)
+{
+	std::printf("innerDiameter,outerDiameter,thickness,ballRadius,ringWidth,racewayClearance,ballCount,loadRating,mass,minWall\n");
+
+	bool xResult = true;
+	for (const BearingSpec &spec : specs) {
+		std::vector<SweepResult> front;
+		SweepStats stats;
+		if (!sweepBearing(spec.dInnerDiameter, spec.dOuterDiameter, spec.dThickness, options.sweepRanges, options.iThreads, &front, &stats)) {
+			std::fprintf(stderr, "Invalid bearing: %g %g %g\n", spec.dInnerDiameter, spec.dOuterDiameter, spec.dThickness);
+			xResult = false;
+			continue;
+		}
+		for (const SweepResult &result : front) {
+			std::printf("%g,%g,%g,%g,%g,%g,%d,%g,%g,%g\n", spec.dInnerDiameter, spec.dOuterDiameter, spec.dThickness,
+				result.candidate.dBallRadius, result.candidate.dRingWidth, result.candidate.dRacewayClearance, result.candidate.iBallCount,
+				result.score.dLoadRating, result.score.dMass, result.score.dMinWall);
+		}
+		std::fprintf(stderr, "%g %g %g: %lld candidates, %lld feasible, %zu on the front, %.3f s\n",
+			spec.dInnerDiameter, spec.dOuterDiameter, spec.dThickness, stats.iEvaluated, stats.iFeasible, front.size(), stats.dSeconds);
+	}
+	return xResult;
+}
+
+int main(int argc, char **argv)
+{
+	SizerOptions options;
+	if (!parseOptions(argc, argv, &options)) {
+		printUsage(argv[0]);
+		return 2;
+	}
+
+	std::vector<BearingSpec> specs;
+	if (!options.positional.empty() && !readSpecs(options, &specs))
+		return 1;
+
+	if (!options.strLookupPath.empty())
+		return lookupBearings(options, specs) ? 0 : 1;
+	if (options.xSweep)
+		return sweepBearings(options, specs) ? 0 : 1;
+
+	std::vector<std::unique_ptr<MeshWriter>> writers;
+	if (!options.strStlPath.empty()) {
+		writers.emplace_back(new StlMeshWriter());
+		if (!writers.back()->open(options.strStlPath)) {
+			std::fprintf(stderr, "Cannot write %s\n", options.strStlPath.c_str());
+			return 1;
+		}
+	}
+	if (!options.strPlyPath.empty()) {
+		writers.emplace_back(new PlyMeshWriter());
+		if (!writers.back()->open(options.strPlyPath)) {
+			std::fprintf(stderr, "Cannot write %s\n", options.strPlyPath.c_str());
+			return 1;
+		}
+	}
+	if (!options.str3mfPath.empty()) {
+		writers.emplace_back(new ThreeMfMeshWriter(threeMfUnit(options.strUnits)));
+		if (!writers.back()->open(options.str3mfPath)) {
+			std::fprintf(stderr, "Cannot write %s\n", options.str3mfPath.c_str());
+			return 1;
+		}
+	}
+	StepWriter stepWriter;
+	if (!options.strStepPath.empty() && !stepWriter.open(options.strStepPath, options.strUnits)) {
+		std::fprintf(stderr, "Cannot write %s\n", options.strStepPath.c_str());
+		return 1;
+	}
+
+	if (!options.xQuiet)
+		printHeader(options.xProperties);
+
+	std::vector<CatalogRecord> catalog;
+	double dCatalogScale = unitsToMillimetres(options.strUnits) / unitsToMillimetres(options.strCatalogUnits);
+	int iFailed = 0;
+	double dOffsetX = 0.0;
+	for (const BearingSpec &spec : specs) {
+		BearingGeometry geometry;
+		if (!computeBearingGeometry(options.eFamily, spec.dInnerDiameter, spec.dOuterDiameter, spec.dThickness, &geometry)) {
+			std::fprintf(stderr, "Invalid bearing: %g %g %g\n", spec.dInnerDiameter, spec.dOuterDiameter, spec.dThickness);
+			++iFailed;
+			continue;
+		}
+		BearingValidation validation;
+		validateBearingGeometry(&geometry, true, &validation);
+		if (!options.xQuiet)
+			printBearing(geometry, validation, options.xProperties);
+		if (!validation.errors.empty() || !validation.corrections.empty())
+			std::fprintf(stderr, "%g %g %g: %s\n", spec.dInnerDiameter, spec.dOuterDiameter, spec.dThickness, validation.message().c_str());
+		if (!validation.xValid) {
+			++iFailed;
+			continue;
+		}
+
+		if (!options.strCatalogPath.empty()) {
+			catalog.emplace_back();
+			makeCatalogRecord(geometry, "", &catalog.back());
+			scaleCatalogRecord(dCatalogScale, &catalog.back());
+		}
+
+		char name[96];
+		std::snprintf(name, sizeof(name), "%s-%gx%gx%g", bearingFamilyName(geometry.eFamily), spec.dInnerDiameter, spec.dOuterDiameter, spec.dThickness);
+		if (!options.strStepDirectory.empty()) {
+			std::string strPath = options.strStepDirectory + "/" + name + ".step";
+			StepWriter bearingWriter;
+			if (!bearingWriter.open(strPath, options.strUnits) || !bearingWriter.write(geometry, name, 0.0, 0.0) || !bearingWriter.close()) {
+				std::fprintf(stderr, "Cannot write %s\n", strPath.c_str());
+				return 1;
+			}
+		}
+
+		// Bearings are placed side by side along X in the mesh and STEP files.
+		if (!writers.empty() || !options.strStepPath.empty()) {
+			dOffsetX += geometry.dOuterDiameter * 0.5;
+			for (auto &writer : writers) {
+				if (!writeBearingMesh(geometry, options.lod, dOffsetX, 0.0, writer.get())) {
+					std::fprintf(stderr, "Writing the mesh failed\n");
+					return 1;
+				}
+			}
+			if (!options.strStepPath.empty() && !stepWriter.write(geometry, name, dOffsetX, 0.0)) {
+				std::fprintf(stderr, "Writing %s failed\n", options.strStepPath.c_str());
+				return 1;
+			}
+			dOffsetX += geometry.dOuterDiameter * 0.5 + options.dSpacing;
+		}
+	}
+
+	for (auto &writer : writers) {
+		if (!writer->close()) {
+			std::fprintf(stderr, "Writing the mesh failed\n");
+			return 1;
+		}
+	}
+	if (!options.strStepPath.empty() && !stepWriter.close()) {
+		std::fprintf(stderr, "Writing %s failed\n", options.strStepPath.c_str());
+		return 1;
+	}
+
+	std::string strError;
+	if (!options.strCatalogPath.empty() && !writeBearingCatalog(options.strCatalogPath, options.strCatalogUnits, catalog, &strError)) {
+		std::fprintf(stderr, "%s\n", strError.c_str());
+		return 1;
+	}
+	return iFailed == 0 ? 0 : 1;
+}